@@ -29,8 +29,13 @@ function(compile_shaders SRC_DIR DEST_DIR)
 		${SRC_DIR}/*.tesc 
 		${SRC_DIR}/*.tese 
 		${SRC_DIR}/*.comp
+		${SRC_DIR}/*.task
+		${SRC_DIR}/*.mesh
 	)
 
+	# Shared includes, every shader is rebuilt when one of them changes
+	file(GLOB_RECURSE includes CONFIGURE_DEPENDS ${SRC_DIR}/*.glsl)
+
 	list(LENGTH shaders shaders_count)
 	message(STATUS "compile_shaders: Compiling ${shaders_count} shaders from ${SRC_DIR} to ${DEST_DIR}")
 
@@ -40,9 +45,16 @@ function(compile_shaders SRC_DIR DEST_DIR)
 		get_filename_component(filename_we ${shader} NAME_WE)
 		set(output_file ${DEST_DIR}/${filename_we}.spv)
 
-		if(NOT EXISTS ${output_file} OR ${shader} IS_NEWER_THAN ${output_file})
+		set(outdated FALSE)
+		foreach(include IN LISTS includes)
+			if(EXISTS ${output_file} AND ${include} IS_NEWER_THAN ${output_file})
+				set(outdated TRUE)
+			endif()
+		endforeach()
+
+		if(NOT EXISTS ${output_file} OR ${shader} IS_NEWER_THAN ${output_file} OR outdated)
 			execute_process(
-				COMMAND ${Vulkan_GLSLC_EXECUTABLE} ${shader} -o ${output_file}
+				COMMAND ${Vulkan_GLSLC_EXECUTABLE} --target-env=vulkan1.3 ${shader} -o ${output_file}
 				OUTPUT_VARIABLE output
 				RESULT_VARIABLE result
 			)
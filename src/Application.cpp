@@ -1,5 +1,8 @@
 #include <thread>
+#include <algorithm>
 #include <cstring>
+#include <cmath>
+#include <filesystem>
 
 #include <GLFW/glfw3.h>
 #include <cglm/struct/affine-pre.h>
@@ -8,6 +11,11 @@
 #include "vulkan_api/utils/Helpers.hpp"
 #include "vulkan_api/pipeline/stages/shader/ShaderStage.hpp"
 #include "vulkan_api/render/Render.hpp"
+#include "assets/MeshOptimizer.hpp"
+#include "assets/MeshFile.hpp"
+#include "core/HeapCounter.hpp"
+#include "core/TaskGraph.hpp"
+#include "scene/Components.hpp"
 #include "Camera.hpp"
 
 #include "Application.hpp"
@@ -15,19 +23,87 @@
 
 #define FPS_MEASUREMENT
 
-using Clock = std::chrono::high_resolution_clock;
-using TimeStamp = std::chrono::time_point<Clock>;
-
-
 const uint32_t WIDTH = 800;
 const uint32_t HEIGHT = 600;
 
+const float FOV    = 60.f;
+const float Z_NEAR = 0.1f;
+const float Z_FAR  = 100.f;
+
+// shared by every mesh with the cube's vertex layout
+const uint32_t GEOMETRY_POOL_VERTICES = 1 << 20;
+const uint32_t GEOMETRY_POOL_INDICES  = 3 << 20;
+const uint32_t GEOMETRY_POOL_CLUSTER_WORDS = 1 << 20;
+
+// per frame budgets of the cluster culler: visibility entries and compacted indices over all instances
+const uint32_t CLUSTER_CULL_MAX_CLUSTERS = 1 << 16;
+const uint32_t CLUSTER_CULL_MAX_INDICES  = 1 << 20;
+
+const char* CUBE_MESH_PATH = "res/meshes/cube.smesh";
+
+// CPU memory of one frame slot: render graph passes and barriers, culling inputs
+const size_t FRAME_ARENA_SIZE = 1 << 20;
+
+// frames after start-up or a swapchain recreation that may still fill caches before debug builds expect no heap allocations
+const uint32_t FRAME_WARMUP = 4;
+
+// objects the instance buffer and the cullers have room for, transform slots beyond it are not drawn
+const uint32_t MAX_INSTANCES = 1024;
+
+// index of the cube's material in m_materials
+const uint32_t CUBE_MATERIAL = 0;
+
+// cubes around a picked one that get reported with it
+const float PICK_NEIGHBOURHOOD = 3.f;
+
+// vertex layout of the cube mesh and of the pipelines drawing it
+static const std::array<VertexInputState::Attribute, 2> cubeAttributes =
+{
+    VertexInputState::Attribute::Half4,
+    VertexInputState::Attribute::Unorm16x2
+};
+
+// push constants of the mesh shading path, see cluster_common.glsl
+struct MeshDrawConstants
+{
+    mat4s    modelViewProjection;
+    vec4s    cameraPosition; // object space
+    uint32_t clusterOffset;
+    uint32_t firstMeshlet;
+    uint32_t meshletCount;
+    int32_t  vertexOffset;
+};
+
+const uint32_t MESHLETS_PER_TASK = 32;
+
+// world space positions of the cubes the scene starts with
+static const std::array<vec3s, 10> cubePositions =
+{
+    vec3s { 0.0f,  0.0f,  0.0f },
+    vec3s { 2.0f,  5.0f, -15.0f },
+    vec3s { -1.5f, -2.2f, -2.5f },
+    vec3s { -3.8f, -2.0f, -12.3f },
+    vec3s { 2.4f, -0.4f, -3.5f },
+    vec3s { -1.7f,  3.0f, -7.5f },
+    vec3s { 1.3f, -2.0f, -2.5f },
+    vec3s { 1.5f,  2.0f, -2.5f },
+    vec3s { 1.5f,  0.2f, -1.5f },
+    vec3s { -1.3f,  1.0f, -1.5f }
+};
+
 Camera camera;
 
 float lastX = WIDTH / 2.f;
 float lastY = HEIGHT / 2.f;
 
 
+// Half the size of a box made by Bvh::makeBounds()
+static float get_radius(const Bvh::Bounds& bounds) noexcept
+{
+    return (bounds.max.x - bounds.min.x) * 0.5f;
+}
+
+
 void processInput(GLFWwindow *window, float dt)
 {
     if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
@@ -47,8 +123,143 @@ void processInput(GLFWwindow *window, float dt)
 }
 
 
-int Application::run() noexcept
+// What an importer does once at bake time: optimize, pack to the cube's vertex layout and write the mesh file
+static bool bake_cube_mesh(const char* path) noexcept
 {
+    std::array<float, 120> vertices = 
+    {
+        -0.5f, -0.5f, 0.5f, 0.f, 0.f,
+         0.5f, -0.5f, 0.5f, 1.f, 0.f,
+         0.5f,  0.5f, 0.5f, 1.f, 1.f,
+        -0.5f,  0.5f, 0.5f, 0.f, 1.f,
+
+        -0.5f, -0.5f, -0.5f, 0.f, 0.f,
+        -0.5f, -0.5f,  0.5f, 1.f, 0.f,
+        -0.5f,  0.5f,  0.5f, 1.f, 1.f,
+        -0.5f,  0.5f, -0.5f, 0.f, 1.f,
+
+         0.5f, -0.5f,  0.5f, 0.f, 0.f,
+         0.5f, -0.5f, -0.5f, 1.f, 0.f,
+         0.5f,  0.5f, -0.5f, 1.f, 1.f,
+         0.5f,  0.5f,  0.5f, 0.f, 1.f,
+
+        -0.5f, -0.5f, -0.5f, 0.f, 0.f,
+         0.5f, -0.5f, -0.5f, 1.f, 0.f,
+         0.5f,  0.5f, -0.5f, 1.f, 1.f,
+        -0.5f,  0.5f, -0.5f, 0.f, 1.f,
+
+        -0.5f, 0.5f,  0.5f, 0.f, 0.f,
+         0.5f, 0.5f,  0.5f, 1.f, 0.f,
+         0.5f, 0.5f, -0.5f, 1.f, 1.f,
+        -0.5f, 0.5f, -0.5f, 0.f, 1.f,
+
+        -0.5f, -0.5f, -0.5f, 0.f, 0.f,
+         0.5f, -0.5f, -0.5f, 1.f, 0.f,
+         0.5f, -0.5f,  0.5f, 1.f, 1.f,
+        -0.5f, -0.5f,  0.5f, 0.f, 1.f
+    };
+
+    std::array<uint32_t, 36> indices = 
+    {
+        0,  1,  2,  2,  3,  0,   // front
+        4,  5,  6,  6,  7,  4,   // left
+        8,  9,  10, 10, 11, 8,   // right
+        12, 13, 14, 14, 15, 12,  // back
+        16, 17, 18, 18, 19, 16,  // top
+        20, 21, 22, 22, 23, 20   // bottom
+    };
+
+    const uint32_t vertexCount = static_cast<uint32_t>(vertices.size() / 5);
+
+    MeshOptimizer::optimizeVertexCache(indices, vertexCount);
+    MeshOptimizer::optimizeOverdraw(indices, vertices.data(), sizeof(float) * 5, vertexCount);
+
+//  Each level halves the triangles of the previous one until that stops working or would move the surface by more than 5% of the cube.
+//  Errors add up along the chain, since every level is simplified from the one before.
+//  The cube itself has nothing to remove, all of its corners sit on UV seams, so it ends up with full detail only
+    std::vector<uint32_t>      lodIndices(indices.begin(), indices.end());
+    std::vector<MeshFile::Lod> lods = { { 0, static_cast<uint32_t>(indices.size()), 0, 0, 0.f, 0 } };
+    std::vector<uint32_t>      level = lodIndices;
+
+    while (lods.size() < MeshFile::MAX_LODS)
+    {
+        float error = 0.f;
+        auto simplified = MeshOptimizer::simplify(level, vertices.data(), sizeof(float) * 5, vertexCount, level.size() / 2, 0.05f, error);
+
+        if(simplified.empty() || simplified.size() > level.size() * 3 / 4)
+            break;
+
+        MeshOptimizer::optimizeVertexCache(simplified, vertexCount);
+
+        lods.push_back({ static_cast<uint32_t>(lodIndices.size()), static_cast<uint32_t>(simplified.size()), 0, 0, lods.back().error + error, 0 });
+        lodIndices.insert(lodIndices.end(), simplified.begin(), simplified.end());
+        level = std::move(simplified);
+    }
+
+    const uint32_t usedVertices = MeshOptimizer::optimizeVertexFetch(lodIndices, std::as_writable_bytes(std::span(vertices)), sizeof(float) * 5);
+
+//  Every level is also split into meshlets for cluster culling, a mesh this small fits in one per level
+    std::vector<MeshOptimizer::Meshlet> meshlets;
+    std::vector<uint32_t>               meshletVertices;
+    std::vector<uint8_t>                meshletTriangles;
+
+    for (auto& lod : lods)
+    {
+        lod.firstMeshlet = static_cast<uint32_t>(meshlets.size());
+        lod.meshletCount = MeshOptimizer::buildMeshlets(std::span(lodIndices).subspan(lod.firstIndex, lod.indexCount), vertices.data(), sizeof(float) * 5, usedVertices,
+                                                        meshlets, meshletVertices, meshletTriangles);
+    }
+
+//  12 bytes per vertex instead of 20, the cube's coordinates are exact in both formats
+    struct CubeVertex
+    {
+        std::array<uint16_t, 4> position; // Half4, w is padding
+        std::array<uint16_t, 2> texCoord; // Unorm16x2
+    };
+
+    static_assert(sizeof(CubeVertex) == 12);
+
+    std::vector<CubeVertex> packedVertices(usedVertices);
+
+    for (size_t i = 0; i < packedVertices.size(); ++i)
+    {
+        const float* vertex = &vertices[i * 5];
+
+        packedVertices[i] = 
+        {
+            .position = { VertexInputState::packHalf(vertex[0]), VertexInputState::packHalf(vertex[1]), VertexInputState::packHalf(vertex[2]), VertexInputState::packHalf(1.f) },
+            .texCoord = { VertexInputState::packUnorm16(vertex[3]), VertexInputState::packUnorm16(vertex[4]) }
+        };
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path(), error);
+
+    const MeshFile::Source source = 
+    {
+        .attributes       = cubeAttributes,
+        .vertices         = std::as_bytes(std::span(packedVertices)),
+        .indices          = lodIndices,
+        .lods             = lods,
+        .meshlets         = meshlets,
+        .meshletVertices  = meshletVertices,
+        .meshletTriangles = meshletTriangles,
+        .positions        = vertices.data(),
+        .positionStride   = sizeof(float) * 5
+    };
+
+    return MeshFile::write(path, source);
+}
+
+
+int Application::run(const Settings& settings) noexcept
+{
+    m_settings = settings;
+    m_settings.framesInFlight = std::clamp(m_settings.framesInFlight, 1U, InstanceBuffer::MAX_FRAMES); // the instance buffer keeps a bit per frame slot
+
+    if(m_settings.targetFrameRate > 0.f)
+        m_framePacer.setTargetInterval(1.f / m_settings.targetFrameRate);
+
     initWindow();
 
     if(initVulkan())
@@ -95,49 +306,101 @@ void Application::initWindow() noexcept
             camera.ProcessMouseMovement(xoffset, yoffset);
         });
 
+        glfwSetMouseButtonCallback(window, [](GLFWwindow* window, int button, int action, int mods)
+        {
+            if(auto app = static_cast<Application*>(glfwGetWindowUserPointer(window)); app && button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS)
+                app->pick();
+        });
+
         glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
     }
 }
 
 
+// Startup as a graph of tasks on the job system: files are read and decoded while the device is created,
+// pipelines compile in parallel once device and swapchain formats exist. Everything that submits goes through
+// the asset cache, which serializes the queue, and the deletion queue is only touched along swapchain -> occlusion -> clusters
 bool Application::initVulkan() noexcept
 {
     glfwGetFramebufferSize(window, &m_width, &m_height);
 
-//  Common
-    if(m_context.initialize() != VK_SUCCESS) 
+//  One pool for every subsystem that fans out, the main thread is the last worker
+    if(!m_jobs.create(std::clamp(std::thread::hardware_concurrency(), 1U, 8U) - 1))
         return false;
 
-    auto instance = m_context.getInstance();
-    auto GPU      = m_context.getPhysicalDevice();
-    auto device   = m_context.getDevice();
+    struct
+    {
+        std::vector<uint32_t> vertex;
+        std::vector<uint32_t> fragment;
+        std::vector<uint32_t> depthOnly;
+        std::vector<uint32_t> clusterTask;
+        std::vector<uint32_t> clusterMesh;
+    } spirv;
 
-//  Main View
-    if(m_mainView.create(m_context, window) != VK_SUCCESS) 
-        return false;
-    
-    {// Pipeline
-        std::array<ShaderStage, 2> shaders;
+    TaskGraph init;
 
-        if(shaders[0].loadFromFile(device, VK_SHADER_STAGE_VERTEX_BIT, "res/shaders/vertex_shader.spv") != VK_SUCCESS)
-            return false;
+//  No device needed
+    const auto readShaders = init.add("read shaders", [this, &spirv]
+    {
+    //  Before it is known whether the device supports mesh shaders, a missing one only turns mesh shading off in the mesh pipeline task
+        if(m_settings.meshShading)
+        {
+            ShaderStage::readFile("res/shaders/cluster_task.spv", spirv.clusterTask);
+            ShaderStage::readFile("res/shaders/cluster_mesh.spv", spirv.clusterMesh);
+        }
+
+        return ShaderStage::readFile("res/shaders/vertex_shader.spv", spirv.vertex) &&
+               ShaderStage::readFile("res/shaders/fragment_shader.spv", spirv.fragment) &&
+               ShaderStage::readFile("res/shaders/depth_only.spv", spirv.depthOnly);
+    });
 
-        if(shaders[1].loadFromFile(device, VK_SHADER_STAGE_FRAGMENT_BIT, "res/shaders/fragment_shader.spv") != VK_SUCCESS)
+    const auto decodeTexture = init.add("decode texture", [this]
+    {
+        return m_assets.prefetchTexture("res/textures/container.jpg");
+    });
+
+    const auto bakeMesh = init.add("bake mesh", []
+    {
+        MeshFile file;
+
+        return file.open(CUBE_MESH_PATH) || bake_cube_mesh(CUBE_MESH_PATH);
+    });
+
+//  Common
+    const auto createDevice = init.add("device", [this]
+    {
+        return m_context.initialize() == VK_SUCCESS;
+    });
+
+//  Main View
+    const auto createSwapchain = init.add("swapchain", [this]
+    {
+        if(m_mainView.create(m_context, window, m_settings.swapchainImages) != VK_SUCCESS)
             return false;
 
-        std::array<const VertexInputState::Attribute, 2> attributes =
-        {
-            VertexInputState::Attribute::Float3,
-            VertexInputState::Attribute::Float2
-        };
+    //  The pacer may only calibrate against the present cadence when it is the display refresh
+        m_framePacer.setVsync(m_mainView.getPresentMode() == VK_PRESENT_MODE_FIFO_KHR);
+
+        return true;
+    }, { createDevice });
+
+    const auto colorPipelines = init.add("color pipelines", [this, &spirv]
+    {
+        auto device = m_context.getDevice();
+        std::array<ShaderStage, 2> shaders;
+
+        if(shaders[0].create(device, VK_SHADER_STAGE_VERTEX_BIT, spirv.vertex) != VK_SUCCESS ||
+           shaders[1].create(device, VK_SHADER_STAGE_FRAGMENT_BIT, spirv.fragment) != VK_SUCCESS)
+            return false;
 
         DescriptorSetLayout uniformDescriptors;
         uniformDescriptors.addDescriptor(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT);
+        uniformDescriptors.addDescriptor(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_VERTEX_BIT); // instances
 
         GraphicsPipeline::State state;
 
         state.setupShaderStages(shaders)->
-            setupVertexInput(attributes)->
+            setupVertexInput(cubeAttributes)->
             setupInputAssembler(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)->
             setupViewport()->
             setupRasterization(VK_POLYGON_MODE_FILL)->
@@ -145,122 +408,366 @@ bool Application::initVulkan() noexcept
             setupColorBlending(VK_FALSE)->
             setupDescriptorSetLayout(uniformDescriptors);
 
+        bool created = (m_pipeline.create(m_mainView, state) == VK_SUCCESS);
 
-        if(m_pipeline.create(m_mainView, state) != VK_SUCCESS) 
-            return false;
+    //  Same material, shaded only where the depth pre-pass left the nearest fragment
+        state.setupDepthStencil(VK_FALSE, VK_COMPARE_OP_EQUAL);
+
+        created = created && (m_prepassPipeline.create(m_mainView, state) == VK_SUCCESS);
 
         shaders[0].destroy(device);
         shaders[1].destroy(device);
 
+        return created;
+    }, { readShaders, createSwapchain });
+
+    init.add("depth pipeline", [this, &spirv]
+    {// Depth-only pipeline, no fragment shader and no color writes
+        auto device = m_context.getDevice();
+        ShaderStage depthShader;
+
+        if(depthShader.create(device, VK_SHADER_STAGE_VERTEX_BIT, spirv.depthOnly) != VK_SUCCESS)
+            return false;
+
+        DescriptorSetLayout uniformDescriptors;
+        uniformDescriptors.addDescriptor(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT);
+        uniformDescriptors.addDescriptor(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_VERTEX_BIT); // instances
+
+        GraphicsPipeline::State depthState;
+
+        depthState.setupShaderStages({ &depthShader, 1 })->
+            setupVertexInput(cubeAttributes)->
+            setupInputAssembler(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)->
+            setupViewport()->
+            setupRasterization(VK_POLYGON_MODE_FILL)->
+            setupMultisampling()->
+            setupColorBlending(VK_FALSE, 0)->
+            setupDepthStencil(VK_TRUE, VK_COMPARE_OP_LESS)->
+            setupDescriptorSetLayout(uniformDescriptors);
+
+        const bool created = (m_depthPipeline.create(m_mainView, depthState) == VK_SUCCESS);
+
+        depthShader.destroy(device);
+
+        return created;
+    }, { readShaders, createSwapchain });
+
+    const auto meshPipeline = init.add("mesh pipeline", [this, &spirv]
+    {
+        if(!m_settings.meshShading)
+            return true;
+
+        if(!m_context.isMeshShaderSupported())
+        {
+            printf("mesh shading needs VK_EXT_mesh_shader, drawing with the vertex pipeline\n");
+            return true;
+        }
+
+    //  Mesh shading pipeline: the task stage culls meshlets, the mesh stage fetches its own vertices
+        auto device = m_context.getDevice();
+        std::array<ShaderStage, 3> meshShaders;
+
+        if(meshShaders[0].create(device, VK_SHADER_STAGE_TASK_BIT_EXT, spirv.clusterTask) != VK_SUCCESS ||
+           meshShaders[1].create(device, VK_SHADER_STAGE_MESH_BIT_EXT, spirv.clusterMesh) != VK_SUCCESS ||
+           meshShaders[2].create(device, VK_SHADER_STAGE_FRAGMENT_BIT, spirv.fragment) != VK_SUCCESS)
+        {// A missing .spv leaves its code empty, destroy() skips the stages that were never created
+            for (auto& shader : meshShaders)
+                shader.destroy(device);
+
+            printf("mesh shaders not available, drawing with the vertex pipeline\n");
+            m_meshShading = false;
+
+            return true;
+        }
+
+        DescriptorSetLayout meshDescriptors;
+        meshDescriptors.addDescriptor(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT);
+        meshDescriptors.addDescriptor(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_MESH_BIT_EXT); // vertices
+        meshDescriptors.addDescriptor(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_TASK_BIT_EXT | VK_SHADER_STAGE_MESH_BIT_EXT); // clusters
+
+        GraphicsPipeline::State meshState;
+
+        meshState.setupShaderStages(meshShaders)->
+            setupViewport()->
+            setupRasterization(VK_POLYGON_MODE_FILL)->
+            setupMultisampling()->
+            setupColorBlending(VK_FALSE)->
+            setupDescriptorSetLayout(meshDescriptors)->
+            setupPushConstants(VK_SHADER_STAGE_TASK_BIT_EXT | VK_SHADER_STAGE_MESH_BIT_EXT, sizeof(MeshDrawConstants));
+
+        m_meshShading   = (m_meshPipeline.create(m_mainView, meshState) == VK_SUCCESS);
+        m_drawMeshTasks = reinterpret_cast<PFN_vkCmdDrawMeshTasksEXT>(vkGetDeviceProcAddr(device, "vkCmdDrawMeshTasksEXT"));
+        m_meshShading   = m_meshShading && m_drawMeshTasks;
+
+        for (auto& shader : meshShaders)
+            shader.destroy(device);
+
+        return true;
+    }, { readShaders, createSwapchain });
+
+    const auto framePool = init.add("frame resources", [this]
+    {
+        auto device = m_context.getDevice();
+
+        if(!m_commandPool.create(device, m_context.getMainQueueFamilyIndex(), m_settings.framesInFlight))
+            return false;
+
+        if(!m_sync.create(device, m_settings.framesInFlight)) 
+            return false;
+
+    //  Reset when the slot comes around again, its previous frame has completed by then
+        m_frameArenas = std::make_unique<LinearAllocator[]>(m_settings.framesInFlight);
+
+        for (uint32_t i = 0; i < m_settings.framesInFlight; ++i)
+            if(!m_frameArenas[i].create(FRAME_ARENA_SIZE))
+                return false;
+
+        return true;
+    }, { createDevice });
+
+    const auto instances = init.add("instance buffer", [this]
+    {
+        return m_instances.create(m_context.getPhysicalDevice(), m_context.getDevice(), MAX_INSTANCES, m_settings.framesInFlight);
+    }, { createDevice });
+
+    init.add("frame timing", [this]
+    {
+        if(m_settings.lowLatency)
+        {
+            m_lowLatency = m_latencyLimiter.create(m_context);
+
+            if(!m_lowLatency)
+                printf("low-latency mode needs VK_KHR_present_wait, falling back to normal presentation\n");
+        }
+
+        if(m_settings.dynamicResolution)
+        {
+            m_dynamicResolution = m_gpuTimer.create(m_context, m_settings.framesInFlight);
+
+            if(m_dynamicResolution)
+            {
+                const float frameRate = (m_settings.targetFrameRate > 0.f) ? m_settings.targetFrameRate : 60.f;
+
+                m_resolution.create(
+                {
+                    .minScale = m_settings.minResolutionScale,
+                    .maxScale = m_settings.maxResolutionScale,
+                    .budgetMs = (m_settings.gpuBudgetMs > 0.f) ? m_settings.gpuBudgetMs : 1000.f / frameRate
+                });
+
+                m_frameScales.assign(m_settings.framesInFlight, 0.f);
+            }
+            else printf("dynamic resolution needs timestamp queries, rendering at full resolution\n");
+        }
+
+        return true;
+    }, { createDevice });
+
+    init.add("render queue", [this]
+    {
+        m_renderQueue.reserve(MAX_INSTANCES);
+        m_lodSelector.create({ .pixelError = m_settings.lodPixelError });
+        m_instanceLods.assign(MAX_INSTANCES, 0);
+        m_graph.create(m_context.getDevice(), m_context.getPhysicalDevice(), &m_context.getDeletionQueue());
+
+        return m_recorder.create(m_mainView, m_jobs, 8, m_settings.framesInFlight);
+    }, { createSwapchain });
+
+//  Without the compute shaders the cubes are simply drawn directly, the mesh shading path culls in its task stage instead.
+//  The culled draws select their model matrix through firstInstance, which indirect draws may only set with drawIndirectFirstInstance
+    const auto occlusion = init.add("occlusion culler", [this]
+    {
+        m_occlusionCulling = !m_meshShading && m_context.isIndirectFirstInstanceSupported() && 
+                             (m_culler.create(m_mainView, MAX_INSTANCES, m_settings.framesInFlight) == VK_SUCCESS);
+
+        if(!m_occlusionCulling)
+            m_culler.destroy();
+
+        return true;
+    }, { createSwapchain, meshPipeline });
+
+//  Every mesh of the cube's vertex layout shares the pool, meshes above 16-bit indices would need a second, 32-bit pool
+    const auto geometry = init.add("geometry pool", [this]
+    {
+        uint32_t vertexStride = 0;
+
+        for (const auto& attribute : cubeAttributes)
+            vertexStride += static_cast<uint32_t>(attribute.sizeInBytes);
+
+        if(!m_geometry.create(m_context.getPhysicalDevice(), m_context.getDevice(), vertexStride, GEOMETRY_POOL_VERTICES, VK_INDEX_TYPE_UINT16, GEOMETRY_POOL_INDICES, GEOMETRY_POOL_CLUSTER_WORDS))
+            return false;
+
+        m_assets.create(m_context, m_commandPool.handle, m_geometry, cubeAttributes);
+
+        return true;
+    }, { createDevice, framePool });
+
+//  Cluster culling reads the pyramid of the occlusion culler and the cluster blobs of the pool
+    init.add("cluster culler", [this]
+    {
+        if(m_occlusionCulling && m_settings.clusterCulling)
+        {
+            m_clusterCulling = (m_clusterCuller.create(m_context, m_geometry.getClusterBuffer(), m_culler, MAX_INSTANCES, CLUSTER_CULL_MAX_CLUSTERS, CLUSTER_CULL_MAX_INDICES, 
+                                                       m_settings.framesInFlight) == VK_SUCCESS);
+
+            if(!m_clusterCulling)
+                m_clusterCuller.destroy();
+        }
+
+        return true;
+    }, { occlusion, geometry });
+
+//  Uploads only, the pixels were decoded while the device was created
+    const auto uploadTexture = init.add("upload texture", [this]
+    {
+        m_texture = m_assets.loadTexture("res/textures/container.jpg");
+
+        return m_texture != nullptr;
+    }, { decodeTexture, geometry });
+
+    const auto uploadMesh = init.add("upload mesh", [this]
+    {// Cube mesh, mapped and copied straight into staging memory
+        m_cubeMesh = m_assets.loadMesh(CUBE_MESH_PATH);
+
+        if(!m_cubeMesh && bake_cube_mesh(CUBE_MESH_PATH))
+            m_cubeMesh = m_assets.loadMesh(CUBE_MESH_PATH);
+
+        if(!m_cubeMesh)
+        {
+            printf("failed to load %s\n", CUBE_MESH_PATH);
+            return false;
+        }
+
+    //  Bounds of the mesh under any rotation about its origin
+        const float* sphere = m_cubeMesh->sphere;
+        m_cubeRadius = std::sqrt(sphere[0] * sphere[0] + sphere[1] * sphere[1] + sphere[2] * sphere[2]) + sphere[3];
+
+        return true;
+    }, { bakeMesh, geometry });
+
+//  Every third cube turns, the rest keep the rotation they start with
+    init.add("scene", [this]
+    {
+        m_transforms.reserve(static_cast<uint32_t>(cubePositions.size()));
+
+        for (uint32_t i = 0; i < cubePositions.size(); ++i)
+        {
+            const vec3s axis  = { 1.f, 0.3f, 0.5f };
+            const float angle = glm_rad(20.f * i);
+
+            const Transform  transform  = { m_transforms.add(cubePositions[i], glms_quatv(angle, axis)) };
+            const Renderable renderable = { m_cubeRadius };
+
+            const World::Entity entity = (i % 3 == 0) ? m_world.create(transform, renderable, Spin { axis, glm_rad(50.f), angle }) :
+                                                        m_world.create(transform, renderable);
+
+            if(!m_world.isAlive(entity))
+                return false;
+        }
+
+    //  Visibility and picking queries go through the hierarchy, its items are the transform slots
+        std::vector<uint32_t>    items;
+        std::vector<Bvh::Bounds> bounds;
+
+        m_world.each<Transform, Renderable>([&](World::Entity, const Transform& transform, const Renderable& renderable)
+        {
+            items.push_back(transform.index);
+            bounds.push_back(Bvh::makeBounds(m_transforms.getPosition(transform.index), renderable.radius));
+        });
+
+        m_bvh.build(items, bounds);
+
+        return true;
+    }, { uploadMesh });
+
+    init.add("descriptors", [this]
+    {
+        auto device = m_context.getDevice();
+
+        m_materials.push_back(
+        {
+            .pipeline        = &m_pipeline,
+            .prepassPipeline = &m_prepassPipeline
+        });
+
         m_descriptorPool = std::make_unique<DescriptorPool>(device);
 
         {
-            std::array<VkDescriptorPoolSize, 1> poolSizes = 
+        //  One more set for the mesh shading path
+            std::array<VkDescriptorPoolSize, 2> poolSizes = 
             {
                 VkDescriptorPoolSize
                 {
                     .type            = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-                    .descriptorCount = MAX_FRAMES_IN_FLIGHT
+                    .descriptorCount = m_settings.framesInFlight + 1
+                },
+                VkDescriptorPoolSize
+                {
+                    .type            = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    .descriptorCount = m_settings.framesInFlight + 2
                 }
             };
 
-            if(m_descriptorPool->create(poolSizes) != VK_SUCCESS)
+            if(m_descriptorPool->create(poolSizes, m_settings.framesInFlight + 1) != VK_SUCCESS)
                 return false;
         }
 
         {
-            std::array<VkDescriptorSetLayout, MAX_FRAMES_IN_FLIGHT> layouts = 
-            { 
-                m_pipeline.getDescriptorSetLayout(), 
-                m_pipeline.getDescriptorSetLayout() 
-            };
+            const std::vector<VkDescriptorSetLayout> layouts(m_settings.framesInFlight, m_pipeline.getDescriptorSetLayout());
+            m_descriptorSets.resize(m_settings.framesInFlight);
 
             if(m_descriptorPool->allocateDescriptorSets(m_descriptorSets, layouts) != VK_SUCCESS)
                 return false;
         }
-    }
 
-    if(!m_commandPool.create(device, m_context.getMainQueueFamilyIndex()))
-        return false;
+        if(m_meshShading)
+        {
+            const std::array<VkDescriptorSetLayout, 1> layouts = { m_meshPipeline.getDescriptorSetLayout() };
+            std::array<VkDescriptorSet, 1> sets;
 
-    if(!m_sync.create(device)) 
-        return false;
+            if(m_descriptorPool->allocateDescriptorSets(sets, layouts) != VK_SUCCESS)
+                return false;
 
-    auto queue = m_context.getQueue();
-    auto commandPool = m_commandPool.handle;
+            m_meshDescriptorSet = sets[0];
+        }
 
-    {
-        if(!m_texture.loadFromFile("res/textures/container.jpg", GPU, device, commandPool, queue))
-            return false;
-                
         VkDescriptorImageInfo imageInfo = 
         {
-            .sampler     = m_texture.getSampler(),
-            .imageView   = m_texture.getImageView(),
+            .sampler     = m_texture->getSampler(),
+            .imageView   = m_texture->getImageView(),
             .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
         };
 
-        m_descriptorPool->writeCombinedImageSampler(&imageInfo, m_descriptorSets[0], 0);
-        m_descriptorPool->writeCombinedImageSampler(&imageInfo, m_descriptorSets[1], 0);
-    }
-
-    {
-        const std::array<float, 120> vertices = 
+        for (uint32_t frame = 0; frame < m_settings.framesInFlight; ++frame)
         {
-            -0.5f, -0.5f, 0.5f, 0.f, 0.f,
-             0.5f, -0.5f, 0.5f, 1.f, 0.f,
-             0.5f,  0.5f, 0.5f, 1.f, 1.f,
-            -0.5f,  0.5f, 0.5f, 0.f, 1.f,
+            const VkDescriptorBufferInfo instancesInfo = { m_instances.getBuffer(frame), 0, VK_WHOLE_SIZE };
 
-            -0.5f, -0.5f, -0.5f, 0.f, 0.f,
-            -0.5f, -0.5f,  0.5f, 1.f, 0.f,
-            -0.5f,  0.5f,  0.5f, 1.f, 1.f,
-            -0.5f,  0.5f, -0.5f, 0.f, 1.f,
+            m_descriptorPool->writeCombinedImageSampler(&imageInfo, m_descriptorSets[frame], 0);
+            m_descriptorPool->writeStorageBuffer(&instancesInfo, m_descriptorSets[frame], 1);
+        }
 
-             0.5f, -0.5f,  0.5f, 0.f, 0.f,
-             0.5f, -0.5f, -0.5f, 1.f, 0.f,
-             0.5f,  0.5f, -0.5f, 1.f, 1.f,
-             0.5f,  0.5f,  0.5f, 0.f, 1.f,
+        if(m_meshShading)
+        {
+            const VkDescriptorBufferInfo verticesInfo = { m_geometry.getVertexBuffer(), 0, VK_WHOLE_SIZE };
+            const VkDescriptorBufferInfo clustersInfo = { m_geometry.getClusterBuffer(), 0, VK_WHOLE_SIZE };
 
-            -0.5f, -0.5f, -0.5f, 0.f, 0.f,
-             0.5f, -0.5f, -0.5f, 1.f, 0.f,
-             0.5f,  0.5f, -0.5f, 1.f, 1.f,
-            -0.5f,  0.5f, -0.5f, 0.f, 1.f,
+            m_descriptorPool->writeCombinedImageSampler(&imageInfo, m_meshDescriptorSet, 0);
+            m_descriptorPool->writeStorageBuffer(&verticesInfo, m_meshDescriptorSet, 1);
+            m_descriptorPool->writeStorageBuffer(&clustersInfo, m_meshDescriptorSet, 2);
+        }
 
-            -0.5f, 0.5f,  0.5f, 0.f, 0.f,
-             0.5f, 0.5f,  0.5f, 1.f, 0.f,
-             0.5f, 0.5f, -0.5f, 1.f, 1.f,
-            -0.5f, 0.5f, -0.5f, 0.f, 1.f,
+        return true;
+    }, { colorPipelines, meshPipeline, uploadTexture, geometry, instances });
 
-            -0.5f, -0.5f, -0.5f, 0.f, 0.f,
-             0.5f, -0.5f, -0.5f, 1.f, 0.f,
-             0.5f, -0.5f,  0.5f, 1.f, 1.f,
-            -0.5f, -0.5f,  0.5f, 0.f, 1.f
-        };
+    const bool initialized = init.run(m_jobs);
+    init.report("Initialization");
 
-        const std::array<uint32_t, 36> indices = 
-        {
-            0,  1,  2,  2,  3,  0,   // front
-            4,  5,  6,  6,  7,  4,   // left
-            8,  9,  10, 10, 11, 8,   // right
-            12, 13, 14, 14, 15, 12,  // back
-            16, 17, 18, 18, 19, 16,  // top
-            20, 21, 22, 22, 23, 20   // bottom
-        };
-
-        m_holder = std::make_unique<VkResourceHolder>(GPU, device, queue, commandPool);
-        m_vertices = m_holder->createBuffer<float>(vertices, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT); // TODO вынести флаг в constexpr условие со static_assert
-        m_indices = m_holder->createBuffer<uint32_t>(indices, VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
-    }
-
-    return true;
+    return initialized;
 }
 
 
 void Application::mainLoop() noexcept
 {
-    TimeStamp timestamp = Clock::now();
-
     float deltaTime = 0.f;
     float lastFrame = 0.f;
 
@@ -271,17 +778,18 @@ void Application::mainLoop() noexcept
 
     while (!glfwWindowShouldClose(window))
     {
-#ifndef FPS_MEASUREMENT
-        const auto dt = Clock::now() - timestamp;
+    //  Does nothing without --fps (targetFrameRate 0), FPS_MEASUREMENT only adds the counter below
+        m_framePacer.wait();
 
-        if (dt < std::chrono::milliseconds(16)) // 60 FPS regulation
-        { 
-           std::this_thread::sleep_for(std::chrono::milliseconds(1));
-           continue;
+        if (FramePacer::Report report; m_settings.targetFrameRate > 0.f && m_framePacer.takeReport(report))
+        {
+            printf("Pacing: %.2f ms target, %.2f ms present cadence, %.3f ms mean error, %.3f ms max error\n", 
+                   report.interval, report.presentCadence, report.meanError, report.maxError);
         }
+    //  Start as late as the last frame times allow, so the input below is as fresh as possible
+        if(m_lowLatency)
+            m_latencyLimiter.wait(m_mainView.getSwapchain());
 
-        timestamp = Clock::now();
-#endif
         float currentFrame = static_cast<float>(glfwGetTime());
         deltaTime = currentFrame - lastFrame;
         lastFrame = currentFrame;
@@ -301,7 +809,17 @@ void Application::mainLoop() noexcept
         processInput(window, deltaTime);
 
         glfwPollEvents();
+
+    //  Structural changes queued last frame land before any system walks the chunks
+        m_world.flush();
+        animate(deltaTime);
+
+        const uint64_t allocations = HeapCounter::getAllocationCount();
         drawFrame();
+
+    //  Debug builds only: the steady frame path must not touch the heap
+        if(HeapCounter::isEnabled() && m_steadyFrames++ > FRAME_WARMUP && HeapCounter::getAllocationCount() != allocations)
+            printf("drawFrame: %llu heap allocations\n", static_cast<unsigned long long>(HeapCounter::getAllocationCount() - allocations));
     }
 
     vkDeviceWaitIdle(m_context.getDevice());
@@ -312,11 +830,30 @@ void Application::cleanup() noexcept
 {
     auto device = m_context.getDevice();
 
+//  Released assets go through the deletion queue as well
+    m_texture.reset();
+    m_cubeMesh.reset();
+    m_assets.destroy();
+
+//  The device is idle, retired swapchains have to go before the surface
+    m_context.getDeletionQueue().collect(UINT64_MAX);
+
+    m_recorder.destroy();
+    m_graph.destroy();
+    m_clusterCuller.destroy();
+    m_culler.destroy();
+    m_gpuTimer.destroy();
+    m_frameArenas.reset();
+    m_bvh.destroy();
+    m_jobs.destroy();
     m_pipeline.destroy(device);
+    m_prepassPipeline.destroy(device);
+    m_depthPipeline.destroy(device);
+    m_meshPipeline.destroy(device);
     m_descriptorPool->destroy();
 
-    m_texture.destroy(device);
-    m_holder->cleanup();
+    m_geometry.destroy();
+    m_instances.destroy();
 
     m_sync.destroy(device);
 
@@ -330,50 +867,232 @@ void Application::cleanup() noexcept
 }
 
 
+// Queued frames keep using the retired swapchain and pyramid, the deletion queue frees them once the timeline passes their submits
 void Application::recreateSwapChain() noexcept
 {
-    vkDeviceWaitIdle(m_context.getDevice());
+    m_steadyFrames = 0;
     m_mainView.recreate(true);
+    m_latencyLimiter.reset();
+    m_framePacer.setVsync(m_mainView.getPresentMode() == VK_PRESENT_MODE_FIFO_KHR);
+
+    const bool pyramidRebuilt = m_occlusionCulling && m_culler.needsRebuild(m_mainView);
+
+    if(m_occlusionCulling)
+        m_occlusionCulling = (m_culler.resize(m_mainView) == VK_SUCCESS);
+
+    if(m_clusterCulling)
+        m_clusterCulling = m_occlusionCulling && (!pyramidRebuilt || m_clusterCuller.resize(m_context, m_culler) == VK_SUCCESS);
 }
 
 
-// world space positions of our cubes
-static const std::array<vec3s, 10> cubePositions =
+
+// A frame that fails after vkAcquireNextImageKHR still owes the acquire semaphore a wait and the image a present.
+// The wait is consumed by an empty submit, the image cannot be presented in whatever layout it was left in,
+// so the swapchain is recreated instead, which releases it together with the old one
+void Application::abandonFrame(uint32_t frame) noexcept
 {
-    vec3s { 0.0f,  0.0f,  0.0f },
-    vec3s { 2.0f,  5.0f, -15.0f },
-    vec3s { -1.5f, -2.2f, -2.5f },
-    vec3s { -3.8f, -2.0f, -12.3f },
-    vec3s { 2.4f, -0.4f, -3.5f },
-    vec3s { -1.7f,  3.0f, -7.5f },
-    vec3s { 1.3f, -2.0f, -2.5f },
-    vec3s { 1.5f,  2.0f, -2.5f },
-    vec3s { 1.5f,  0.2f, -1.5f },
-    vec3s { -1.3f,  1.0f, -1.5f }
-};
+    if (!m_sync.skip(m_context.getQueue(), frame))
+        printf("failed to submit an abandoned frame!");
 
+    m_context.getDeletionQueue().setSubmittedValue(m_sync.timelineValue);
 
-void Application::updateUniformBuffer(vec3s pos, float angle) noexcept
+    recreateSwapChain();
+}
+
+
+// firstInstance is the draw index, the vertex shaders fetch the model matrix with it
+void Application::writeCommandBuffer(VkCommandBuffer cmd, VkBuffer drawCommands, uint32_t drawIndex) noexcept
 {
-    mat4s model = glms_translate(glms_mat4_identity(), pos);
-    model = glms_rotate(model, glm_rad(angle), vec3s {1.0f, 0.3f, 0.5f});
-    auto view = camera.GetViewMatrix();
-    mat4s proj = glms_perspective(glm_rad(60.f), m_width / (float)m_height, 0.1f, 100.f);
-    proj.col[1].y *= -1;
+    if(drawCommands) // written by the occlusion or cluster culling pass
+        vkCmdDrawIndexedIndirect(cmd, drawCommands, drawIndex * sizeof(VkDrawIndexedIndirectCommand), 1, sizeof(VkDrawIndexedIndirectCommand));
+    else
+    {
+        const auto& lod = m_cubeMesh->lods[m_instanceLods[drawIndex]];
+        vkCmdDrawIndexed(cmd, lod.indexCount, 1, lod.firstIndex, lod.vertexOffset, drawIndex);
+    }
+}
 
-    m_mvp = glms_mat4_mul(glms_mat4_mul(proj, view), model); 
+
+// Called from the recorder threads, so it only reads application state.
+// The pipeline follows the material of each entry, the queue is sorted by material so it changes once per run of entries.
+// The depth-only pass skips materials without a pre-pass, the color pass draws them with LESS and the others with EQUAL
+void Application::recordDraws(VkCommandBuffer cmd, bool depthOnly, VkDescriptorSet descriptorSet, VkBuffer drawCommands, VkBuffer drawIndices, uint32_t first, uint32_t last) noexcept
+{
+    m_geometry.bind(cmd);
+
+//  Compacted cluster triangles replace the pool's indices, the vertices stay where they are
+    if(drawIndices)
+        vkCmdBindIndexBuffer(cmd, drawIndices, 0, VK_INDEX_TYPE_UINT32);
+
+    const auto entries = m_renderQueue.getEntries();
+    const GraphicsPipeline* bound = nullptr;
+
+    for (uint32_t i = first; i < last; ++i)
+    {
+        const Material& material = m_materials[RenderQueue::getMaterial(entries[i].key)];
+        const bool      prepass  = m_settings.depthPrepass && material.prepassPipeline;
+
+        const GraphicsPipeline* pipeline = depthOnly ? (prepass ? &m_depthPipeline : nullptr) : 
+                                                       (prepass ? material.prepassPipeline : material.pipeline);
+
+        if(!pipeline)
+            continue;
+
+        if(pipeline != bound)
+        {
+            vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->getHandle());
+            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->getLayout(), 0, 1, &descriptorSet, 0, nullptr);
+
+        //  One view-projection for every draw, the model matrices come from the instance buffer
+            vkCmdPushConstants(cmd, pipeline->getLayout(), VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(mat4s), m_viewProjection.raw);
+
+            bound = pipeline;
+        }
+
+        writeCommandBuffer(cmd, drawCommands, entries[i].drawIndex);
+    }
 }
 
 
-void Application::writeCommandBuffer(VkCommandBuffer cmd, uint32_t imageIndex, VkDescriptorSet descriptorSet) noexcept
+// Called from the recorder threads like recordDraws(). One task dispatch per cube, its groups cover the meshlets of the cube's level of detail
+void Application::recordMeshDraws(VkCommandBuffer cmd, uint32_t first, uint32_t last) noexcept
 {
-    VkDeviceSize offsets[] = {0};
-    VkBuffer vertexBuffers[] = {m_vertices.handle};
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_meshPipeline.getHandle());
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_meshPipeline.getLayout(), 0, 1, &m_meshDescriptorSet, 0, nullptr);
+
+    const auto entries = m_renderQueue.getEntries();
+    const vec4s eye    = { camera.Position.x, camera.Position.y, camera.Position.z, 1.f };
+
+    for (uint32_t i = first; i < last; ++i)
+    {
+        const uint32_t drawIndex = entries[i].drawIndex;
+        const mat4s&   model     = m_transforms.getModel(drawIndex);
+        const auto&    lod       = m_cubeMesh->lods[m_instanceLods[drawIndex]];
+        const auto&    meshlets  = m_cubeMesh->lodMeshlets[m_instanceLods[drawIndex]];
+
+        const MeshDrawConstants constants = 
+        {
+            .modelViewProjection = glms_mat4_mul(m_viewProjection, model),
+            .cameraPosition      = glms_mat4_mulv(glms_mat4_inv(model), eye),
+            .clusterOffset       = lod.clusterOffset,
+            .firstMeshlet        = meshlets.first,
+            .meshletCount        = meshlets.count,
+            .vertexOffset        = lod.vertexOffset
+        };
 
-    vkCmdBindVertexBuffers(cmd, 0, 1, vertexBuffers, offsets);
-    vkCmdBindIndexBuffer(cmd, m_indices.handle, 0, VK_INDEX_TYPE_UINT32);
-    vkCmdPushConstants(cmd, m_pipeline.getLayout(), VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(mat4s), m_mvp.raw);
-    vkCmdDrawIndexed(cmd, m_indices.size, 1, 0, 0, 0);
+        vkCmdPushConstants(cmd, m_meshPipeline.getLayout(), VK_SHADER_STAGE_TASK_BIT_EXT | VK_SHADER_STAGE_MESH_BIT_EXT, 0, sizeof(MeshDrawConstants), &constants);
+        m_drawMeshTasks(cmd, (meshlets.count + MESHLETS_PER_TASK - 1) / MESHLETS_PER_TASK, 1, 1);
+    }
+}
+
+
+void Application::drawScene(VkCommandBuffer cmd, uint32_t frame, VkDescriptorSet descriptorSet, VkBuffer drawCommands, VkBuffer drawIndices) noexcept
+{
+    const uint32_t drawCount = static_cast<uint32_t>(m_renderQueue.getEntries().size());
+
+    if(m_meshShading)
+    {// Without a pre-pass, the task stage already drops what the camera cannot see
+        m_recorder.record(cmd, frame, m_mainView, m_renderExtent, drawCount, [&](VkCommandBuffer secondary, uint32_t first, uint32_t last)
+        {
+            recordMeshDraws(secondary, first, last);
+        });
+
+        return;
+    }
+    const bool prepass = m_settings.depthPrepass && std::any_of(m_materials.begin(), m_materials.end(), [](const Material& material) { return material.prepassPipeline != nullptr; });
+
+    if(prepass)
+    {// Depth only, the color pass below shades each pixel of a pre-pass material once
+        m_recorder.record(cmd, frame, m_mainView, m_renderExtent, drawCount, [&](VkCommandBuffer secondary, uint32_t first, uint32_t last)
+        {
+            recordDraws(secondary, true, descriptorSet, drawCommands, drawIndices, first, last);
+        });
+    }
+
+    m_recorder.record(cmd, frame, m_mainView, m_renderExtent, drawCount, [&](VkCommandBuffer secondary, uint32_t first, uint32_t last)
+    {
+        recordDraws(secondary, false, descriptorSet, drawCommands, drawIndices, first, last);
+    });
+}
+
+
+// The slot's previous frame has completed, so its GPU time is available and steers the scale of this one
+void Application::updateRenderScale(uint32_t frame) noexcept
+{
+    const VkExtent2D outputExtent = m_mainView.getExtent();
+
+    if(!m_dynamicResolution)
+    {
+        m_renderExtent = outputExtent;
+        return;
+    }
+
+    if(float gpuTime; m_gpuTimer.getResult(frame, gpuTime))
+        m_resolution.update(gpuTime, m_frameScales[frame]);
+
+    m_renderExtent = m_resolution.getRenderExtent(outputExtent);
+
+//  The scale actually rendered, after rounding the extent
+    m_frameScales[frame] = std::sqrt(static_cast<float>(m_renderExtent.width * m_renderExtent.height) / (outputExtent.width * outputExtent.height));
+}
+
+
+void Application::buildRenderQueue() noexcept
+{
+    m_renderQueue.clear();
+
+//  Errors are measured in render target pixels, so dynamic resolution lowers the detail along with the resolution
+    m_lodSelector.setProjection(glm_rad(FOV), static_cast<float>(m_renderExtent.height));
+    const std::span<const float> lodErrors(m_cubeMesh->lodErrors.data(), m_cubeMesh->lodCount);
+
+//  Only what the frustum query returns is queued, the GPU culling paths would drop the rest anyway.
+//  All cubes share one pipeline and material, the level of detail and then the distance to the camera order them
+    m_bvh.queryFrustum(Bvh::makeFrustum(m_viewProjection), [this, lodErrors](uint32_t index)
+    {
+        if(index >= MAX_INSTANCES)
+            return;
+
+        const float distance = glms_vec3_distance(camera.Position, m_transforms.getPosition(index));
+        const float radius   = get_radius(m_bvh.getBounds(index));
+
+        m_instanceLods[index] = m_lodSelector.select(lodErrors, 1.f, std::max(distance - radius, 0.f), m_instanceLods[index]);
+
+        m_renderQueue.push(RenderQueue::makeKey(0, CUBE_MATERIAL, m_instanceLods[index], distance / Z_FAR), index);
+    });
+
+    m_renderQueue.sort();
+}
+
+
+void Application::animate(float dt) noexcept
+{
+    m_world.eachChunk<Transform, Spin>([this, dt](uint32_t count, const World::Entity*, const Transform* transforms, Spin* spins)
+    {
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            spins[i].angle = std::fmod(spins[i].angle + spins[i].speed * dt, 2.f * GLM_PIf);
+            m_transforms.setRotation(transforms[i].index, glms_quatv(spins[i].angle, spins[i].axis));
+        }
+    });
+}
+
+
+// The cursor is captured for mouse look, so the ray goes through the middle of the screen
+void Application::pick() noexcept
+{
+    Bvh::Hit hit;
+
+    if(!m_bvh.raycast(camera.Position, camera.Front, Z_FAR, hit))
+        return;
+
+    uint32_t neighbours = 0;
+
+    m_bvh.querySphere(m_transforms.getPosition(hit.item), PICK_NEIGHBOURHOOD, [&neighbours, &hit](uint32_t item)
+    {
+        neighbours += (item != hit.item);
+    });
+
+    printf("picked cube %u at %.2f, %u more within %.1f\n", hit.item, hit.distance, neighbours, PICK_NEIGHBOURHOOD);
 }
 
 
@@ -383,7 +1102,28 @@ void Application::drawFrame() noexcept
     auto device = m_context.getDevice();
     auto queue  = m_context.getQueue();
 
-    vkWaitForFences(device, 1, &m_sync.inFlightFences[frame], VK_TRUE, UINT64_MAX);
+//  The frame slot is free once the GPU has reached the value its previous submit signaled
+    m_sync.wait(device, m_sync.frameTimelineValues[frame]);
+    m_context.getDeletionQueue().collect(m_sync.completedValue);
+
+    auto& frameArena = m_frameArenas[frame];
+    frameArena.reset();
+
+//  Only objects that changed are composed, the slot's copy also picks up what changed while it was in flight
+    const auto changed = m_transforms.update();
+
+    m_instances.markChanged(changed);
+    m_instances.write(frame, m_transforms.getModels());
+
+//  Moved cubes keep the size of their box, only the nodes above them are refitted
+    for (auto index : changed)
+        if(m_bvh.contains(index))
+            m_bvh.setBounds(index, Bvh::makeBounds(m_transforms.getPosition(index), get_radius(m_bvh.getBounds(index))));
+
+    m_bvh.refit(m_jobs);
+
+    m_assets.update();
+    m_geometry.collect(m_sync.completedValue);
 
     uint32_t imageIndex;
     VkResult result = vkAcquireNextImageKHR(device, m_mainView.getSwapchain(), UINT64_MAX, m_sync.imageAvailableSemaphores[frame], VK_NULL_HANDLE, &imageIndex);
@@ -398,45 +1138,293 @@ void Application::drawFrame() noexcept
         printf("failed to acquire swap chain image!");
     }
 
-    vkResetFences(device, 1, &m_sync.inFlightFences[frame]);
-
     auto commandBuffer = m_commandPool.commandBuffers[frame];
     auto descriptorSet = m_descriptorSets[frame];
 
+    if(m_recorder.resetFrame(frame) != VK_SUCCESS)
+    {
+        abandonFrame(frame);
+        return;
+    }
+
+    updateRenderScale(frame);
+
+    mat4s proj = glms_perspective(glm_rad(FOV), m_width / (float)m_height, Z_NEAR, Z_FAR);
+    proj.col[1].y *= -1;
+
+    const mat4s view = camera.GetViewMatrix();
+    m_viewProjection = glms_mat4_mul(proj, view);
+
+    buildRenderQueue();
+
     vkResetCommandBuffer(commandBuffer, /*VkCommandBufferResetFlagBits*/ 0);
 
-    if(Render::begin(commandBuffer, m_mainView, imageIndex) != VK_SUCCESS)
+    if(Render::beginFrame(commandBuffer) != VK_SUCCESS)
+    {
+        abandonFrame(frame);
         return;
+    }
+
+    m_graph.reset(frameArena);
+
+    const auto colorTarget = m_graph.importImage(m_mainView.getImage(imageIndex), VK_IMAGE_ASPECT_COLOR_BIT, 1, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+                                                 VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_NONE); // chained with the acquire semaphore wait
+    const auto depthTarget = m_graph.importImage(m_mainView.getDepthImage(), VK_IMAGE_ASPECT_DEPTH_BIT, 1, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_UNDEFINED,
+                                                 VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT, VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT);
+
+//  With dynamic resolution the scene goes to the top-left corner of an internal target and is blitted to the swapchain image afterwards,
+//  the target has the size of the largest scale, so scale changes never reallocate it. Depth uses the same corner of the depth image
+    const auto sceneColor = m_dynamicResolution ? m_graph.createImage(
+    {
+        .format    = m_mainView.getFormat(),
+        .extent    = m_resolution.getMaxExtent(m_mainView.getExtent()),
+        .usage     = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+        .aspect    = VK_IMAGE_ASPECT_COLOR_BIT,
+        .mipLevels = 1
+    }) : colorTarget;
+
+    const auto beginScenePass = [&](VkCommandBuffer cmd, VkAttachmentLoadOp loadOp)
+    {
+        const VkImageView colorView = m_dynamicResolution ? m_graph.getImageView(sceneColor) : m_mainView.getImageView(imageIndex);
+        Render::beginPass(cmd, colorView, m_mainView.getDepthImageView(), m_renderExtent, loadOp, VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT);
+    };
+
+    OcclusionCuller::ViewParams params = 
+    {
+        .view       = view,
+        .projection = proj,
+        .znear      = Z_NEAR,
+        .zfar       = Z_FAR
+    };
+
+    if(m_clusterCulling)
+    {
+    //  Indexed by transform slot, slots without a renderable stay empty and draw nothing
+        const auto instances = frameArena.allocate<ClusterCuller::Instance>(std::min(m_transforms.getCount(), MAX_INSTANCES));
+
+        m_world.eachChunk<Transform, Renderable>([&](uint32_t count, const World::Entity*, const Transform* transforms, const Renderable*)
+        {
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                const uint32_t index = transforms[i].index;
+
+                if(index >= instances.size())
+                    continue;
 
-    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline.getHandle());
-    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline.getLayout(), 0, 1, &descriptorSet, 0, nullptr);
+                const auto& lod      = m_cubeMesh->lods[m_instanceLods[index]];
+                const auto& meshlets = m_cubeMesh->lodMeshlets[m_instanceLods[index]];
 
-    for (size_t i = 0; i < cubePositions.size(); ++i)
+                instances[index] = 
+                {
+                    .model         = m_transforms.getModel(index),
+                    .clusterOffset = lod.clusterOffset,
+                    .firstMeshlet  = meshlets.first,
+                    .meshletCount  = meshlets.count,
+                    .vertexOffset  = lod.vertexOffset,
+                    .indexCount    = lod.indexCount
+                };
+            }
+        });
+
+        m_clusterCuller.setInstances(frame, instances);
+
+        const auto visibility    = m_graph.importBuffer(m_clusterCuller.getVisibility(), VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT);
+        const auto earlyCommands = m_graph.importBuffer(m_clusterCuller.getEarlyCommands(), VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT, VK_ACCESS_2_NONE);
+        const auto lateCommands  = m_graph.importBuffer(m_clusterCuller.getLateCommands(), VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT, VK_ACCESS_2_NONE);
+        const auto earlyIndices  = m_graph.importBuffer(m_clusterCuller.getEarlyIndices(), VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT, VK_ACCESS_2_NONE);
+        const auto lateIndices   = m_graph.importBuffer(m_clusterCuller.getLateIndices(), VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT, VK_ACCESS_2_NONE);
+        const auto depthPyramid  = m_graph.importImage(m_culler.getDepthPyramid(), VK_IMAGE_ASPECT_COLOR_BIT, m_culler.getDepthPyramidLevels(), VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_UNDEFINED,
+                                                       VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_NONE);
+
+    //  Phase 1: draw the clusters that were visible last frame
+        m_graph.addPass("cull clusters early", [&](VkCommandBuffer cmd) { m_clusterCuller.cullEarly(cmd, frame, params); })
+            .write(visibility, RenderGraph::Usage::TransferDst) // cleared after a resize
+            .write(earlyCommands, RenderGraph::Usage::TransferDst)
+            .read(visibility, RenderGraph::Usage::StorageRead)
+            .write(earlyCommands, RenderGraph::Usage::StorageWrite)
+            .write(earlyIndices, RenderGraph::Usage::StorageWrite);
+
+        m_graph.addPass("draw early", [&](VkCommandBuffer cmd)
+        {
+            beginScenePass(cmd, VK_ATTACHMENT_LOAD_OP_CLEAR);
+            drawScene(cmd, frame, descriptorSet, m_clusterCuller.getEarlyCommands(), m_clusterCuller.getEarlyIndices());
+            Render::endPass(cmd);
+        })
+            .read(earlyCommands, RenderGraph::Usage::IndirectRead)
+            .read(earlyIndices, RenderGraph::Usage::IndexRead)
+            .write(sceneColor, RenderGraph::Usage::ColorAttachment)
+            .write(depthTarget, RenderGraph::Usage::DepthAttachment);
+
+    //  Phase 2: test every cluster against the fresh depth pyramid and draw what became visible
+        m_graph.addPass("depth pyramid", [&](VkCommandBuffer cmd) { m_culler.buildDepthPyramid(cmd, m_renderExtent); })
+            .read(depthTarget, RenderGraph::Usage::SampledCompute)
+            .write(depthPyramid, RenderGraph::Usage::StorageWrite);
+
+        m_graph.addPass("cull clusters late", [&](VkCommandBuffer cmd) { m_clusterCuller.cullLate(cmd, frame, params); })
+            .write(lateCommands, RenderGraph::Usage::TransferDst)
+            .read(depthPyramid, RenderGraph::Usage::SampledCompute)
+            .write(visibility, RenderGraph::Usage::StorageWrite)
+            .write(lateCommands, RenderGraph::Usage::StorageWrite)
+            .write(lateIndices, RenderGraph::Usage::StorageWrite);
+
+        m_graph.addPass("draw late", [&](VkCommandBuffer cmd)
+        {
+            beginScenePass(cmd, VK_ATTACHMENT_LOAD_OP_LOAD);
+            drawScene(cmd, frame, descriptorSet, m_clusterCuller.getLateCommands(), m_clusterCuller.getLateIndices());
+            Render::endPass(cmd);
+        })
+            .read(lateCommands, RenderGraph::Usage::IndirectRead)
+            .read(lateIndices, RenderGraph::Usage::IndexRead)
+            .write(sceneColor, RenderGraph::Usage::ColorAttachment)
+            .write(depthTarget, RenderGraph::Usage::DepthAttachment);
+    }
+    else if(m_occlusionCulling)
     {
-        const float angle = 20.f * i;
-        updateUniformBuffer(cubePositions[i], angle);
-        writeCommandBuffer(commandBuffer, imageIndex, descriptorSet);
+    //  Indexed by transform slot like the cluster instances
+        const auto objects = frameArena.allocate<OcclusionCuller::Object>(std::min(m_transforms.getCount(), MAX_INSTANCES));
+
+        m_world.eachChunk<Transform, Renderable>([&](uint32_t count, const World::Entity*, const Transform* transforms, const Renderable* renderables)
+        {
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                const uint32_t index = transforms[i].index;
+
+                if(index >= objects.size())
+                    continue;
+
+                const auto& lod      = m_cubeMesh->lods[m_instanceLods[index]];
+                const vec3s position = m_transforms.getPosition(index);
+
+                objects[index] = 
+                {
+                    .sphere        = { position.x, position.y, position.z, renderables[i].radius },
+                    .indexCount    = lod.indexCount,
+                    .firstIndex    = lod.firstIndex,
+                    .vertexOffset  = lod.vertexOffset,
+                    .firstInstance = index
+                };
+            }
+        });
+
+        m_culler.setObjects(frame, objects);
+
+        const auto visibility    = m_graph.importBuffer(m_culler.getVisibility(), VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT);
+        const auto earlyCommands = m_graph.importBuffer(m_culler.getEarlyCommands(), VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT, VK_ACCESS_2_NONE);
+        const auto lateCommands  = m_graph.importBuffer(m_culler.getLateCommands(), VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT, VK_ACCESS_2_NONE);
+        const auto depthPyramid  = m_graph.importImage(m_culler.getDepthPyramid(), VK_IMAGE_ASPECT_COLOR_BIT, m_culler.getDepthPyramidLevels(), VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_UNDEFINED,
+                                                       VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_NONE);
+
+    //  Phase 1: draw what was visible last frame
+        m_graph.addPass("cull early", [&](VkCommandBuffer cmd) { m_culler.cullEarly(cmd, frame, params); })
+            .write(visibility, RenderGraph::Usage::TransferDst) // cleared after a resize
+            .read(visibility, RenderGraph::Usage::StorageRead)
+            .write(earlyCommands, RenderGraph::Usage::StorageWrite);
+
+        m_graph.addPass("draw early", [&](VkCommandBuffer cmd)
+        {
+            beginScenePass(cmd, VK_ATTACHMENT_LOAD_OP_CLEAR);
+            drawScene(cmd, frame, descriptorSet, m_culler.getEarlyCommands());
+            Render::endPass(cmd);
+        })
+            .read(earlyCommands, RenderGraph::Usage::IndirectRead)
+            .write(sceneColor, RenderGraph::Usage::ColorAttachment)
+            .write(depthTarget, RenderGraph::Usage::DepthAttachment);
+
+    //  Phase 2: test everything against the fresh depth pyramid and draw what became visible
+        m_graph.addPass("depth pyramid", [&](VkCommandBuffer cmd) { m_culler.buildDepthPyramid(cmd, m_renderExtent); })
+            .read(depthTarget, RenderGraph::Usage::SampledCompute)
+            .write(depthPyramid, RenderGraph::Usage::StorageWrite);
+
+        m_graph.addPass("cull late", [&](VkCommandBuffer cmd) { m_culler.cullLate(cmd, frame, params); })
+            .read(depthPyramid, RenderGraph::Usage::SampledCompute)
+            .write(visibility, RenderGraph::Usage::StorageWrite)
+            .write(lateCommands, RenderGraph::Usage::StorageWrite);
+
+        m_graph.addPass("draw late", [&](VkCommandBuffer cmd)
+        {
+            beginScenePass(cmd, VK_ATTACHMENT_LOAD_OP_LOAD);
+            drawScene(cmd, frame, descriptorSet, m_culler.getLateCommands());
+            Render::endPass(cmd);
+        })
+            .read(lateCommands, RenderGraph::Usage::IndirectRead)
+            .write(sceneColor, RenderGraph::Usage::ColorAttachment)
+            .write(depthTarget, RenderGraph::Usage::DepthAttachment);
+    }
+    else
+    {
+        m_graph.addPass("draw", [&](VkCommandBuffer cmd)
+        {
+            beginScenePass(cmd, VK_ATTACHMENT_LOAD_OP_CLEAR);
+            drawScene(cmd, frame, descriptorSet, nullptr);
+            Render::endPass(cmd);
+        })
+            .write(sceneColor, RenderGraph::Usage::ColorAttachment)
+            .write(depthTarget, RenderGraph::Usage::DepthAttachment);
     }
 
-    if(Render::end(commandBuffer, m_mainView, imageIndex) != VK_SUCCESS)
+    if(m_dynamicResolution)
+    {
+        m_graph.addPass("upscale", [&](VkCommandBuffer cmd)
+        {
+            const VkExtent2D outputExtent = m_mainView.getExtent();
+
+            const VkImageBlit2 region = 
+            {
+                .sType          = VK_STRUCTURE_TYPE_IMAGE_BLIT_2,
+                .pNext          = nullptr,
+                .srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 },
+                .srcOffsets     = { VkOffset3D{ 0, 0, 0 }, VkOffset3D{ static_cast<int32_t>(m_renderExtent.width), static_cast<int32_t>(m_renderExtent.height), 1 } },
+                .dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 },
+                .dstOffsets     = { VkOffset3D{ 0, 0, 0 }, VkOffset3D{ static_cast<int32_t>(outputExtent.width), static_cast<int32_t>(outputExtent.height), 1 } }
+            };
+
+            const VkBlitImageInfo2 blitInfo = 
+            {
+                .sType          = VK_STRUCTURE_TYPE_BLIT_IMAGE_INFO_2,
+                .pNext          = nullptr,
+                .srcImage       = m_graph.getImage(sceneColor),
+                .srcImageLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                .dstImage       = m_mainView.getImage(imageIndex),
+                .dstImageLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                .regionCount    = 1,
+                .pRegions       = &region,
+                .filter         = VK_FILTER_LINEAR
+            };
+
+            vkCmdBlitImage2(cmd, &blitInfo);
+        })
+            .read(sceneColor, RenderGraph::Usage::TransferSrc)
+            .write(colorTarget, RenderGraph::Usage::TransferDst);
+    }
+
+    if(m_graph.compile() != VK_SUCCESS)
+    {
+        abandonFrame(frame);
         return;
+    }
 
-    VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-    VkSubmitInfo submitInfo = {};
-    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submitInfo.waitSemaphoreCount = 1;
-    submitInfo.pWaitSemaphores = m_sync.imageAvailableSemaphores.data() + frame;
-    submitInfo.pWaitDstStageMask = waitStages;
-    submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &m_commandPool.commandBuffers[frame];
-    submitInfo.signalSemaphoreCount = 1;
-    submitInfo.pSignalSemaphores = &m_sync.renderFinishedSemaphores[frame];
+//  Timed span of the controller: everything the scene costs on the GPU, including culling and the upscale
+    if(m_dynamicResolution)
+        m_gpuTimer.begin(commandBuffer, frame);
 
-    if (auto result = vkQueueSubmit(queue, 1, &submitInfo, m_sync.inFlightFences[frame]); result != VK_SUCCESS)
+    m_graph.execute(commandBuffer);
+
+    if(m_dynamicResolution)
+        m_gpuTimer.end(commandBuffer, frame);
+
+    if(Render::endFrame(commandBuffer) != VK_SUCCESS)
+    {
+        abandonFrame(frame);
+        return;
+    }
+
+    if (!m_sync.submit(queue, commandBuffer, frame))
     {
         printf("failed to submit draw command buffer!");
     }
 
+    m_context.getDeletionQueue().setSubmittedValue(m_sync.timelineValue);
+
     VkPresentInfoKHR presentInfo = {};
     presentInfo.sType              = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
     presentInfo.waitSemaphoreCount = 1;
@@ -445,7 +1433,22 @@ void Application::drawFrame() noexcept
     presentInfo.pSwapchains        = &m_mainView.getSwapchain();
     presentInfo.pImageIndices      = &imageIndex;
 
+    VkPresentIdKHR presentId = {};
+    uint64_t       presentIdValue = 0;
+
+    if(m_lowLatency)
+    {
+        presentIdValue = m_latencyLimiter.nextPresentId();
+
+        presentId.sType          = VK_STRUCTURE_TYPE_PRESENT_ID_KHR;
+        presentId.swapchainCount = 1;
+        presentId.pPresentIds    = &presentIdValue;
+
+        presentInfo.pNext = &presentId;
+    }
+
     result = vkQueuePresentKHR(queue, &presentInfo);
+    m_framePacer.onPresent();
 
     if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || framebufferResized)
     {
@@ -457,5 +1460,5 @@ void Application::drawFrame() noexcept
         printf("failed to present swap chain image!");
     }
 
-    m_sync.currentFrame = (frame + 1) % MAX_FRAMES_IN_FLIGHT;
+    m_sync.currentFrame = (frame + 1) % m_sync.framesInFlight;
 }
\ No newline at end of file
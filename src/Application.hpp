@@ -5,18 +5,54 @@
 #include <cglm/call/mat4.h>
 
 #include "vulkan_api/utils/Defines.hpp"
+#include "core/FramePacer.hpp"
+#include "core/JobSystem.hpp"
+#include "core/LinearAllocator.hpp"
+#include "core/TransformStore.hpp"
+#include "scene/World.hpp"
+#include "scene/Bvh.hpp"
 #include "vulkan_api/presentation/MainView.hpp"
+#include "vulkan_api/presentation/LatencyLimiter.hpp"
 #include "vulkan_api/pipeline/GraphicsPipeline.hpp"
 #include "vulkan_api/pipeline/descriptors/DescriptorPool.hpp"
 #include "vulkan_api/command_pool/CommandBufferPool.hpp"
+#include "vulkan_api/command_pool/ParallelRecorder.hpp"
 #include "vulkan_api/sync/SyncManager.hpp"
-#include "vulkan_api/texture/Texture2D.hpp"
-#include "vulkan_api/resources/VkResourceHolder.hpp"
+#include "assets/AssetCache.hpp"
+#include "vulkan_api/resources/GeometryPool.hpp"
+#include "vulkan_api/resources/InstanceBuffer.hpp"
+#include "vulkan_api/culling/OcclusionCuller.hpp"
+#include "vulkan_api/culling/ClusterCuller.hpp"
+#include "vulkan_api/render/RenderQueue.hpp"
+#include "vulkan_api/render/RenderGraph.hpp"
+#include "vulkan_api/render/GpuTimer.hpp"
+#include "vulkan_api/render/DynamicResolution.hpp"
+#include "vulkan_api/render/LodSelector.hpp"
 
 class Application
 {
 public:
-    int run() noexcept;
+    struct Settings
+    {
+        uint32_t framesInFlight  = DEFAULT_FRAMES_IN_FLIGHT; // frames the CPU may record ahead of the GPU
+        uint32_t swapchainImages = DEFAULT_SWAPCHAIN_IMAGES; // requested, clamped to the surface limits
+        bool     lowLatency      = false;                    // pace frames with VK_KHR_present_wait when available
+        float    targetFrameRate = 0.f;                      // frame pacer target set with --fps, 0 runs unpaced
+
+        bool  dynamicResolution  = false; // render at a scale that holds the GPU budget and blit to the swapchain
+        float minResolutionScale = 0.5f;
+        float maxResolutionScale = 1.f;
+        float gpuBudgetMs        = 0.f;   // 0 takes the frame interval of targetFrameRate
+
+        float lodPixelError = 1.f; // screen-space error a level of detail may show, 0 always draws full detail
+
+        bool depthPrepass = true; // lay down depth first for the materials that have a pre-pass pipeline
+
+        bool clusterCulling = true;  // cull per meshlet instead of per object when occlusion culling runs
+        bool meshShading    = false; // task and mesh shaders with VK_EXT_mesh_shader, culls per meshlet in the task stage instead of occlusion culling
+    };
+
+    int run(const Settings& settings) noexcept;
 
 private:
     void initWindow() noexcept;
@@ -24,29 +60,84 @@ private:
     void mainLoop() noexcept;
     void cleanup() noexcept;
     void recreateSwapChain() noexcept;
-    void updateUniformBuffer(vec3s pos, float angle) noexcept;
+    void abandonFrame(uint32_t frame) noexcept;
 
-    void writeCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex, VkDescriptorSet descriptorSet) noexcept;
+    void writeCommandBuffer(VkCommandBuffer commandBuffer, VkBuffer drawCommands, uint32_t drawIndex) noexcept;
+    void recordDraws(VkCommandBuffer commandBuffer, bool depthOnly, VkDescriptorSet descriptorSet, VkBuffer drawCommands, VkBuffer drawIndices, uint32_t first, uint32_t last) noexcept;
+    void recordMeshDraws(VkCommandBuffer commandBuffer, uint32_t first, uint32_t last) noexcept;
+    void drawScene(VkCommandBuffer commandBuffer, uint32_t frame, VkDescriptorSet descriptorSet, VkBuffer drawCommands, VkBuffer drawIndices = nullptr) noexcept;
+    void updateRenderScale(uint32_t frame) noexcept;
+    void buildRenderQueue() noexcept;
+    void animate(float dt) noexcept;
+    void pick() noexcept;
     void drawFrame() noexcept;
 
+    struct Material
+    {
+        const GraphicsPipeline* pipeline;        // depth test LESS with writes
+        const GraphicsPipeline* prepassPipeline; // depth test EQUAL without writes, nullptr opts the material out of the pre-pass
+    };
+
     struct GLFWwindow* window;
 
     VulkanContext m_context;
     MainView  m_mainView;
     GraphicsPipeline  m_pipeline;
-    std::array<VkDescriptorSet, MAX_FRAMES_IN_FLIGHT> m_descriptorSets {};
+    GraphicsPipeline  m_prepassPipeline;
+    GraphicsPipeline  m_depthPipeline;
+    std::vector<VkDescriptorSet> m_descriptorSets;
     std::unique_ptr<DescriptorPool> m_descriptorPool;
     
+    JobSystem         m_jobs;
     CommandBufferPool m_commandPool;
+    ParallelRecorder  m_recorder;
     SyncManager       m_sync;
+    LatencyLimiter    m_latencyLimiter;
+
+    Settings   m_settings;
+    bool       m_lowLatency = false;
+    FramePacer m_framePacer;
+
+    AssetCache::TextureHandle m_texture;
+    std::vector<Material>     m_materials; // indexed by the material field of the render queue keys
+
+    RenderQueue m_renderQueue;
+    RenderGraph m_graph;
+
+    std::unique_ptr<LinearAllocator[]> m_frameArenas;      // one per frame in flight
+    uint32_t                           m_steadyFrames = 0; // frames since start-up or the last swapchain recreation
+
+    GpuTimer           m_gpuTimer;
+    DynamicResolution  m_resolution;
+    std::vector<float> m_frameScales; // render scale each frame slot was recorded with
+    VkExtent2D         m_renderExtent {};
+    bool               m_dynamicResolution = false;
+
+    OcclusionCuller m_culler;
+    bool m_occlusionCulling = false;
+
+    ClusterCuller m_clusterCuller;
+    bool m_clusterCulling = false;
+
+    GraphicsPipeline         m_meshPipeline;
+    VkDescriptorSet          m_meshDescriptorSet = nullptr;
+    PFN_vkCmdDrawMeshTasksEXT m_drawMeshTasks    = nullptr;
+    bool                     m_meshShading       = false;
+
+    World          m_world;      // the cubes, their Transform components point into m_transforms
+    Bvh            m_bvh;        // bounds of the renderables by transform slot
+    TransformStore m_transforms;
+    InstanceBuffer m_instances;  // model matrices of m_transforms, indexed by the draw index
 
-    Texture2D m_texture;
+    GeometryPool           m_geometry;
+    AssetCache             m_assets;
+    AssetCache::MeshHandle m_cubeMesh;
+    float                  m_cubeRadius = 0.f;
 
-    std::unique_ptr<VkResourceHolder> m_holder;
-    Buffer m_vertices;
-    Buffer m_indices;
+    LodSelector           m_lodSelector;
+    std::vector<uint32_t> m_instanceLods; // level of detail of every cube, kept between frames for the hysteresis
 
-    mat4s m_mvp;
+    mat4s m_viewProjection;
 
     bool framebufferResized = false;
     int32_t m_width = 0;
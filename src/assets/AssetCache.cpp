@@ -0,0 +1,357 @@
+#include <cstring>
+
+#include <stb_image.h>
+
+#include "core/MappedFile.hpp"
+#include "assets/MeshFile.hpp"
+#include "vulkan_api/context/VulkanContext.hpp"
+#include "vulkan_api/resources/DeletionQueue.hpp"
+#include "assets/AssetCache.hpp"
+
+
+namespace
+{
+//  64-bit multiply-xorshift over 8 byte words, identical content is all that has to collide
+    uint64_t hash_content(std::span<const std::byte> data, uint64_t seed = 0) noexcept
+    {
+        constexpr uint64_t PRIME = 0x9E3779B97F4A7C15ULL;
+
+        uint64_t hash = seed ^ (data.size() * PRIME);
+        size_t   i    = 0;
+
+        for (; i + 8 <= data.size(); i += 8)
+        {
+            uint64_t word;
+            memcpy(&word, data.data() + i, 8);
+
+            hash = (hash ^ (word * PRIME)) * PRIME;
+            hash ^= hash >> 32;
+        }
+
+        for (; i < data.size(); ++i)
+            hash = (hash ^ static_cast<uint64_t>(data[i])) * PRIME;
+
+        hash ^= hash >> 29;
+        hash *= 0xBF58476D1CE4E5B9ULL;
+        hash ^= hash >> 32;
+
+        return hash;
+    }
+
+
+    unsigned char* decode_image(std::span<const std::byte> encoded, uint32_t& width, uint32_t& height) noexcept
+    {
+        int32_t w, h, channels;
+        stbi_uc* pixels = stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(encoded.data()), static_cast<int>(encoded.size()), &w, &h, &channels, STBI_rgb_alpha);
+
+        width  = static_cast<uint32_t>(w);
+        height = static_cast<uint32_t>(h);
+
+        return pixels;
+    }
+}
+
+
+AssetCache::AssetCache() noexcept:
+    m_context(nullptr),
+    m_commandPool(nullptr),
+    m_geometry(nullptr)
+{
+
+}
+
+
+void AssetCache::create(VulkanContext& context, VkCommandPool pool, GeometryPool& geometry, std::span<const VertexInputState::Attribute> meshLayout) noexcept
+{
+    m_context     = &context;
+    m_commandPool = pool;
+    m_geometry    = &geometry;
+
+    m_meshLayout.clear();
+
+    for (const auto& attribute : meshLayout)
+        m_meshLayout.push_back(static_cast<uint32_t>(attribute.type));
+}
+
+
+void AssetCache::destroy() noexcept
+{
+    update();
+
+    std::lock_guard lock(m_mutex);
+
+    for (auto& [path, decoded] : m_decodedTextures)
+        stbi_image_free(decoded.pixels);
+
+    m_decodedTextures.clear();
+
+    m_textures = {};
+    m_meshes   = {};
+}
+
+
+AssetCache::TextureHandle AssetCache::loadTexture(const char* path) noexcept
+{
+    return load(m_textures, path, [this](const char* path) { return loadTextureUncached(path); });
+}
+
+
+AssetCache::MeshHandle AssetCache::loadMesh(const char* path) noexcept
+{
+    return load(m_meshes, path, [this](const char* path) { return loadMeshUncached(path); });
+}
+
+
+bool AssetCache::prefetchTexture(const char* path) noexcept
+{
+    MappedFile file;
+
+    if (!file.open(path))
+        return false;
+
+    DecodedTexture decoded = { .hash = hash_content(file.getData()) };
+
+    if (decoded.pixels = decode_image(file.getData(), decoded.width, decoded.height); !decoded.pixels)
+        return false;
+
+    std::lock_guard lock(m_mutex);
+
+    if (!m_decodedTextures.try_emplace(path, decoded).second)
+        stbi_image_free(decoded.pixels);
+
+    return true;
+}
+
+
+// No handle may be destroyed while m_mutex is held, the deleters lock it too
+template <class Asset, class Loader>
+std::shared_ptr<const Asset> AssetCache::load(Table<Asset>& table, const char* path, Loader&& loadUncached) noexcept
+{
+    std::promise<std::shared_ptr<const Asset>> promise;
+
+    {
+        std::unique_lock lock(m_mutex);
+        auto& record = table.byPath[path];
+
+        if (auto asset = record.asset.lock())
+            return asset;
+
+        if (record.pending.valid())
+        {
+            auto pending = record.pending;
+            lock.unlock();
+
+            return pending.get();
+        }
+
+        record.pending = promise.get_future().share();
+    }
+
+    auto asset = loadUncached(path);
+
+    {
+        std::lock_guard lock(m_mutex);
+        table.byPath[path] = { asset, {} };
+    }
+
+//  A failed load is not remembered, the next request tries again
+    promise.set_value(asset);
+
+    return asset;
+}
+
+
+AssetCache::TextureHandle AssetCache::loadTextureUncached(const char* path) noexcept
+{
+    DecodedTexture decoded = {};
+    MappedFile     file;
+
+    {
+        std::lock_guard lock(m_mutex);
+
+        if (auto it = m_decodedTextures.find(path); it != m_decodedTextures.end())
+        {
+            decoded = it->second;
+            m_decodedTextures.erase(it);
+        }
+    }
+
+    if (!decoded.pixels)
+    {
+        if (!file.open(path))
+            return nullptr;
+
+        decoded.hash = hash_content(file.getData());
+    }
+
+    const uint64_t hash = decoded.hash;
+
+    {
+        std::lock_guard lock(m_mutex);
+
+        if (auto it = m_textures.byContent.find(hash); it != m_textures.byContent.end())
+        {
+            if (auto texture = it->second.lock())
+            {
+                stbi_image_free(decoded.pixels);
+                return texture;
+            }
+        }
+    }
+
+//  Decoding runs in parallel, only the upload is serialized
+    if (!decoded.pixels)
+        if (decoded.pixels = decode_image(file.getData(), decoded.width, decoded.height); !decoded.pixels)
+            return nullptr;
+
+    auto texture = new Texture2D();
+    bool loaded  = false;
+
+    {
+        std::lock_guard lock(m_uploadMutex);
+        loaded = texture->loadFromPixels(decoded.pixels, decoded.width, decoded.height, 
+                                         m_context->getPhysicalDevice(), m_context->getDevice(), m_commandPool, m_context->getQueue());
+    }
+
+    stbi_image_free(decoded.pixels);
+
+    if (!loaded)
+    {
+        texture->destroy(m_context->getDevice());
+        delete texture;
+
+        return nullptr;
+    }
+
+    TextureHandle handle(texture, [this](const Texture2D* texture)
+    {
+        std::lock_guard lock(m_mutex);
+        m_releasedTextures.push_back(const_cast<Texture2D*>(texture));
+    });
+
+    std::lock_guard lock(m_mutex);
+    m_textures.byContent[hash] = handle;
+
+    return handle;
+}
+
+
+AssetCache::MeshHandle AssetCache::loadMeshUncached(const char* path) noexcept
+{
+    MeshFile file;
+
+    if (!file.open(path))
+        return nullptr;
+
+    const auto layout = file.getAttributes();
+
+    if (!std::equal(layout.begin(), layout.end(), m_meshLayout.begin(), m_meshLayout.end()))
+        return nullptr;
+
+    const auto& header = file.getHeader();
+
+//  Everything the asset is built from: the same vertices and indices with a different layout, index size, LOD or cluster table are another mesh
+    uint64_t hash = hash_content(file.getVertices());
+    hash = hash_content(file.getIndices(), hash);
+    hash = hash_content(std::as_bytes(layout), hash ^ header.indexSize);
+    hash = hash_content(std::as_bytes(file.getLods()), hash);
+    hash = hash_content(file.getClusters(), hash);
+
+    {
+        std::lock_guard lock(m_mutex);
+
+        if (auto it = m_meshes.byContent.find(hash); it != m_meshes.byContent.end())
+            if (auto mesh = it->second.lock())
+                return mesh;
+    }
+
+    auto asset = new MeshAsset
+    {
+        .mesh        = {},
+        .sphere      = { header.sphere[0], header.sphere[1], header.sphere[2], header.sphere[3] },
+        .lods        = {},
+        .lodErrors   = {},
+        .lodMeshlets = {},
+        .lodCount    = header.lodCount
+    };
+    bool uploaded = false;
+
+    {
+        std::lock_guard lock(m_uploadMutex);
+        uploaded = m_geometry->upload(file.getVertices(), file.getIndices(), file.getIndexType(), file.getClusters(), m_commandPool, m_context->getQueue(), asset->mesh);
+    }
+
+    if (!uploaded)
+    {
+        delete asset;
+        return nullptr;
+    }
+
+    const auto lods = file.getLods();
+
+    for (uint32_t i = 0; i < asset->lodCount; ++i)
+    {
+        asset->lods[i] = 
+        {
+            .vertexOffset  = asset->mesh.vertexOffset,
+            .vertexCount   = asset->mesh.vertexCount,
+            .firstIndex    = asset->mesh.firstIndex + lods[i].firstIndex,
+            .indexCount    = lods[i].indexCount,
+            .clusterOffset = asset->mesh.clusterOffset,
+            .clusterSize   = asset->mesh.clusterSize
+        };
+
+        asset->lodErrors[i]   = lods[i].error;
+        asset->lodMeshlets[i] = { lods[i].firstMeshlet, lods[i].meshletCount };
+    }
+
+    MeshHandle handle(asset, [this](const MeshAsset* asset)
+    {
+        std::lock_guard lock(m_mutex);
+        m_releasedMeshes.push_back(const_cast<MeshAsset*>(asset));
+    });
+
+    std::lock_guard lock(m_mutex);
+    m_meshes.byContent[hash] = handle;
+
+    return handle;
+}
+
+
+void AssetCache::update() noexcept
+{
+    std::vector<Texture2D*> textures;
+    std::vector<MeshAsset*> meshes;
+
+    {
+        std::lock_guard lock(m_mutex);
+
+        textures.swap(m_releasedTextures);
+        meshes.swap(m_releasedMeshes);
+
+        if (!textures.empty() || !meshes.empty())
+        {
+            std::erase_if(m_textures.byContent, [](const auto& entry) { return entry.second.expired(); });
+            std::erase_if(m_meshes.byContent,   [](const auto& entry) { return entry.second.expired(); });
+
+            std::erase_if(m_textures.byPath, [](const auto& entry) { return entry.second.asset.expired() && !entry.second.pending.valid(); });
+            std::erase_if(m_meshes.byPath,   [](const auto& entry) { return entry.second.asset.expired() && !entry.second.pending.valid(); });
+        }
+    }
+
+    auto& deletionQueue = m_context->getDeletionQueue();
+
+    for (auto texture : textures)
+    {
+        texture->destroy(deletionQueue);
+        delete texture;
+    }
+
+    std::lock_guard lock(m_uploadMutex);
+
+    for (auto asset : meshes)
+    {
+        m_geometry->release(asset->mesh, deletionQueue.getSubmittedValue());
+        delete asset;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,113 @@
+#ifndef ASSET_CACHE_HPP
+#define ASSET_CACHE_HPP
+
+#include <span>
+#include <array>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <vector>
+#include <future>
+#include <cstdint>
+#include <unordered_map>
+
+#include "assets/MeshFile.hpp"
+#include "vulkan_api/texture/Texture2D.hpp"
+#include "vulkan_api/resources/GeometryPool.hpp"
+#include "vulkan_api/pipeline/stages/vertex/VertexInputState.hpp"
+
+
+// Shared textures and meshes behind reference counted handles.
+// Assets are looked up by path first and by a hash of their content second, so the same file under
+// another name is decoded and uploaded only once. Threads asking for an asset that is still loading
+// wait for that load instead of starting their own.
+// When the last handle goes away the GPU resources are handed to the deletion queue by the next update(),
+// frames in flight can keep using them until then.
+class AssetCache
+{
+public:
+    struct MeshletRange
+    {
+        uint32_t first;
+        uint32_t count;
+    };
+
+    struct MeshAsset
+    {
+        GeometryPool::Mesh mesh;      // every level, owns the pool ranges
+        float              sphere[4]; // bounds from the mesh file
+
+    //  Levels of detail from full detail down, each a part of the mesh's index range
+        std::array<GeometryPool::Mesh, MeshFile::MAX_LODS> lods;
+        std::array<float, MeshFile::MAX_LODS>              lodErrors;   // in position units
+        std::array<MeshletRange, MeshFile::MAX_LODS>       lodMeshlets; // into the cluster blob at mesh.clusterOffset
+        uint32_t                                           lodCount;
+    };
+
+    using TextureHandle = std::shared_ptr<const Texture2D>;
+    using MeshHandle    = std::shared_ptr<const MeshAsset>;
+
+    AssetCache() noexcept;
+
+//  Meshes go to the geometry pool and must match its vertex layout
+    void create(class VulkanContext& context, VkCommandPool pool, GeometryPool& geometry, std::span<const VertexInputState::Attribute> meshLayout) noexcept;
+    void destroy() noexcept; // every handle must be gone
+
+//  Thread safe, nullptr when loading fails
+    TextureHandle loadTexture(const char* path) noexcept;
+    MeshHandle    loadMesh(const char* path)    noexcept;
+
+//  Thread safe and needs no device or create(): maps and decodes a texture ahead of time, the next loadTexture() of the path only uploads it
+    bool prefetchTexture(const char* path) noexcept;
+
+//  Main thread, once per frame: releases unreferenced assets and forgets expired entries
+    void update() noexcept;
+
+private:
+    template <class Asset>
+    struct Record
+    {
+        std::weak_ptr<const Asset>                        asset;
+        std::shared_future<std::shared_ptr<const Asset>>  pending; // valid while a load is running
+    };
+
+    template <class Asset>
+    struct Table
+    {
+        std::unordered_map<std::string, Record<Asset>>         byPath;
+        std::unordered_map<uint64_t, std::weak_ptr<const Asset>> byContent;
+    };
+
+    struct DecodedTexture
+    {
+        uint64_t       hash   = 0;       // of the encoded file
+        unsigned char* pixels = nullptr; // RGBA8 from stb_image
+        uint32_t       width  = 0;
+        uint32_t       height = 0;
+    };
+
+    template <class Asset, class Loader>
+    std::shared_ptr<const Asset> load(Table<Asset>& table, const char* path, Loader&& loadUncached) noexcept;
+
+    TextureHandle loadTextureUncached(const char* path) noexcept;
+    MeshHandle    loadMeshUncached(const char* path)    noexcept;
+
+    class VulkanContext* m_context;
+    VkCommandPool        m_commandPool;
+    GeometryPool*        m_geometry;
+
+    std::vector<uint32_t> m_meshLayout; // VertexInputState::Attribute::Type
+
+    std::mutex m_mutex;       // tables and released lists
+    std::mutex m_uploadMutex; // command pool, queue and geometry pool
+
+    Table<Texture2D> m_textures;
+    Table<MeshAsset> m_meshes;
+
+    std::unordered_map<std::string, DecodedTexture> m_decodedTextures; // prefetched, not yet loaded
+
+    std::vector<Texture2D*> m_releasedTextures;
+    std::vector<MeshAsset*> m_releasedMeshes;
+};
+
+#endif // !ASSET_CACHE_HPP
\ No newline at end of file
@@ -0,0 +1,338 @@
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+
+#include "assets/MeshOptimizer.hpp"
+#include "assets/MeshFile.hpp"
+
+
+namespace
+{
+    constexpr uint64_t align_blob(uint64_t offset) noexcept
+    {
+        return (offset + MeshFile::BLOB_ALIGNMENT - 1) & ~static_cast<uint64_t>(MeshFile::BLOB_ALIGNMENT - 1);
+    }
+
+
+//  Range check that cannot overflow
+    bool fits(uint64_t offset, uint64_t size, uint64_t fileSize) noexcept
+    {
+        return offset <= fileSize && size <= fileSize - offset;
+    }
+
+
+//  Every index has to name a vertex, the shaders fetch vertices by index without bounds checks
+    bool indices_in_range(const std::byte* indices, uint32_t count, uint32_t indexSize, uint32_t vertexCount) noexcept
+    {
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            uint32_t index = 0;
+            memcpy(&index, indices + static_cast<size_t>(i) * indexSize, indexSize);
+
+            if(index >= vertexCount)
+                return false;
+        }
+
+        return true;
+    }
+
+
+    bool write_padded(FILE* file, const void* data, size_t size, uint64_t& written) noexcept
+    {
+        static const std::byte zeros[MeshFile::BLOB_ALIGNMENT] = {};
+
+        const uint64_t padding = align_blob(written) - written;
+
+        if(fwrite(zeros, 1, padding, file) != padding || fwrite(data, 1, size, file) != size)
+            return false;
+
+        written += padding + size;
+
+        return true;
+    }
+}
+
+
+bool MeshFile::write(const char* path, const Source& source) noexcept
+{
+    uint32_t vertexStride = 0;
+
+    for (const auto& attribute : source.attributes)
+        vertexStride += static_cast<uint32_t>(attribute.sizeInBytes);
+
+    if(vertexStride == 0 || source.vertices.size() % vertexStride != 0)
+        return false;
+
+    const uint32_t vertexCount = static_cast<uint32_t>(source.vertices.size() / vertexStride);
+    const uint32_t indexCount  = static_cast<uint32_t>(source.indices.size());
+
+    const Lod fullDetail = { 0, indexCount, 0, static_cast<uint32_t>(source.meshlets.size()), 0.f, 0 };
+    const std::span<const Lod> lods = source.lods.empty() ? std::span<const Lod>(&fullDetail, 1) : source.lods;
+
+    if(lods.size() > MAX_LODS)
+        return false;
+
+    const uint32_t meshletCount = static_cast<uint32_t>(source.meshlets.size());
+
+    for (const auto& lod : lods)
+        if(lod.firstIndex > indexCount || lod.indexCount > indexCount - lod.firstIndex ||
+           lod.firstMeshlet > meshletCount || lod.meshletCount > meshletCount - lod.firstMeshlet)
+            return false;
+
+//  Cluster blob with offsets rebased onto its start
+    const uint64_t verticesStart  = static_cast<uint64_t>(meshletCount) * sizeof(MeshOptimizer::Meshlet);
+    const uint64_t trianglesStart = verticesStart + source.meshletVertices.size_bytes();
+    const uint64_t clusterSize    = meshletCount ? (trianglesStart + source.meshletTriangles.size() + 3) & ~uint64_t(3) : 0;
+
+    if(clusterSize > UINT32_MAX)
+        return false;
+
+    std::vector<std::byte> clusters(clusterSize, std::byte(0));
+
+    if(meshletCount)
+    {
+        for (uint32_t i = 0; i < meshletCount; ++i)
+        {
+            auto meshlet = source.meshlets[i];
+
+            if(meshlet.vertexOffset + static_cast<uint64_t>(meshlet.vertexCount) > source.meshletVertices.size() ||
+               meshlet.triangleOffset + static_cast<uint64_t>(meshlet.triangleCount) * 3 > source.meshletTriangles.size())
+                return false;
+
+            meshlet.vertexOffset   = static_cast<uint32_t>(verticesStart / sizeof(uint32_t)) + meshlet.vertexOffset;
+            meshlet.triangleOffset = static_cast<uint32_t>(trianglesStart) + meshlet.triangleOffset;
+
+            memcpy(clusters.data() + i * sizeof(MeshOptimizer::Meshlet), &meshlet, sizeof(MeshOptimizer::Meshlet));
+        }
+
+        memcpy(clusters.data() + verticesStart, source.meshletVertices.data(), source.meshletVertices.size_bytes());
+        memcpy(clusters.data() + trianglesStart, source.meshletTriangles.data(), source.meshletTriangles.size());
+    }
+
+    const bool     narrow      = (MeshOptimizer::getIndexType(vertexCount) == VK_INDEX_TYPE_UINT16);
+    const uint32_t indexSize   = narrow ? sizeof(uint16_t) : sizeof(uint32_t);
+
+    Header header = 
+    {
+        .magic          = MAGIC,
+        .version        = VERSION,
+        .attributeCount = static_cast<uint32_t>(source.attributes.size()),
+        .vertexStride   = vertexStride,
+        .vertexCount    = vertexCount,
+        .indexCount     = indexCount,
+        .indexSize      = indexSize,
+        .lodCount       = static_cast<uint32_t>(lods.size()),
+        .vertexOffset   = 0,
+        .indexOffset    = 0,
+        .boundsMin      = {  INFINITY,  INFINITY,  INFINITY },
+        .boundsMax      = { -INFINITY, -INFINITY, -INFINITY },
+        .sphere         = { 0.f, 0.f, 0.f, 0.f },
+        .meshletCount   = meshletCount,
+        .clusterSize    = static_cast<uint32_t>(clusterSize),
+        .clusterOffset  = 0
+    };
+
+    for (uint32_t v = 0; v < vertexCount; ++v)
+    {
+        const float* p = reinterpret_cast<const float*>(reinterpret_cast<const std::byte*>(source.positions) + source.positionStride * v);
+
+        for (uint32_t k = 0; k < 3; ++k)
+        {
+            header.boundsMin[k] = std::min(header.boundsMin[k], p[k]);
+            header.boundsMax[k] = std::max(header.boundsMax[k], p[k]);
+        }
+    }
+
+//  Centered on the box, the radius reaches the farthest vertex
+    for (uint32_t k = 0; k < 3; ++k)
+        header.sphere[k] = vertexCount ? (header.boundsMin[k] + header.boundsMax[k]) * 0.5f : 0.f;
+
+    for (uint32_t v = 0; v < vertexCount; ++v)
+    {
+        const float* p = reinterpret_cast<const float*>(reinterpret_cast<const std::byte*>(source.positions) + source.positionStride * v);
+        const float dx = p[0] - header.sphere[0], dy = p[1] - header.sphere[1], dz = p[2] - header.sphere[2];
+
+        header.sphere[3] = std::max(header.sphere[3], std::sqrt(dx * dx + dy * dy + dz * dz));
+    }
+
+    std::vector<uint32_t> attributes(source.attributes.size());
+
+    for (size_t i = 0; i < attributes.size(); ++i)
+        attributes[i] = static_cast<uint32_t>(source.attributes[i].type);
+
+    const std::vector<uint16_t> narrowIndices = narrow ? MeshOptimizer::narrowIndices(source.indices) : std::vector<uint16_t>();
+    const void* indexData = narrow ? static_cast<const void*>(narrowIndices.data()) : static_cast<const void*>(source.indices.data());
+
+    const uint64_t tablesEnd = sizeof(Header) + attributes.size() * sizeof(uint32_t) + lods.size() * sizeof(Lod);
+    header.vertexOffset = align_blob(tablesEnd);
+    header.indexOffset   = align_blob(header.vertexOffset + source.vertices.size());
+    header.clusterOffset = align_blob(header.indexOffset + static_cast<uint64_t>(header.indexCount) * indexSize);
+
+    FILE* file = fopen(path, "wb");
+
+    if(!file)
+        return false;
+
+    uint64_t written = tablesEnd;
+
+    const bool succeeded = fwrite(&header, sizeof(Header), 1, file) == 1 &&
+                           fwrite(attributes.data(), sizeof(uint32_t), attributes.size(), file) == attributes.size() &&
+                           fwrite(lods.data(), sizeof(Lod), lods.size(), file) == lods.size() &&
+                           write_padded(file, source.vertices.data(), source.vertices.size(), written) &&
+                           write_padded(file, indexData, static_cast<size_t>(header.indexCount) * indexSize, written) &&
+                           write_padded(file, clusters.data(), clusters.size(), written);
+
+    return (fclose(file) == 0) && succeeded;
+}
+
+
+MeshFile::MeshFile() noexcept:
+    m_header(nullptr)
+{
+
+}
+
+
+bool MeshFile::open(const char* path) noexcept
+{
+    close();
+
+    if(!m_file.open(path))
+        return false;
+
+    const auto data = m_file.getData();
+    const auto header = reinterpret_cast<const Header*>(data.data());
+
+    const bool valid = [&]()
+    {
+        if(data.size() < sizeof(Header) || header->magic != MAGIC || header->version != VERSION)
+            return false;
+
+        if(header->indexSize != sizeof(uint16_t) && header->indexSize != sizeof(uint32_t))
+            return false;
+
+        if(header->vertexOffset % BLOB_ALIGNMENT != 0 || header->indexOffset % BLOB_ALIGNMENT != 0 || header->clusterOffset % BLOB_ALIGNMENT != 0)
+            return false;
+
+        if(header->lodCount == 0 || header->lodCount > MAX_LODS)
+            return false;
+
+        const uint64_t tablesSize = static_cast<uint64_t>(header->attributeCount) * sizeof(uint32_t) + static_cast<uint64_t>(header->lodCount) * sizeof(Lod);
+
+        if(!fits(sizeof(Header), tablesSize, data.size()) ||
+           !fits(header->vertexOffset, static_cast<uint64_t>(header->vertexCount) * header->vertexStride, data.size()) ||
+           !fits(header->indexOffset, static_cast<uint64_t>(header->indexCount) * header->indexSize, data.size()) ||
+           !fits(header->clusterOffset, header->clusterSize, data.size()))
+            return false;
+
+    //  The GPU reads the meshlet records straight from the blob
+        if(static_cast<uint64_t>(header->meshletCount) * sizeof(MeshOptimizer::Meshlet) > header->clusterSize || header->clusterSize % sizeof(uint32_t) != 0)
+            return false;
+
+    //  The layout has to describe the stride exactly, the vertex data is used as is
+        const auto attributes = reinterpret_cast<const uint32_t*>(data.data() + sizeof(Header));
+        uint32_t stride = 0;
+
+        for (uint32_t i = 0; i < header->attributeCount; ++i)
+        {
+            if(attributes[i] > VertexInputState::Attribute::A2B10G10R10Snorm)
+                return false;
+
+            stride += static_cast<uint32_t>(VertexInputState::Attribute(static_cast<VertexInputState::Attribute::Type>(attributes[i])).sizeInBytes);
+        }
+
+        if(stride != header->vertexStride)
+            return false;
+
+        if(!indices_in_range(data.data() + header->indexOffset, header->indexCount, header->indexSize, header->vertexCount))
+            return false;
+
+        const auto clusters = data.data() + header->clusterOffset;
+        const auto meshlets = reinterpret_cast<const MeshOptimizer::Meshlet*>(clusters);
+
+        for (uint32_t i = 0; i < header->meshletCount; ++i)
+        {
+            const auto& meshlet = meshlets[i];
+
+            if(meshlet.vertexCount > MeshOptimizer::MAX_MESHLET_VERTICES || meshlet.triangleCount > MeshOptimizer::MAX_MESHLET_TRIANGLES ||
+               !fits(static_cast<uint64_t>(meshlet.vertexOffset) * sizeof(uint32_t), static_cast<uint64_t>(meshlet.vertexCount) * sizeof(uint32_t), header->clusterSize) ||
+               !fits(meshlet.triangleOffset, static_cast<uint64_t>(meshlet.triangleCount) * 3, header->clusterSize))
+                return false;
+
+        //  Meshlet vertices index the mesh, triangles index the meshlet's vertices
+            if(!indices_in_range(clusters + static_cast<size_t>(meshlet.vertexOffset) * sizeof(uint32_t), meshlet.vertexCount, sizeof(uint32_t), header->vertexCount) ||
+               !indices_in_range(clusters + meshlet.triangleOffset, meshlet.triangleCount * 3, sizeof(uint8_t), meshlet.vertexCount))
+                return false;
+        }
+
+        const auto lods = reinterpret_cast<const Lod*>(attributes + header->attributeCount);
+
+        for (uint32_t i = 0; i < header->lodCount; ++i)
+            if(lods[i].firstIndex > header->indexCount || lods[i].indexCount > header->indexCount - lods[i].firstIndex ||
+               lods[i].firstMeshlet > header->meshletCount || lods[i].meshletCount > header->meshletCount - lods[i].firstMeshlet || !(lods[i].error >= 0.f))
+                return false;
+
+        return true;
+    }();
+
+    if(!valid)
+    {
+        m_file.close();
+        return false;
+    }
+
+    m_header = header;
+
+    return true;
+}
+
+
+void MeshFile::close() noexcept
+{
+    m_file.close();
+    m_header = nullptr;
+}
+
+
+const MeshFile::Header& MeshFile::getHeader() const noexcept
+{
+    return *m_header;
+}
+
+
+std::span<const uint32_t> MeshFile::getAttributes() const noexcept
+{
+    return { reinterpret_cast<const uint32_t*>(m_file.getData().data() + sizeof(Header)), m_header->attributeCount };
+}
+
+
+std::span<const MeshFile::Lod> MeshFile::getLods() const noexcept
+{
+    return { reinterpret_cast<const Lod*>(m_file.getData().data() + sizeof(Header) + m_header->attributeCount * sizeof(uint32_t)), m_header->lodCount };
+}
+
+
+std::span<const std::byte> MeshFile::getVertices() const noexcept
+{
+    return m_file.getData().subspan(m_header->vertexOffset, static_cast<size_t>(m_header->vertexCount) * m_header->vertexStride);
+}
+
+
+std::span<const std::byte> MeshFile::getIndices() const noexcept
+{
+    return m_file.getData().subspan(m_header->indexOffset, static_cast<size_t>(m_header->indexCount) * m_header->indexSize);
+}
+
+
+std::span<const std::byte> MeshFile::getClusters() const noexcept
+{
+    return m_file.getData().subspan(m_header->clusterOffset, m_header->clusterSize);
+}
+
+
+VkIndexType MeshFile::getIndexType() const noexcept
+{
+    return (m_header->indexSize == sizeof(uint16_t)) ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+}
\ No newline at end of file
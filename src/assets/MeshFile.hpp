@@ -0,0 +1,103 @@
+#ifndef MESH_FILE_HPP
+#define MESH_FILE_HPP
+
+#include <span>
+#include <cstdint>
+#include <cstddef>
+
+#include "core/MappedFile.hpp"
+#include "assets/MeshOptimizer.hpp"
+#include "vulkan_api/pipeline/stages/vertex/VertexInputState.hpp"
+
+
+// Binary mesh asset (.smesh), written at bake time and loaded without any parsing:
+// the file is mapped and the blobs go from the mapping straight into staging memory.
+//
+//   Header
+//   uint32_t attributes[attributeCount]  VertexInputState::Attribute::Type of one tightly packed binding
+//   Lod      lods[lodCount]              index ranges from full detail down, all levels share the vertices
+//   vertices                             vertexCount * vertexStride bytes at vertexOffset
+//   indices                              indexCount * indexSize bytes at indexOffset, every level back to back
+//   clusters                             clusterSize bytes at clusterOffset, the meshlets of every level:
+//       MeshOptimizer::Meshlet meshlets[meshletCount]   vertexOffset in 32-bit words and triangleOffset in bytes, both from the start of the blob
+//       uint32_t               vertices[]               mesh vertex indices
+//       uint8_t                triangles[]              local indices, zero padded to a multiple of 4 bytes
+//
+// The cluster blob goes to the GPU unchanged (see GeometryPool). Blobs start on BLOB_ALIGNMENT boundaries, all values are little endian.
+// A new VERSION is needed for any layout change, old files are rejected rather than misread.
+class MeshFile
+{
+public:
+    static constexpr uint32_t MAGIC          = 0x48534D53; // "SMSH"
+    static constexpr uint32_t VERSION        = 3;
+    static constexpr uint32_t BLOB_ALIGNMENT = 16;
+    static constexpr uint32_t MAX_LODS       = 8;
+
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t attributeCount;
+        uint32_t vertexStride;
+        uint32_t vertexCount;
+        uint32_t indexCount;
+        uint32_t indexSize;    // 2 or 4
+        uint32_t lodCount;     // 1 to MAX_LODS
+        uint64_t vertexOffset; // from the start of the file
+        uint64_t indexOffset;
+        float    boundsMin[3];
+        float    boundsMax[3];
+        float    sphere[4];    // center and radius
+        uint32_t meshletCount;
+        uint32_t clusterSize;   // bytes
+        uint64_t clusterOffset;
+    };
+
+    static_assert(sizeof(Header) == 104);
+
+    struct Lod
+    {
+        uint32_t firstIndex;
+        uint32_t indexCount;
+        uint32_t firstMeshlet; // the same triangles as meshlets
+        uint32_t meshletCount;
+        float    error;        // largest deviation from the full detail surface, in position units
+        uint32_t reserved;
+    };
+
+    static_assert(sizeof(Lod) == 24);
+
+    struct Source
+    {
+        std::span<const VertexInputState::Attribute> attributes;
+        std::span<const std::byte>                   vertices;       // packed as described by attributes
+        std::span<const uint32_t>                    indices;        // stored as 16-bit when the vertex count allows
+        std::span<const Lod>                         lods;           // empty for a single level covering every index
+        std::span<const MeshOptimizer::Meshlet>      meshlets;       // optional, offsets into the two arrays below
+        std::span<const uint32_t>                    meshletVertices;
+        std::span<const uint8_t>                     meshletTriangles;
+        const float*                                 positions;      // float3 positions for the bounds
+        size_t                                       positionStride; // bytes
+    };
+
+    static bool write(const char* path, const Source& source) noexcept;
+
+    MeshFile() noexcept;
+
+    bool open(const char* path) noexcept; // false for missing, truncated or incompatible files and for indices past the vertices
+    void close() noexcept;
+
+    const Header&              getHeader()     const noexcept;
+    std::span<const uint32_t>  getAttributes() const noexcept;
+    std::span<const Lod>       getLods()       const noexcept;
+    std::span<const std::byte> getVertices()   const noexcept;
+    std::span<const std::byte> getIndices()    const noexcept;
+    std::span<const std::byte> getClusters()   const noexcept;
+    VkIndexType                getIndexType()  const noexcept;
+
+private:
+    MappedFile    m_file;
+    const Header* m_header;
+};
+
+#endif // !MESH_FILE_HPP
\ No newline at end of file
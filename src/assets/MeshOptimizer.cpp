@@ -0,0 +1,965 @@
+#include <cmath>
+#include <array>
+#include <tuple>
+#include <cstring>
+#include <numeric>
+#include <algorithm>
+
+#include "assets/MeshOptimizer.hpp"
+
+
+namespace
+{
+    constexpr uint32_t CACHE_SIZE      = 32; // LRU model of the cache optimizer
+    constexpr uint32_t FIFO_CACHE_SIZE = 16; // FIFO model used to find cluster boundaries
+
+    constexpr float LAST_TRIANGLE_SCORE = 0.75f;
+    constexpr float CACHE_DECAY_POWER   = 1.5f;
+    constexpr float VALENCE_BOOST_SCALE = 2.f;
+
+    float vertex_score(int32_t cachePosition, uint32_t remainingTriangles) noexcept
+    {
+        if (remainingTriangles == 0)
+            return -1.f;
+
+        float score = 0.f;
+
+    //  The vertices of the last triangle get a fixed score, so the next triangle does not simply reuse two of them
+        if (cachePosition >= 0)
+        {
+            score = (cachePosition < 3) ? LAST_TRIANGLE_SCORE :
+                std::pow(1.f - static_cast<float>(cachePosition - 3) / (CACHE_SIZE - 3), CACHE_DECAY_POWER);
+        }
+
+    //  Vertices with few triangles left are finished first, so they can leave the cache for good
+        return score + VALENCE_BOOST_SCALE / std::sqrt(static_cast<float>(remainingTriangles));
+    }
+
+
+    struct Float3
+    {
+        float x, y, z;
+    };
+
+    Float3 load_position(const float* positions, size_t stride, uint32_t index) noexcept
+    {
+        const float* p = reinterpret_cast<const float*>(reinterpret_cast<const std::byte*>(positions) + stride * index);
+        return { p[0], p[1], p[2] };
+    }
+
+
+    Float3 subtract(const Float3& a, const Float3& b) noexcept
+    {
+        return { a.x - b.x, a.y - b.y, a.z - b.z };
+    }
+
+
+    Float3 cross(const Float3& a, const Float3& b) noexcept
+    {
+        return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+    }
+
+
+    float dot(const Float3& a, const Float3& b) noexcept
+    {
+        return a.x * b.x + a.y * b.y + a.z * b.z;
+    }
+
+
+    constexpr float BORDER_WEIGHT  = 10.f;  // open borders resist moving inwards, relative to the surface planes
+    constexpr float FLIP_THRESHOLD = 0.25f; // a collapse may turn a neighbouring triangle by at most ~75 degrees
+
+    enum class VertexKind : uint8_t
+    {
+        Manifold, // collapses onto any neighbour
+        Border,   // on an open border, collapses along it
+        Seam,     // on a UV seam with one wedge per side, collapses along the seam
+        Locked    // seam and border corners, non-manifold points
+    };
+
+
+//  Weighted sum of squared distances to planes, x'Ax + 2b'x + c with A symmetric
+    struct Quadric
+    {
+        double a00, a11, a22, a01, a02, a12;
+        double b0, b1, b2;
+        double c;
+        double weight;
+    };
+
+
+//  Plane n'x + d = 0 with unit n
+    void add_plane(Quadric& q, const Float3& n, float d, float weight) noexcept
+    {
+        q.a00 += weight * n.x * n.x;
+        q.a11 += weight * n.y * n.y;
+        q.a22 += weight * n.z * n.z;
+        q.a01 += weight * n.x * n.y;
+        q.a02 += weight * n.x * n.z;
+        q.a12 += weight * n.y * n.z;
+        q.b0  += weight * n.x * d;
+        q.b1  += weight * n.y * d;
+        q.b2  += weight * n.z * d;
+        q.c   += weight * d * d;
+        q.weight += weight;
+    }
+
+
+    void add_quadric(Quadric& q, const Quadric& other) noexcept
+    {
+        q.a00 += other.a00;
+        q.a11 += other.a11;
+        q.a22 += other.a22;
+        q.a01 += other.a01;
+        q.a02 += other.a02;
+        q.a12 += other.a12;
+        q.b0  += other.b0;
+        q.b1  += other.b1;
+        q.b2  += other.b2;
+        q.c   += other.c;
+        q.weight += other.weight;
+    }
+
+
+//  Root of the weighted mean squared distance, in position units
+    float quadric_error(const Quadric& q, const Float3& v) noexcept
+    {
+        if (q.weight <= 0.0)
+            return 0.f;
+
+        const double x = v.x, y = v.y, z = v.z;
+        const double value = q.a00 * x * x + q.a11 * y * y + q.a22 * z * z +
+                             2.0 * (q.a01 * x * y + q.a02 * x * z + q.a12 * y * z) +
+                             2.0 * (q.b0 * x + q.b1 * y + q.b2 * z) + q.c;
+
+        return static_cast<float>(std::sqrt(std::max(value / q.weight, 0.0)));
+    }
+}
+
+
+void MeshOptimizer::optimizeVertexCache(std::span<uint32_t> indices, uint32_t vertexCount) noexcept
+{
+    const uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+
+    if (triangleCount == 0)
+        return;
+
+//  Triangles of every vertex, the unemitted ones are kept in front
+    std::vector<uint32_t> offsets(vertexCount + 1, 0);
+    std::vector<uint32_t> remaining(vertexCount, 0);
+
+    for (uint32_t i = 0; i < triangleCount * 3; ++i)
+        ++remaining[indices[i]];
+
+    for (uint32_t v = 0; v < vertexCount; ++v)
+        offsets[v + 1] = offsets[v] + remaining[v];
+
+    std::vector<uint32_t> adjacency(triangleCount * 3);
+    std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+
+    for (uint32_t i = 0; i < triangleCount * 3; ++i)
+        adjacency[fill[indices[i]]++] = i / 3;
+
+    std::vector<int32_t> cachePosition(vertexCount, -1);
+    std::vector<float>   vertexScores(vertexCount);
+
+    for (uint32_t v = 0; v < vertexCount; ++v)
+        vertexScores[v] = vertex_score(-1, remaining[v]);
+
+    std::vector<float>   triangleScores(triangleCount);
+    std::vector<uint8_t> emitted(triangleCount, 0);
+
+    uint32_t best = 0;
+
+    for (uint32_t t = 0; t < triangleCount; ++t)
+    {
+        triangleScores[t] = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+
+        if (triangleScores[t] > triangleScores[best])
+            best = t;
+    }
+
+    std::vector<uint32_t> result;
+    result.reserve(triangleCount * 3);
+
+    std::array<uint32_t, CACHE_SIZE + 3> cache;
+    std::array<uint32_t, CACHE_SIZE + 3> newCache;
+    uint32_t cacheSize = 0;
+    uint32_t cursor    = 0;
+
+    while (result.size() < triangleCount * 3)
+    {
+    //  Nothing in the cache has triangles left: continue with the next unemitted triangle in input order
+        if (best == UINT32_MAX)
+        {
+            while (emitted[cursor])
+                ++cursor;
+
+            best = cursor;
+        }
+
+        const uint32_t* triangle = &indices[best * 3];
+        result.insert(result.end(), triangle, triangle + 3);
+        emitted[best] = 1;
+
+        uint32_t newSize = 0;
+
+        for (uint32_t k = 0; k < 3; ++k)
+        {
+            const uint32_t v = triangle[k];
+
+            uint32_t* first = &adjacency[offsets[v]];
+            uint32_t* last  = first + remaining[v];
+            std::iter_swap(std::find(first, last, best), last - 1);
+            --remaining[v];
+
+            if (std::find(newCache.begin(), newCache.begin() + newSize, v) == newCache.begin() + newSize)
+                newCache[newSize++] = v;
+        }
+
+        for (uint32_t i = 0; i < cacheSize; ++i)
+        {
+            const uint32_t v = cache[i];
+
+            if (v != triangle[0] && v != triangle[1] && v != triangle[2])
+                newCache[newSize++] = v;
+        }
+
+    //  Vertices pushed past the cache size are evicted but still need their score updated
+        for (uint32_t i = 0; i < newSize; ++i)
+        {
+            const uint32_t v = newCache[i];
+
+            cachePosition[v] = (i < CACHE_SIZE) ? static_cast<int32_t>(i) : -1;
+            vertexScores[v]  = vertex_score(cachePosition[v], remaining[v]);
+        }
+
+        best = UINT32_MAX;
+        float bestScore = -1.f;
+
+        for (uint32_t i = 0; i < newSize; ++i)
+        {
+            const uint32_t v = newCache[i];
+
+            for (uint32_t j = offsets[v]; j < offsets[v] + remaining[v]; ++j)
+            {
+                const uint32_t t = adjacency[j];
+                triangleScores[t] = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+
+                if (triangleScores[t] > bestScore)
+                {
+                    bestScore = triangleScores[t];
+                    best      = t;
+                }
+            }
+        }
+
+        cacheSize = std::min(newSize, CACHE_SIZE);
+        std::copy(newCache.begin(), newCache.begin() + cacheSize, cache.begin());
+    }
+
+    std::copy(result.begin(), result.end(), indices.begin());
+}
+
+
+void MeshOptimizer::optimizeOverdraw(std::span<uint32_t> indices, const float* positions, size_t positionStride, uint32_t vertexCount) noexcept
+{
+    const uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+
+    if (triangleCount == 0)
+        return;
+
+//  A cluster starts wherever a triangle misses the cache with all three vertices,
+//  reordering whole clusters then costs next to nothing in vertex cache efficiency
+    std::vector<uint32_t> clusterStarts;
+    std::vector<uint32_t> timestamps(vertexCount, 0);
+    uint32_t time = FIFO_CACHE_SIZE + 1;
+
+    for (uint32_t t = 0; t < triangleCount; ++t)
+    {
+        uint32_t misses = 0;
+
+        for (uint32_t k = 0; k < 3; ++k)
+        {
+            const uint32_t v = indices[t * 3 + k];
+
+            if (time - timestamps[v] > FIFO_CACHE_SIZE)
+            {
+                timestamps[v] = time++;
+                ++misses;
+            }
+        }
+
+        if (t == 0 || misses == 3)
+            clusterStarts.push_back(t);
+    }
+
+    clusterStarts.push_back(triangleCount);
+
+    const uint32_t clusterCount = static_cast<uint32_t>(clusterStarts.size() - 1);
+
+//  Area weighted centroid and normal of every cluster and the centroid of the whole mesh
+    std::vector<Float3> centroids(clusterCount);
+    std::vector<Float3> normals(clusterCount);
+    Float3 meshCentroid = { 0.f, 0.f, 0.f };
+    float  meshArea     = 0.f;
+
+    for (uint32_t c = 0; c < clusterCount; ++c)
+    {
+        Float3 centroid = { 0.f, 0.f, 0.f };
+        Float3 normal   = { 0.f, 0.f, 0.f };
+        float  area     = 0.f;
+
+        for (uint32_t t = clusterStarts[c]; t < clusterStarts[c + 1]; ++t)
+        {
+            const Float3 a = load_position(positions, positionStride, indices[t * 3]);
+            const Float3 b = load_position(positions, positionStride, indices[t * 3 + 1]);
+            const Float3 p = load_position(positions, positionStride, indices[t * 3 + 2]);
+
+            const Float3 ab = { b.x - a.x, b.y - a.y, b.z - a.z };
+            const Float3 ap = { p.x - a.x, p.y - a.y, p.z - a.z };
+            const Float3 n  = { ab.y * ap.z - ab.z * ap.y, ab.z * ap.x - ab.x * ap.z, ab.x * ap.y - ab.y * ap.x };
+
+            const float triangleArea = std::sqrt(n.x * n.x + n.y * n.y + n.z * n.z);
+
+            centroid.x += (a.x + b.x + p.x) * triangleArea;
+            centroid.y += (a.y + b.y + p.y) * triangleArea;
+            centroid.z += (a.z + b.z + p.z) * triangleArea;
+
+            normal.x += n.x;
+            normal.y += n.y;
+            normal.z += n.z;
+
+            area += triangleArea;
+        }
+
+        meshCentroid.x += centroid.x;
+        meshCentroid.y += centroid.y;
+        meshCentroid.z += centroid.z;
+        meshArea       += area;
+
+        const float scale = (area > 0.f) ? 1.f / (area * 3.f) : 0.f;
+        centroids[c] = { centroid.x * scale, centroid.y * scale, centroid.z * scale };
+
+        const float length = std::sqrt(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z);
+        normals[c] = (length > 0.f) ? Float3{ normal.x / length, normal.y / length, normal.z / length } : Float3{ 0.f, 0.f, 0.f };
+    }
+
+    const float meshScale = (meshArea > 0.f) ? 1.f / (meshArea * 3.f) : 0.f;
+    meshCentroid = { meshCentroid.x * meshScale, meshCentroid.y * meshScale, meshCentroid.z * meshScale };
+
+//  Clusters facing away from the center occlude the rest of the mesh more often than they are occluded
+    std::vector<float> sortKeys(clusterCount);
+
+    for (uint32_t c = 0; c < clusterCount; ++c)
+    {
+        sortKeys[c] = (centroids[c].x - meshCentroid.x) * normals[c].x +
+                      (centroids[c].y - meshCentroid.y) * normals[c].y +
+                      (centroids[c].z - meshCentroid.z) * normals[c].z;
+    }
+
+    std::vector<uint32_t> order(clusterCount);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return sortKeys[a] > sortKeys[b]; });
+
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+
+    for (const uint32_t c : order)
+        result.insert(result.end(), indices.begin() + clusterStarts[c] * 3, indices.begin() + clusterStarts[c + 1] * 3);
+
+    std::copy(result.begin(), result.end(), indices.begin());
+}
+
+
+// Collapses run in passes over the current mesh, cheapest first. A collapse locks the points of the triangles around it
+// for the rest of the pass, so every flip test and wedge lookup in a pass sees up-to-date triangles.
+std::vector<uint32_t> MeshOptimizer::simplify(std::span<const uint32_t> indices, const float* positions, size_t positionStride, uint32_t vertexCount,
+                                              size_t targetIndexCount, float targetError, float& resultError) noexcept
+{
+    std::vector<uint32_t> result(indices.begin(), indices.begin() + indices.size() / 3 * 3);
+    resultError = 0.f;
+
+    if (result.size() <= targetIndexCount)
+        return result;
+
+//  Vertices sharing a position are wedges of one point, collapses move points
+    std::vector<uint32_t> order(vertexCount);
+    std::iota(order.begin(), order.end(), 0);
+
+    const auto less = [&](uint32_t a, uint32_t b)
+    {
+        const Float3 pa = load_position(positions, positionStride, a);
+        const Float3 pb = load_position(positions, positionStride, b);
+
+        return std::tie(pa.x, pa.y, pa.z) < std::tie(pb.x, pb.y, pb.z);
+    };
+
+    std::sort(order.begin(), order.end(), less);
+
+    std::vector<uint32_t> pointOf(vertexCount);
+    std::vector<Float3>   points;
+
+    for (uint32_t i = 0; i < vertexCount; ++i)
+    {
+        if (i == 0 || less(order[i - 1], order[i]))
+            points.push_back(load_position(positions, positionStride, order[i]));
+
+        pointOf[order[i]] = static_cast<uint32_t>(points.size() - 1);
+    }
+
+    const uint32_t pointCount = static_cast<uint32_t>(points.size());
+
+    const auto isDegenerate = [&](const uint32_t* triangle)
+    {
+        const uint32_t a = pointOf[triangle[0]], b = pointOf[triangle[1]], c = pointOf[triangle[2]];
+        return a == b || b == c || c == a;
+    };
+
+    {
+        size_t write = 0;
+
+        for (size_t i = 0; i < result.size(); i += 3)
+            if (!isDegenerate(&result[i]))
+                for (uint32_t k = 0; k < 3; ++k)
+                    result[write++] = result[i + k];
+
+        result.resize(write);
+    }
+
+//  Triangles around every point
+    std::vector<uint32_t> offsets(pointCount + 1);
+    std::vector<uint32_t> adjacency;
+
+    const auto buildAdjacency = [&]()
+    {
+        std::fill(offsets.begin(), offsets.end(), 0);
+
+        for (const uint32_t v : result)
+            ++offsets[pointOf[v] + 1];
+
+        for (uint32_t p = 0; p < pointCount; ++p)
+            offsets[p + 1] += offsets[p];
+
+        adjacency.resize(result.size());
+        std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+
+        for (uint32_t i = 0; i < result.size(); ++i)
+            adjacency[fill[pointOf[result[i]]]++] = i / 3;
+    };
+
+//  Number of triangles on the edge pq, seam is set when they do not agree on the wedges
+    const auto edgeTriangles = [&](uint32_t p, uint32_t q, bool& seam)
+    {
+        uint32_t count  = 0;
+        uint32_t wedgeP = UINT32_MAX;
+        uint32_t wedgeQ = UINT32_MAX;
+
+        seam = false;
+
+        for (uint32_t j = offsets[p]; j < offsets[p + 1]; ++j)
+        {
+            const uint32_t* triangle = &result[adjacency[j] * 3];
+            uint32_t vp = UINT32_MAX;
+            uint32_t vq = UINT32_MAX;
+
+            for (uint32_t k = 0; k < 3; ++k)
+            {
+                if (pointOf[triangle[k]] == p)
+                    vp = triangle[k];
+                else if (pointOf[triangle[k]] == q)
+                    vq = triangle[k];
+            }
+
+            if (vq == UINT32_MAX)
+                continue;
+
+            if (count++ == 0)
+            {
+                wedgeP = vp;
+                wedgeQ = vq;
+            }
+            else if (vp != wedgeP || vq != wedgeQ)
+                seam = true;
+        }
+
+        return count;
+    };
+
+    buildAdjacency();
+
+//  Kinds come from the input topology and stay fixed, collapses along borders and seams keep them valid
+    std::vector<VertexKind> kinds(pointCount, VertexKind::Locked);
+
+    for (uint32_t p = 0; p < pointCount; ++p)
+    {
+        std::array<uint32_t, 2> wedges;
+        uint32_t wedgeCount = 0;
+        uint32_t borders    = 0; // open edges, seen once each
+        uint32_t seamVisits = 0; // seam edges, seen from both of their triangles
+        bool     complex    = false;
+
+        for (uint32_t j = offsets[p]; j < offsets[p + 1]; ++j)
+        {
+            const uint32_t* triangle = &result[adjacency[j] * 3];
+
+            for (uint32_t k = 0; k < 3; ++k)
+            {
+                const uint32_t v     = triangle[k];
+                const uint32_t point = pointOf[v];
+
+                if (point == p)
+                {
+                    if (std::find(wedges.begin(), wedges.begin() + std::min(wedgeCount, 2U), v) == wedges.begin() + std::min(wedgeCount, 2U))
+                    {
+                        if (wedgeCount < 2)
+                            wedges[wedgeCount] = v;
+
+                        ++wedgeCount;
+                    }
+
+                    continue;
+                }
+
+                bool seam;
+                const uint32_t count = edgeTriangles(p, point, seam);
+
+                if (count == 1)
+                    ++borders;
+                else if (count == 2 && seam)
+                    ++seamVisits;
+                else if (count > 2)
+                    complex = true;
+            }
+        }
+
+        if (complex)
+            continue;
+
+        if (wedgeCount == 1 && borders == 0)
+            kinds[p] = VertexKind::Manifold;
+        else if (wedgeCount == 1 && borders == 2)
+            kinds[p] = VertexKind::Border;
+        else if (wedgeCount == 2 && borders == 0 && seamVisits == 4)
+            kinds[p] = VertexKind::Seam;
+    }
+
+//  Area weighted triangle planes, plus planes through open edges standing on the surface
+    std::vector<Quadric> quadrics(pointCount, Quadric{});
+
+    for (size_t i = 0; i < result.size(); i += 3)
+    {
+        const std::array<uint32_t, 3> corners = { pointOf[result[i]], pointOf[result[i + 1]], pointOf[result[i + 2]] };
+
+        const Float3 a = points[corners[0]];
+        Float3 normal = cross(subtract(points[corners[1]], a), subtract(points[corners[2]], a));
+        const float length = std::sqrt(dot(normal, normal));
+
+        if (length == 0.f)
+            continue;
+
+        normal = { normal.x / length, normal.y / length, normal.z / length };
+
+        for (const uint32_t corner : corners)
+            add_plane(quadrics[corner], normal, -dot(normal, a), length * 0.5f);
+
+        for (uint32_t k = 0; k < 3; ++k)
+        {
+            const uint32_t p = corners[k];
+            const uint32_t q = corners[(k + 1) % 3];
+
+            if (bool seam; edgeTriangles(p, q, seam) != 1)
+                continue;
+
+            const Float3 edge       = subtract(points[q], points[p]);
+            const Float3 sideNormal = cross(edge, normal);
+            const float  edgeLength = std::sqrt(dot(sideNormal, sideNormal));
+
+            if (edgeLength == 0.f)
+                continue;
+
+            const Float3 side = { sideNormal.x / edgeLength, sideNormal.y / edgeLength, sideNormal.z / edgeLength };
+
+            add_plane(quadrics[p], side, -dot(side, points[p]), edgeLength * edgeLength * BORDER_WEIGHT);
+            add_plane(quadrics[q], side, -dot(side, points[p]), edgeLength * edgeLength * BORDER_WEIGHT);
+        }
+    }
+
+    const auto canCollapse = [&](uint32_t p, uint32_t q)
+    {
+        bool seam;
+
+        switch (kinds[p])
+        {
+            case VertexKind::Manifold: return true;
+            case VertexKind::Border:   return (kinds[q] == VertexKind::Border || kinds[q] == VertexKind::Locked) && edgeTriangles(p, q, seam) == 1;
+            case VertexKind::Seam:     return (kinds[q] == VertexKind::Seam || kinds[q] == VertexKind::Locked) && edgeTriangles(p, q, seam) == 2 && seam;
+            case VertexKind::Locked:   return false;
+        }
+
+        return false;
+    };
+
+//  Moving p onto q must not fold any remaining triangle around p over
+    const auto flips = [&](uint32_t p, uint32_t q)
+    {
+        for (uint32_t j = offsets[p]; j < offsets[p + 1]; ++j)
+        {
+            const uint32_t* triangle = &result[adjacency[j] * 3];
+            std::array<Float3, 3> corners;
+            uint32_t moved = 3;
+            bool     removed = false;
+
+            for (uint32_t k = 0; k < 3; ++k)
+            {
+                const uint32_t point = pointOf[triangle[k]];
+
+                removed |= (point == q);
+                moved    = (point == p) ? k : moved;
+                corners[k] = points[point];
+            }
+
+            if (removed)
+                continue;
+
+            const Float3 before = cross(subtract(corners[1], corners[0]), subtract(corners[2], corners[0]));
+            corners[moved] = points[q];
+            const Float3 after  = cross(subtract(corners[1], corners[0]), subtract(corners[2], corners[0]));
+
+            if (dot(before, after) < FLIP_THRESHOLD * std::sqrt(dot(before, before) * dot(after, after)))
+                return true;
+        }
+
+        return false;
+    };
+
+    struct Collapse
+    {
+        uint32_t from;
+        uint32_t to;
+        float    error;
+    };
+
+    std::vector<Collapse> collapses;
+    std::vector<uint32_t> remap(vertexCount);
+    std::vector<uint8_t>  locked(pointCount);
+
+    while (result.size() > targetIndexCount)
+    {
+        collapses.clear();
+
+        for (size_t i = 0; i < result.size(); i += 3)
+        {
+            for (uint32_t k = 0; k < 3; ++k)
+            {
+                const uint32_t a = pointOf[result[i + k]];
+                const uint32_t b = pointOf[result[i + (k + 1) % 3]];
+
+                if (canCollapse(a, b))
+                    collapses.push_back({ a, b, quadric_error(quadrics[a], points[b]) });
+
+                if (canCollapse(b, a))
+                    collapses.push_back({ b, a, quadric_error(quadrics[b], points[a]) });
+            }
+        }
+
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.error < b.error; });
+
+        std::iota(remap.begin(), remap.end(), 0);
+        std::fill(locked.begin(), locked.end(), 0);
+
+        const size_t budget  = (result.size() - targetIndexCount) / 3;
+        size_t       removed = 0;
+        bool         applied = false;
+
+        for (const auto& collapse : collapses)
+        {
+            if (collapse.error > targetError || removed >= budget)
+                break;
+
+            const uint32_t p = collapse.from;
+            const uint32_t q = collapse.to;
+
+            if (locked[p] || locked[q] || flips(p, q))
+                continue;
+
+        //  Each wedge of p follows a triangle on the edge to the wedge of q on the same side
+            std::array<std::pair<uint32_t, uint32_t>, 2> wedges;
+            uint32_t wedgeCount = 0;
+            uint32_t shared     = 0;
+
+            for (uint32_t j = offsets[p]; j < offsets[p + 1]; ++j)
+            {
+                const uint32_t* triangle = &result[adjacency[j] * 3];
+                uint32_t vp = UINT32_MAX;
+                uint32_t vq = UINT32_MAX;
+
+                for (uint32_t k = 0; k < 3; ++k)
+                {
+                    if (pointOf[triangle[k]] == p)
+                        vp = triangle[k];
+                    else if (pointOf[triangle[k]] == q)
+                        vq = triangle[k];
+                }
+
+                if (vq == UINT32_MAX)
+                    continue;
+
+                ++shared;
+
+                const auto last = wedges.begin() + wedgeCount;
+
+                if (std::find_if(wedges.begin(), last, [vp](const auto& wedge) { return wedge.first == vp; }) == last && wedgeCount < 2)
+                    wedges[wedgeCount++] = { vp, vq };
+            }
+
+            if (wedgeCount != (kinds[p] == VertexKind::Seam ? 2U : 1U))
+                continue;
+
+            for (uint32_t w = 0; w < wedgeCount; ++w)
+                remap[wedges[w].first] = wedges[w].second;
+
+            add_quadric(quadrics[q], quadrics[p]);
+            resultError = std::max(resultError, collapse.error);
+
+            for (uint32_t j = offsets[p]; j < offsets[p + 1]; ++j)
+                for (uint32_t k = 0; k < 3; ++k)
+                    locked[pointOf[result[adjacency[j] * 3 + k]]] = 1;
+
+            removed += shared;
+            applied  = true;
+        }
+
+        if (!applied)
+            break;
+
+        size_t write = 0;
+
+        for (size_t i = 0; i < result.size(); i += 3)
+        {
+            const std::array<uint32_t, 3> triangle = { remap[result[i]], remap[result[i + 1]], remap[result[i + 2]] };
+
+            if (!isDegenerate(triangle.data()))
+                for (const uint32_t v : triangle)
+                    result[write++] = v;
+        }
+
+        result.resize(write);
+        buildAdjacency();
+    }
+
+    return result;
+}
+
+
+uint32_t MeshOptimizer::buildMeshlets(std::span<const uint32_t> indices, const float* positions, size_t positionStride, uint32_t vertexCount,
+                                      std::vector<Meshlet>& meshlets, std::vector<uint32_t>& meshletVertices, std::vector<uint8_t>& meshletTriangles) noexcept
+{
+    const uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+    const size_t   firstMeshlet  = meshlets.size();
+
+    std::vector<uint32_t> offsets(vertexCount + 1, 0);
+
+    for (uint32_t i = 0; i < triangleCount * 3; ++i)
+        ++offsets[indices[i] + 1];
+
+    for (uint32_t v = 0; v < vertexCount; ++v)
+        offsets[v + 1] += offsets[v];
+
+    std::vector<uint32_t> adjacency(triangleCount * 3);
+    std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+
+    for (uint32_t i = 0; i < triangleCount * 3; ++i)
+        adjacency[fill[indices[i]]++] = i / 3;
+
+    std::vector<uint8_t> emitted(triangleCount, 0);
+    std::vector<uint8_t> localIndex(vertexCount, 0xFF); // position in the current meshlet, 0xFF when not in it
+    uint32_t cursor = 0;
+
+    const auto newVertices = [&](uint32_t t)
+    {
+        return (localIndex[indices[t * 3]] == 0xFF ? 1U : 0U) + 
+               (localIndex[indices[t * 3 + 1]] == 0xFF ? 1U : 0U) + 
+               (localIndex[indices[t * 3 + 2]] == 0xFF ? 1U : 0U);
+    };
+
+    while (true)
+    {
+        while (cursor < triangleCount && emitted[cursor])
+            ++cursor;
+
+        if (cursor == triangleCount)
+            break;
+
+        Meshlet meshlet = {};
+        meshlet.vertexOffset   = static_cast<uint32_t>(meshletVertices.size());
+        meshlet.triangleOffset = static_cast<uint32_t>(meshletTriangles.size());
+
+        uint32_t next = cursor;
+
+        while (next != UINT32_MAX)
+        {
+            for (uint32_t k = 0; k < 3; ++k)
+            {
+                const uint32_t v = indices[next * 3 + k];
+
+                if (localIndex[v] == 0xFF)
+                {
+                    localIndex[v] = static_cast<uint8_t>(meshlet.vertexCount++);
+                    meshletVertices.push_back(v);
+                }
+
+                meshletTriangles.push_back(localIndex[v]);
+            }
+
+            emitted[next] = 1;
+
+            if (++meshlet.triangleCount == MAX_MESHLET_TRIANGLES)
+                break;
+
+        //  Next the unemitted neighbour that brings the fewest new vertices, ties go to the earlier triangle to keep the cache order
+            next = UINT32_MAX;
+            uint32_t bestCost = 4;
+
+            for (uint32_t i = meshlet.vertexOffset; i < meshletVertices.size() && bestCost > 0; ++i)
+            {
+                const uint32_t v = meshletVertices[i];
+
+                for (uint32_t j = offsets[v]; j < offsets[v + 1]; ++j)
+                {
+                    const uint32_t t = adjacency[j];
+
+                    if (emitted[t])
+                        continue;
+
+                    const uint32_t cost = newVertices(t);
+
+                    if (meshlet.vertexCount + cost > MAX_MESHLET_VERTICES)
+                        continue;
+
+                    if (cost < bestCost || (cost == bestCost && t < next))
+                    {
+                        bestCost = cost;
+                        next     = t;
+                    }
+                }
+            }
+        }
+
+        for (uint32_t i = meshlet.vertexOffset; i < meshletVertices.size(); ++i)
+            localIndex[meshletVertices[i]] = 0xFF;
+
+    //  Bounding sphere centered on the box
+        Float3 boxMin = {  INFINITY,  INFINITY,  INFINITY };
+        Float3 boxMax = { -INFINITY, -INFINITY, -INFINITY };
+
+        for (uint32_t i = 0; i < meshlet.vertexCount; ++i)
+        {
+            const Float3 p = load_position(positions, positionStride, meshletVertices[meshlet.vertexOffset + i]);
+
+            boxMin = { std::min(boxMin.x, p.x), std::min(boxMin.y, p.y), std::min(boxMin.z, p.z) };
+            boxMax = { std::max(boxMax.x, p.x), std::max(boxMax.y, p.y), std::max(boxMax.z, p.z) };
+        }
+
+        const Float3 center = { (boxMin.x + boxMax.x) * 0.5f, (boxMin.y + boxMax.y) * 0.5f, (boxMin.z + boxMax.z) * 0.5f };
+        float radius = 0.f;
+
+        for (uint32_t i = 0; i < meshlet.vertexCount; ++i)
+        {
+            const Float3 d = subtract(load_position(positions, positionStride, meshletVertices[meshlet.vertexOffset + i]), center);
+            radius = std::max(radius, std::sqrt(dot(d, d)));
+        }
+
+    //  Normal cone around the mean triangle normal, it only culls when every normal is within ~84 degrees of the axis
+        std::vector<Float3> normals;
+        normals.reserve(meshlet.triangleCount);
+
+        Float3 axis = { 0.f, 0.f, 0.f };
+
+        for (uint32_t t = 0; t < meshlet.triangleCount; ++t)
+        {
+            const uint8_t* triangle = &meshletTriangles[meshlet.triangleOffset + t * 3];
+            const Float3 a = load_position(positions, positionStride, meshletVertices[meshlet.vertexOffset + triangle[0]]);
+            const Float3 b = load_position(positions, positionStride, meshletVertices[meshlet.vertexOffset + triangle[1]]);
+            const Float3 c = load_position(positions, positionStride, meshletVertices[meshlet.vertexOffset + triangle[2]]);
+
+            const Float3 n      = cross(subtract(b, a), subtract(c, a));
+            const float  length = std::sqrt(dot(n, n));
+
+            if (length == 0.f)
+                continue;
+
+            normals.push_back({ n.x / length, n.y / length, n.z / length });
+            axis = { axis.x + normals.back().x, axis.y + normals.back().y, axis.z + normals.back().z };
+        }
+
+        const float axisLength = std::sqrt(dot(axis, axis));
+        float cutoff = 1.f;
+
+        if (axisLength > 0.f)
+        {
+            axis = { axis.x / axisLength, axis.y / axisLength, axis.z / axisLength };
+
+            float minDot = 1.f;
+
+            for (const auto& n : normals)
+                minDot = std::min(minDot, dot(n, axis));
+
+            if (minDot > 0.1f)
+                cutoff = std::sqrt(1.f - minDot * minDot);
+        }
+
+        meshlet.sphere[0] = center.x;
+        meshlet.sphere[1] = center.y;
+        meshlet.sphere[2] = center.z;
+        meshlet.sphere[3] = radius;
+
+        meshlet.cone[0] = axis.x;
+        meshlet.cone[1] = axis.y;
+        meshlet.cone[2] = axis.z;
+        meshlet.cone[3] = cutoff;
+
+        meshlets.push_back(meshlet);
+    }
+
+    return static_cast<uint32_t>(meshlets.size() - firstMeshlet);
+}
+
+
+uint32_t MeshOptimizer::optimizeVertexFetch(std::span<uint32_t> indices, std::span<std::byte> vertices, size_t vertexSize) noexcept
+{
+    const uint32_t vertexCount = static_cast<uint32_t>(vertices.size() / vertexSize);
+
+    std::vector<uint32_t> remap(vertexCount, UINT32_MAX);
+    uint32_t next = 0;
+
+    for (auto& index : indices)
+    {
+        if (remap[index] == UINT32_MAX)
+            remap[index] = next++;
+
+        index = remap[index];
+    }
+
+    std::vector<std::byte> reordered(next * vertexSize);
+
+    for (uint32_t v = 0; v < vertexCount; ++v)
+        if (remap[v] != UINT32_MAX)
+            memcpy(&reordered[remap[v] * vertexSize], &vertices[v * vertexSize], vertexSize);
+
+    memcpy(vertices.data(), reordered.data(), reordered.size());
+
+    return next;
+}
+
+
+VkIndexType MeshOptimizer::getIndexType(uint32_t vertexCount) noexcept
+{
+    return (vertexCount < UINT16_MAX) ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+}
+
+
+std::vector<uint16_t> MeshOptimizer::narrowIndices(std::span<const uint32_t> indices) noexcept
+{
+    return std::vector<uint16_t>(indices.begin(), indices.end());
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+#ifndef MESH_OPTIMIZER_HPP
+#define MESH_OPTIMIZER_HPP
+
+#include <span>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include <vulkan/vulkan.h>
+
+
+// Import/bake time processing of indexed triangle lists, meant to run in this order:
+// optimizeVertexCache() -> optimizeOverdraw() -> simplify() per level of detail -> optimizeVertexFetch() -> buildMeshlets() per level -> getIndexType()/narrowIndices().
+// Apart from simplify() every step keeps the triangles, only their order and the vertex order change.
+class MeshOptimizer
+{
+public:
+    static constexpr uint32_t MAX_MESHLET_VERTICES  = 64;
+    static constexpr uint32_t MAX_MESHLET_TRIANGLES = 124;
+
+//  Cluster of up to 64 vertices and 124 triangles, laid out for std430 so the records can go to the GPU as they are
+    struct Meshlet
+    {
+        float    sphere[4];      // center and radius
+        float    cone[4];        // axis and cutoff: back facing when dot(center - eye, axis) >= cutoff * |center - eye| + radius, cutoff 1 never culls
+        uint32_t vertexOffset;   // into meshletVertices
+        uint32_t triangleOffset; // into meshletTriangles, in bytes
+        uint32_t vertexCount;
+        uint32_t triangleCount;
+    };
+
+    static_assert(sizeof(Meshlet) == 48);
+
+//  Triangle order for the post-transform vertex cache (Forsyth's linear-speed algorithm)
+    static void optimizeVertexCache(std::span<uint32_t> indices, uint32_t vertexCount) noexcept;
+
+//  Splits the cache-optimized order where the cache runs cold anyway and draws the outward facing clusters first.
+//  positions points to the first float3 position, positionStride is the distance between vertices in bytes
+    static void optimizeOverdraw(std::span<uint32_t> indices, const float* positions, size_t positionStride, uint32_t vertexCount) noexcept;
+
+//  Quadric error edge collapse towards targetIndexCount, stopping early where the next collapse would move the surface by more than targetError.
+//  Vertices collapse onto other existing vertices, so every level can share the original vertex buffer. UV seams and open borders only
+//  collapse along themselves and their corners stay. resultError receives the largest deviation from the input, in position units
+    static std::vector<uint32_t> simplify(std::span<const uint32_t> indices, const float* positions, size_t positionStride, uint32_t vertexCount,
+                                          size_t targetIndexCount, float targetError, float& resultError) noexcept;
+
+//  Greedy clustering that grows each meshlet over the triangles adding the fewest new vertices. Appends to the output vectors:
+//  meshletVertices holds mesh vertex indices, meshletTriangles three local 8-bit indices per triangle. Returns the number of new meshlets
+    static uint32_t buildMeshlets(std::span<const uint32_t> indices, const float* positions, size_t positionStride, uint32_t vertexCount,
+                                  std::vector<Meshlet>& meshlets, std::vector<uint32_t>& meshletVertices, std::vector<uint8_t>& meshletTriangles) noexcept;
+
+//  Vertices in first-use order, unreferenced ones are dropped. Returns the new vertex count
+    static uint32_t optimizeVertexFetch(std::span<uint32_t> indices, std::span<std::byte> vertices, size_t vertexSize) noexcept;
+
+//  16-bit whenever the mesh fits, 0xFFFF stays free for primitive restart
+    static VkIndexType           getIndexType(uint32_t vertexCount)             noexcept;
+    static std::vector<uint16_t> narrowIndices(std::span<const uint32_t> indices) noexcept;
+};
+
+#endif // !MESH_OPTIMIZER_HPP
\ No newline at end of file
@@ -0,0 +1,160 @@
+#include <thread>
+#include <cmath>
+#include <algorithm>
+
+#include "core/FramePacer.hpp"
+
+
+namespace
+{
+    using namespace std::chrono_literals;
+
+    constexpr auto MIN_SPIN_WINDOW = 200us;
+    constexpr auto MAX_SPIN_WINDOW = 4ms;
+
+    constexpr float SNAP_TOLERANCE    = 0.1f;  // relative distance to a whole number of refreshes
+    constexpr float STABLE_DEVIATION  = 0.05f; // cadence counts as a display refresh below this relative deviation
+    constexpr float CADENCE_SMOOTHING = 0.05f;
+
+    float to_ms(std::chrono::steady_clock::duration duration) noexcept
+    {
+        return std::chrono::duration<float, std::milli>(duration).count();
+    }
+}
+
+
+FramePacer::FramePacer() noexcept:
+    m_vsync(false),
+    m_target(Clock::duration::zero()),
+    m_interval(Clock::duration::zero()),
+    m_spinWindow(1ms),
+    m_deadline(Clock::now()),
+    m_lastPresent(),
+    m_cadence(0.f),
+    m_deviation(0.f),
+    m_windowStart(Clock::now()),
+    m_errorSum(0.0),
+    m_errorMax(0.f),
+    m_frames(0)
+{
+
+}
+
+
+void FramePacer::setTargetInterval(float seconds) noexcept
+{
+    m_target   = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(std::max(seconds, 0.f)));
+    m_interval = m_target;
+    m_deadline = Clock::now();
+
+    calibrate();
+}
+
+
+void FramePacer::setVsync(bool vsync) noexcept
+{
+    m_vsync     = vsync;
+    m_cadence   = 0.f; // the old cadence may have been measured under another present mode
+    m_deviation = 0.f;
+
+    calibrate();
+}
+
+
+void FramePacer::wait() noexcept
+{
+    if(m_interval == Clock::duration::zero())
+        return;
+
+    m_deadline += m_interval;
+
+    auto now = Clock::now();
+
+//  More than a whole interval behind: start over from now instead of rushing frames to catch up
+    if(now > m_deadline + m_interval)
+        m_deadline = now;
+
+    if(now < m_deadline - m_spinWindow)
+    {
+        const auto wake = m_deadline - m_spinWindow;
+        std::this_thread::sleep_until(wake);
+
+    //  The spin window tracks how far sleeps overshoot, with some margin
+        const auto overshoot = Clock::now() - wake;
+        m_spinWindow = std::clamp((m_spinWindow * 7 + overshoot * 2) / 8, Clock::duration(MIN_SPIN_WINDOW), Clock::duration(MAX_SPIN_WINDOW));
+    }
+
+    while ((now = Clock::now()) < m_deadline)
+        std::this_thread::yield();
+
+    const float error = std::fabs(to_ms(now - m_deadline));
+
+    m_errorSum += error;
+    m_errorMax  = std::max(m_errorMax, error);
+    ++m_frames;
+}
+
+
+void FramePacer::onPresent() noexcept
+{
+    const auto now = Clock::now();
+
+    if(m_lastPresent != Clock::time_point())
+    {
+        const float interval = std::chrono::duration<float>(now - m_lastPresent).count();
+
+        if(m_cadence == 0.f)
+            m_cadence = interval;
+
+        m_deviation += CADENCE_SMOOTHING * (std::fabs(interval - m_cadence) - m_deviation);
+        m_cadence   += CADENCE_SMOOTHING * (interval - m_cadence);
+    }
+
+    m_lastPresent = now;
+}
+
+
+bool FramePacer::takeReport(Report& report) noexcept
+{
+    const auto now = Clock::now();
+
+    if(now - m_windowStart < 1s)
+        return false;
+
+    calibrate();
+
+    report =
+    {
+        .interval       = to_ms(m_interval),
+        .presentCadence = m_cadence * 1000.f,
+        .meanError      = m_frames ? static_cast<float>(m_errorSum / m_frames) : 0.f,
+        .maxError       = m_errorMax,
+        .frames         = m_frames
+    };
+
+    m_windowStart = now;
+    m_errorSum    = 0.0;
+    m_errorMax    = 0.f;
+    m_frames      = 0;
+
+    return true;
+}
+
+
+// Under FIFO a stable cadence is the display refresh, pacing slightly off a multiple of it would beat against the display
+// and drop a frame every few seconds. Other present modes show the pacer's own spacing, snapping to that would lock in
+// any slow stretch, and an interval longer than the target is never taken for the same reason
+void FramePacer::calibrate() noexcept
+{
+    m_interval = m_target;
+
+    if(!m_vsync || m_target == Clock::duration::zero() || m_cadence <= 0.f || m_deviation > STABLE_DEVIATION * m_cadence)
+        return;
+
+    const float target = std::chrono::duration<float>(m_target).count();
+    const float ratio  = target / m_cadence;
+    const float count  = std::max(std::round(ratio), 1.f);
+
+    if(std::fabs(ratio - count) < SNAP_TOLERANCE * count && count * m_cadence <= target)
+        m_interval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(count * m_cadence));
+}
\ No newline at end of file
@@ -0,0 +1,59 @@
+#ifndef FRAME_PACER_HPP
+#define FRAME_PACER_HPP
+
+#include <chrono>
+#include <cstdint>
+
+
+// Holds the main loop to a fixed frame interval.
+// wait() sleeps coarsely until shortly before the deadline and spins the rest, the spin window follows the measured oversleep.
+// Deadlines advance by whole intervals, so one late frame does not shift the ones after it.
+// onPresent() measures the present cadence. Only when presents wait for vblank (FIFO) is that cadence the display refresh,
+// then a target within 10% of a whole number of refreshes snaps down to it. With other modes the cadence is the pacer's own.
+class FramePacer
+{
+public:
+    struct Report
+    {
+        float    interval;       // ms, after calibration
+        float    presentCadence; // ms, 0 until measured
+        float    meanError;      // ms, mean |frame start - deadline|
+        float    maxError;       // ms
+        uint32_t frames;
+    };
+
+    FramePacer() noexcept;
+
+    void setTargetInterval(float seconds) noexcept; // 0 disables pacing
+    void setVsync(bool vsync) noexcept;             // whether presents are locked to the display refresh
+
+    void wait() noexcept;
+    void onPresent() noexcept;
+
+//  True about once a second, the statistics start over afterwards
+    bool takeReport(Report& report) noexcept;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void calibrate() noexcept;
+
+    bool              m_vsync;
+    Clock::duration   m_target;      // requested interval
+    Clock::duration   m_interval;    // interval in use
+    Clock::duration   m_spinWindow;
+    Clock::time_point m_deadline;
+
+//  Present cadence
+    Clock::time_point m_lastPresent;
+    float             m_cadence;   // seconds, smoothed
+    float             m_deviation; // seconds, smoothed |interval - cadence|
+
+//  Report window
+    Clock::time_point m_windowStart;
+    double            m_errorSum;
+    float             m_errorMax;
+    uint32_t          m_frames;
+};
+
+#endif // !FRAME_PACER_HPP
\ No newline at end of file
@@ -0,0 +1,77 @@
+#include <new>
+#include <atomic>
+#include <cstdlib>
+#include <cstddef>
+
+#include "core/HeapCounter.hpp"
+
+
+#ifdef DEBUG
+
+namespace
+{
+    std::atomic<uint64_t> allocationCount { 0 };
+
+    void* allocate(std::size_t size, std::size_t alignment)
+    {
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+
+        size = size ? size : 1;
+
+#ifdef _WIN32
+        void* data = _aligned_malloc(size, alignment);
+#else
+        void* data = (alignment <= alignof(std::max_align_t)) ? std::malloc(size) : std::aligned_alloc(alignment, (size + alignment - 1) & ~(alignment - 1));
+#endif
+        if(!data)
+            throw std::bad_alloc();
+
+        return data;
+    }
+
+    void deallocate(void* data) noexcept
+    {
+#ifdef _WIN32
+        _aligned_free(data);
+#else
+        std::free(data);
+#endif
+    }
+}
+
+//  The array and nothrow forms forward to these
+void* operator new(std::size_t size)                               { return allocate(size, alignof(std::max_align_t)); }
+void* operator new(std::size_t size, std::align_val_t alignment)   { return allocate(size, static_cast<std::size_t>(alignment)); }
+void* operator new[](std::size_t size)                             { return allocate(size, alignof(std::max_align_t)); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return allocate(size, static_cast<std::size_t>(alignment)); }
+
+void operator delete(void* data) noexcept                                  { deallocate(data); }
+void operator delete(void* data, std::size_t) noexcept                     { deallocate(data); }
+void operator delete(void* data, std::align_val_t) noexcept                { deallocate(data); }
+void operator delete(void* data, std::size_t, std::align_val_t) noexcept   { deallocate(data); }
+void operator delete[](void* data) noexcept                                { deallocate(data); }
+void operator delete[](void* data, std::size_t) noexcept                   { deallocate(data); }
+void operator delete[](void* data, std::align_val_t) noexcept              { deallocate(data); }
+void operator delete[](void* data, std::size_t, std::align_val_t) noexcept { deallocate(data); }
+
+#endif
+
+
+bool HeapCounter::isEnabled() noexcept
+{
+#ifdef DEBUG
+    return true;
+#else
+    return false;
+#endif
+}
+
+
+uint64_t HeapCounter::getAllocationCount() noexcept
+{
+#ifdef DEBUG
+    return allocationCount.load(std::memory_order_relaxed);
+#else
+    return 0;
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,16 @@
+#ifndef HEAP_COUNTER_HPP
+#define HEAP_COUNTER_HPP
+
+#include <cstdint>
+
+
+// Debug builds replace the global operator new/delete to count heap allocations from every thread,
+// so a code path can check that it allocated nothing. Release builds keep the default operators.
+class HeapCounter
+{
+public:
+    static bool     isEnabled() noexcept;
+    static uint64_t getAllocationCount() noexcept; // 0 when disabled
+};
+
+#endif // !HEAP_COUNTER_HPP
\ No newline at end of file
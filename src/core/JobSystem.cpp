@@ -0,0 +1,223 @@
+#include "core/JobSystem.hpp"
+
+
+namespace
+{
+//  Which pool and worker the calling thread belongs to
+    thread_local const JobSystem* t_system = nullptr;
+    thread_local uint32_t         t_worker = UINT32_MAX;
+}
+
+
+JobSystem::JobSystem() noexcept:
+    m_queuedJobs(0),
+    m_sleeping(0),
+    m_nextQueue(0),
+    m_quit(false)
+{
+
+}
+
+
+JobSystem::~JobSystem()
+{
+    destroy();
+}
+
+
+bool JobSystem::create(uint32_t workerCount) noexcept
+{
+    destroy();
+
+    m_quit        = false;
+
+    m_queues.resize(workerCount + 1);
+
+    for (auto& queue : m_queues)
+        queue = std::make_unique<Queue>();
+
+    t_system = this;
+    t_worker = 0;
+
+    for (uint32_t i = 1; i <= workerCount; ++i)
+        m_threads.emplace_back(&JobSystem::workerLoop, this, i);
+
+    return true;
+}
+
+
+void JobSystem::destroy() noexcept
+{
+    {
+        std::lock_guard lock(m_sleepMutex);
+        m_quit = true;
+    }
+
+    m_wake.notify_all();
+
+    for (auto& thread : m_threads)
+        thread.join();
+
+    m_threads.clear();
+    m_queues.clear();
+
+    if(t_system == this)
+    {
+        t_system = nullptr;
+        t_worker = UINT32_MAX;
+    }
+}
+
+
+void JobSystem::wait(Counter& counter) noexcept
+{
+    const uint32_t worker = currentWorker();
+
+    while (!counter.isDone())
+    {
+        if(!runOne(worker))
+            std::this_thread::yield();
+    }
+}
+
+
+uint32_t JobSystem::getThreadCount() const noexcept
+{
+    return static_cast<uint32_t>(m_threads.size()) + 1;
+}
+
+
+void JobSystem::push(const Job& job) noexcept
+{
+    if(m_queues.empty())
+    {
+        execute(job);
+        return;
+    }
+
+//  Threads outside the pool spread their jobs over all queues
+    uint32_t worker = currentWorker();
+
+    if(worker == UINT32_MAX)
+        worker = m_nextQueue.fetch_add(1, std::memory_order_relaxed) % m_queues.size();
+
+    {
+        auto& queue = *m_queues[worker];
+        std::unique_lock lock(queue.mutex);
+
+        if(queue.size == QUEUE_CAPACITY)
+        {
+            lock.unlock();
+            execute(job);
+
+            return;
+        }
+
+        queue.jobs[(queue.front + queue.size) % QUEUE_CAPACITY] = job;
+        ++queue.size;
+    }
+
+//  A worker going to sleep counts itself first and checks the queued jobs afterwards, so no wake-up is lost
+    m_queuedJobs.fetch_add(1);
+
+    if(m_sleeping.load() > 0)
+    {
+        std::lock_guard lock(m_sleepMutex);
+        m_wake.notify_one();
+    }
+}
+
+
+bool JobSystem::pop(uint32_t worker, Job& job) noexcept
+{
+    auto& queue = *m_queues[worker];
+    std::lock_guard lock(queue.mutex);
+
+    if(queue.size == 0)
+        return false;
+
+    --queue.size;
+    job = queue.jobs[(queue.front + queue.size) % QUEUE_CAPACITY];
+    m_queuedJobs.fetch_sub(1);
+
+    return true;
+}
+
+
+bool JobSystem::steal(uint32_t worker, Job& job) noexcept
+{
+    const uint32_t queueCount = static_cast<uint32_t>(m_queues.size());
+
+    for (uint32_t i = 1; i <= queueCount; ++i)
+    {
+        auto& queue = *m_queues[(worker + i) % queueCount];
+        std::lock_guard lock(queue.mutex);
+
+        if(queue.size == 0)
+            continue;
+
+        job = queue.jobs[queue.front];
+        queue.front = (queue.front + 1) % QUEUE_CAPACITY;
+        --queue.size;
+        m_queuedJobs.fetch_sub(1);
+
+        return true;
+    }
+
+    return false;
+}
+
+
+bool JobSystem::runOne(uint32_t worker) noexcept
+{
+    Job job;
+
+    if(worker != UINT32_MAX && pop(worker, job))
+    {
+        execute(job);
+        return true;
+    }
+
+    if(!m_queues.empty() && steal(worker == UINT32_MAX ? 0 : worker, job))
+    {
+        execute(job);
+        return true;
+    }
+
+    return false;
+}
+
+
+void JobSystem::execute(const Job& job) noexcept
+{
+    job.invoke(job.storage);
+    job.counter->m_pending.fetch_sub(1, std::memory_order_release);
+}
+
+
+void JobSystem::workerLoop(uint32_t worker) noexcept
+{
+    t_system = this;
+    t_worker = worker;
+
+    while (true)
+    {
+        if(runOne(worker))
+            continue;
+
+        std::unique_lock lock(m_sleepMutex);
+
+        m_sleeping.fetch_add(1);
+        m_wake.wait(lock, [this] { return m_quit || m_queuedJobs.load() > 0; });
+        m_sleeping.fetch_sub(1);
+
+        if(m_quit)
+            return;
+    }
+}
+
+
+uint32_t JobSystem::currentWorker() const noexcept
+{
+    return (t_system == this) ? t_worker : UINT32_MAX;
+}
\ No newline at end of file
@@ -0,0 +1,152 @@
+#ifndef JOB_SYSTEM_HPP
+#define JOB_SYSTEM_HPP
+
+#include <new>
+#include <mutex>
+#include <array>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <type_traits>
+#include <condition_variable>
+
+
+// Work-stealing job scheduler shared by the whole engine.
+// Every worker owns a bounded deque: it pushes and pops its own jobs at the back (newest first, still warm in cache)
+// and steals from the front of the others when it runs dry. The thread that created the system is worker 0,
+// it has no thread of its own and runs jobs only while it waits on a counter.
+// Jobs are small callables copied into the queue slot, so scheduling never allocates. A full deque runs the job inline.
+class JobSystem
+{
+public:
+//  Number of scheduled jobs that have not finished yet, jobs of one batch share a counter
+    class Counter
+    {
+    public:
+        bool isDone() const noexcept { return m_pending.load(std::memory_order_acquire) == 0; }
+
+    private:
+        std::atomic<uint32_t> m_pending { 0 };
+        friend class JobSystem;
+    };
+
+    JobSystem() noexcept;
+    ~JobSystem();
+
+    bool create(uint32_t workerCount) noexcept; // threads besides the calling one, 0 runs everything on the caller
+    void destroy() noexcept;
+
+//  F is called once without arguments, the captures must fit into a slot and be trivially copyable (references, pointers, numbers)
+    template <class F>
+    void schedule(const F& job, Counter& counter) noexcept;
+
+//  Runs other jobs until the counter drops to zero
+    void wait(Counter& counter) noexcept;
+
+//  Calls f(first, last) over [0, count) in ranges of at most grain elements and returns when all are done.
+//  Ranges are numbered in order, f(first, last, range) receives the number as well if it takes three arguments
+    template <class F>
+    void parallelFor(uint32_t count, uint32_t grain, const F& f) noexcept;
+
+    uint32_t getThreadCount() const noexcept; // workers including the calling thread
+
+private:
+    static constexpr size_t   JOB_STORAGE    = 48;
+    static constexpr uint32_t QUEUE_CAPACITY = 1024;
+
+    struct Job
+    {
+        void (*invoke)(const void* storage) = nullptr;
+        Counter* counter = nullptr;
+        alignas(std::max_align_t) std::byte storage[JOB_STORAGE];
+    };
+
+//  Ring buffer, the owner works at the back and thieves at the front
+    struct alignas(64) Queue
+    {
+        std::mutex                       mutex;
+        std::array<Job, QUEUE_CAPACITY>  jobs;
+        uint32_t                         front = 0;
+        uint32_t                         size  = 0;
+    };
+
+    void push(const Job& job) noexcept;
+    bool pop(uint32_t worker, Job& job) noexcept;
+    bool steal(uint32_t worker, Job& job) noexcept;
+    bool runOne(uint32_t worker) noexcept;
+    void execute(const Job& job) noexcept;
+    void workerLoop(uint32_t worker) noexcept;
+    uint32_t currentWorker() const noexcept;
+
+    std::vector<std::unique_ptr<Queue>> m_queues; // one per worker, 0 is the creating thread
+    std::vector<std::thread>            m_threads;
+
+//  Idle workers sleep until new jobs are pushed
+    std::mutex              m_sleepMutex;
+    std::condition_variable m_wake;
+    std::atomic<uint32_t>   m_queuedJobs;
+    std::atomic<uint32_t>   m_sleeping;
+    std::atomic<uint32_t>   m_nextQueue; // round robin for threads outside the pool
+    bool                    m_quit;
+};
+
+
+template <class F>
+void JobSystem::schedule(const F& job, Counter& counter) noexcept
+{
+    static_assert(sizeof(F) <= JOB_STORAGE, "job captures too much, capture a pointer to the data instead");
+    static_assert(alignof(F) <= alignof(std::max_align_t));
+    static_assert(std::is_trivially_copyable_v<F> && std::is_trivially_destructible_v<F>);
+
+    Job entry;
+    entry.invoke  = [](const void* storage) { (*static_cast<const F*>(storage))(); };
+    entry.counter = &counter;
+    new (entry.storage) F(job);
+
+    counter.m_pending.fetch_add(1, std::memory_order_relaxed);
+    push(entry);
+}
+
+
+template <class F>
+void JobSystem::parallelFor(uint32_t count, uint32_t grain, const F& f) noexcept
+{
+    if(count == 0)
+        return;
+
+    grain = std::max(grain, 1U);
+    const uint32_t ranges = (count + grain - 1) / grain;
+
+    auto run = [&f, count, grain](uint32_t range)
+    {
+        const uint32_t first = range * grain;
+        const uint32_t last  = std::min(first + grain, count);
+
+        if constexpr (std::is_invocable_v<const F&, uint32_t, uint32_t, uint32_t>)
+            f(first, last, range);
+        else
+            f(first, last);
+    };
+
+    if(ranges == 1 || m_threads.empty())
+    {
+        for (uint32_t range = 0; range < ranges; ++range)
+            run(range);
+
+        return;
+    }
+
+    Counter counter;
+
+    for (uint32_t range = 1; range < ranges; ++range)
+        schedule([&run, range] { run(range); }, counter);
+
+    run(0);
+    wait(counter);
+}
+
+#endif // !JOB_SYSTEM_HPP
\ No newline at end of file
@@ -0,0 +1,91 @@
+#include <algorithm>
+
+#include "core/LinearAllocator.hpp"
+
+
+LinearAllocator::LinearAllocator() noexcept:
+    m_data(nullptr),
+    m_capacity(0),
+    m_offset(0),
+    m_peak(0)
+{
+
+}
+
+
+LinearAllocator::~LinearAllocator()
+{
+    destroy();
+}
+
+
+bool LinearAllocator::create(size_t capacity) noexcept
+{
+    destroy();
+
+    m_data = static_cast<std::byte*>(::operator new(capacity, std::align_val_t(alignof(std::max_align_t)), std::nothrow));
+
+    if(!m_data)
+        return false;
+
+    m_capacity = capacity;
+
+    return true;
+}
+
+
+void LinearAllocator::destroy() noexcept
+{
+    if(m_data)
+        ::operator delete(m_data, std::align_val_t(alignof(std::max_align_t)));
+
+    m_data     = nullptr;
+    m_capacity = 0;
+    m_offset   = 0;
+    m_peak     = 0;
+}
+
+
+void* LinearAllocator::allocate(size_t size, size_t alignment) noexcept
+{
+    const size_t offset = (m_offset + alignment - 1) & ~(alignment - 1);
+
+    m_peak = std::max(m_peak, offset + size);
+
+    if(!m_data || offset + size > m_capacity)
+        return nullptr;
+
+    m_offset = offset + size;
+
+    return m_data + offset;
+}
+
+
+void LinearAllocator::reset() noexcept
+{
+    m_offset = 0;
+}
+
+
+void LinearAllocator::rewind(size_t marker) noexcept
+{
+    m_offset = std::min(marker, m_offset);
+}
+
+
+size_t LinearAllocator::getMarker() const noexcept
+{
+    return m_offset;
+}
+
+
+size_t LinearAllocator::getCapacity() const noexcept
+{
+    return m_capacity;
+}
+
+
+size_t LinearAllocator::getPeak() const noexcept
+{
+    return m_peak;
+}
\ No newline at end of file
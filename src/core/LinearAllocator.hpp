@@ -0,0 +1,98 @@
+#ifndef LINEAR_ALLOCATOR_HPP
+#define LINEAR_ALLOCATOR_HPP
+
+#include <new>
+#include <span>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <type_traits>
+
+
+// Bump allocator over one block reserved up front. allocate() only moves a cursor and reset() frees everything at once,
+// so nothing in between ever touches the heap. Running out of space returns nullptr instead of falling back to the heap,
+// getPeak() reports how much the block would have needed.
+// Objects are never destroyed, only trivially destructible types may be constructed in it.
+// Frame arenas are reset once their frame slot has completed, setup code rewinds a shared scratch arena with Scope.
+class LinearAllocator
+{
+public:
+//  Rewinds the allocator to where it was when the scope opened
+    class Scope
+    {
+    public:
+        explicit Scope(LinearAllocator& allocator) noexcept: m_allocator(allocator), m_marker(allocator.m_offset) {}
+        ~Scope() { m_allocator.rewind(m_marker); }
+
+        Scope(const Scope&)            = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        LinearAllocator& m_allocator;
+        size_t           m_marker;
+    };
+
+    LinearAllocator() noexcept;
+    ~LinearAllocator();
+
+    LinearAllocator(const LinearAllocator&)            = delete;
+    LinearAllocator& operator=(const LinearAllocator&) = delete;
+
+    bool create(size_t capacity) noexcept;
+    void destroy() noexcept;
+
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t)) noexcept;
+
+//  Value-initialized, empty when the block is full
+    template <class T>
+    std::span<T> allocate(size_t count) noexcept;
+
+    template <class T, class... Args>
+    T* construct(Args&&... args) noexcept;
+
+    void reset() noexcept;
+    void rewind(size_t marker) noexcept;
+
+    size_t getMarker()   const noexcept;
+    size_t getCapacity() const noexcept;
+    size_t getPeak()     const noexcept; // highest demand since create(), including failed requests
+
+private:
+    std::byte* m_data;
+    size_t     m_capacity;
+    size_t     m_offset;
+    size_t     m_peak;
+};
+
+
+template <class T>
+std::span<T> LinearAllocator::allocate(size_t count) noexcept
+{
+    static_assert(std::is_trivially_destructible_v<T>, "arena memory is released without running destructors");
+
+    if(count == 0)
+        return {};
+
+    auto data = static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+
+    if(!data)
+        return {};
+
+    for (size_t i = 0; i < count; ++i)
+        new (data + i) T();
+
+    return { data, count };
+}
+
+
+template <class T, class... Args>
+T* LinearAllocator::construct(Args&&... args) noexcept
+{
+    static_assert(std::is_trivially_destructible_v<T>, "arena memory is released without running destructors");
+
+    void* data = allocate(sizeof(T), alignof(T));
+
+    return data ? new (data) T(std::forward<Args>(args)...) : nullptr;
+}
+
+#endif // !LINEAR_ALLOCATOR_HPP
\ No newline at end of file
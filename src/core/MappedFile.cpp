@@ -0,0 +1,130 @@
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+#endif
+
+#include "core/MappedFile.hpp"
+
+
+MappedFile::MappedFile() noexcept:
+    m_data(nullptr),
+    m_size(0)
+#ifdef _WIN32
+    , m_file(nullptr)
+    , m_mapping(nullptr)
+#endif
+{
+
+}
+
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+
+bool MappedFile::open(const char* path) noexcept
+{
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+    if(file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER size;
+
+    if(!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+    if(!mapping)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    if(void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0))
+    {
+        m_file    = file;
+        m_mapping = mapping;
+        m_data    = static_cast<const std::byte*>(view);
+        m_size    = static_cast<size_t>(size.QuadPart);
+
+        return true;
+    }
+
+    CloseHandle(mapping);
+    CloseHandle(file);
+#else
+    const int file = ::open(path, O_RDONLY);
+
+    if(file < 0)
+        return false;
+
+    struct stat info;
+
+    if(fstat(file, &info) == 0 && info.st_size > 0)
+    {
+        void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+
+    //  The mapping keeps its own reference to the file
+        ::close(file);
+
+        if(view == MAP_FAILED)
+            return false;
+
+    //  Loads are one sequential pass over the file, start reading ahead right away
+        madvise(view, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+        madvise(view, static_cast<size_t>(info.st_size), MADV_WILLNEED);
+
+        m_data = static_cast<const std::byte*>(view);
+        m_size = static_cast<size_t>(info.st_size);
+
+        return true;
+    }
+
+    ::close(file);
+#endif
+
+    return false;
+}
+
+
+void MappedFile::close() noexcept
+{
+    if(!m_data)
+        return;
+
+#ifdef _WIN32
+    UnmapViewOfFile(m_data);
+    CloseHandle(m_mapping);
+    CloseHandle(m_file);
+
+    m_file    = nullptr;
+    m_mapping = nullptr;
+#else
+    munmap(const_cast<std::byte*>(m_data), m_size);
+#endif
+
+    m_data = nullptr;
+    m_size = 0;
+}
+
+
+std::span<const std::byte> MappedFile::getData() const noexcept
+{
+    return { m_data, m_size };
+}
\ No newline at end of file
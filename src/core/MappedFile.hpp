@@ -0,0 +1,34 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <span>
+#include <cstddef>
+
+
+// Read-only memory mapping of a whole file. Pages are loaded by the OS on first touch,
+// so reading straight from the mapping avoids both the read() copy and an intermediate heap buffer.
+class MappedFile
+{
+public:
+    MappedFile() noexcept;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&)            = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const char* path) noexcept;
+    void close() noexcept;
+
+    std::span<const std::byte> getData() const noexcept;
+
+private:
+    const std::byte* m_data;
+    size_t           m_size;
+
+#ifdef _WIN32
+    void* m_file;
+    void* m_mapping;
+#endif
+};
+
+#endif // !MAPPED_FILE_HPP
\ No newline at end of file
@@ -0,0 +1,131 @@
+#include <cstdio>
+#include <numeric>
+#include <algorithm>
+
+#include "core/TaskGraph.hpp"
+
+
+namespace
+{
+    float to_ms(std::chrono::steady_clock::duration duration) noexcept
+    {
+        return std::chrono::duration<float, std::milli>(duration).count();
+    }
+}
+
+
+TaskGraph::TaskGraph() noexcept:
+    m_jobs(nullptr),
+    m_wallTime(0.f)
+{
+
+}
+
+
+TaskGraph::Task TaskGraph::add(const char* name, Function function, std::initializer_list<Task> dependencies) noexcept
+{
+    const auto task = static_cast<Task>(m_nodes.size());
+
+    for (auto dependency : dependencies)
+        m_nodes[dependency].dependents.push_back(task);
+
+    m_nodes.push_back(
+    {
+        .name            = name,
+        .function        = std::move(function),
+        .dependents      = {},
+        .dependencyCount = static_cast<uint32_t>(dependencies.size()),
+        .status          = Status::Pending,
+        .start           = 0.f,
+        .duration        = 0.f
+    });
+
+    return task;
+}
+
+
+bool TaskGraph::run(JobSystem& jobs) noexcept
+{
+    m_jobs   = &jobs;
+    m_states = std::make_unique<State[]>(m_nodes.size());
+    m_start  = Clock::now();
+
+    for (size_t i = 0; i < m_nodes.size(); ++i)
+    {
+        m_states[i].pending.store(m_nodes[i].dependencyCount, std::memory_order_relaxed);
+        m_states[i].blocked.store(false, std::memory_order_relaxed);
+    }
+
+    for (Task task = 0; task < m_nodes.size(); ++task)
+        if(m_nodes[task].dependencyCount == 0)
+            jobs.schedule([this, task] { execute(task); }, m_counter);
+
+    jobs.wait(m_counter);
+
+    m_wallTime = to_ms(Clock::now() - m_start);
+
+    return std::all_of(m_nodes.begin(), m_nodes.end(), [](const Node& node) { return node.status == Status::Done; });
+}
+
+
+void TaskGraph::report(const char* title) const noexcept
+{
+    std::vector<const Node*> order;
+
+    for (const auto& node : m_nodes)
+        order.push_back(&node);
+
+//  Tasks that never ran go last
+    std::stable_sort(order.begin(), order.end(), [](const Node* a, const Node* b)
+    {
+        const bool ranA = (a->status == Status::Done || a->status == Status::Failed);
+        const bool ranB = (b->status == Status::Done || b->status == Status::Failed);
+
+        return (ranA != ranB) ? ranA : a->start < b->start;
+    });
+
+    const float taskTime = std::accumulate(m_nodes.begin(), m_nodes.end(), 0.f, [](float sum, const Node& node) { return sum + node.duration; });
+
+    printf("%s: %.2f ms wall, %.2f ms of tasks on %u threads\n", title, m_wallTime, taskTime, m_jobs ? m_jobs->getThreadCount() : 1);
+
+    for (auto node : order)
+    {
+        switch (node->status)
+        {
+            case Status::Done:    printf("  %-20s %8.2f ms  at %8.2f ms\n", node->name, node->duration, node->start); break;
+            case Status::Failed:  printf("  %-20s %8.2f ms  at %8.2f ms  failed\n", node->name, node->duration, node->start); break;
+            case Status::Skipped: printf("  %-20s  skipped\n", node->name); break;
+            case Status::Pending: printf("  %-20s  not run\n", node->name); break;
+        }
+    }
+}
+
+
+void TaskGraph::execute(Task task) noexcept
+{
+    auto& node = m_nodes[task];
+
+    if(m_states[task].blocked.load(std::memory_order_relaxed))
+        node.status = Status::Skipped;
+    else
+    {
+        const auto start = Clock::now();
+        const bool done  = node.function();
+
+        node.start    = to_ms(start - m_start);
+        node.duration = to_ms(Clock::now() - start);
+        node.status   = done ? Status::Done : Status::Failed;
+    }
+
+//  The last dependency to finish schedules the task, the acq_rel decrement publishes everything the dependencies wrote
+    for (auto dependent : node.dependents)
+    {
+        auto& state = m_states[dependent];
+
+        if(node.status != Status::Done)
+            state.blocked.store(true, std::memory_order_relaxed);
+
+        if(state.pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            m_jobs->schedule([this, dependent] { execute(dependent); }, m_counter);
+    }
+}
\ No newline at end of file
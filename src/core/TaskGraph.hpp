@@ -0,0 +1,74 @@
+#ifndef TASK_GRAPH_HPP
+#define TASK_GRAPH_HPP
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+
+#include "core/JobSystem.hpp"
+
+
+// One-shot graph of named tasks run on the job system, a task starts as soon as the tasks it depends on have finished
+// so everything without a dependency between it runs in parallel.
+// A task returns false on failure, the tasks that depend on it are skipped and run() returns false.
+// Start and duration of every task are kept for report().
+class TaskGraph
+{
+public:
+    using Task     = uint32_t;
+    using Function = std::function<bool()>;
+
+    TaskGraph() noexcept;
+
+//  Dependencies must have been added before, which also keeps the graph acyclic
+    Task add(const char* name, Function function, std::initializer_list<Task> dependencies = {}) noexcept;
+
+//  Blocks until every task has run or been skipped, the calling thread helps with the work
+    bool run(JobSystem& jobs) noexcept;
+
+//  Per task timing in start order, the wall time against the summed task time shows how much ran in parallel
+    void report(const char* title) const noexcept;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    enum class Status : uint8_t
+    {
+        Pending,
+        Done,
+        Failed,
+        Skipped
+    };
+
+    struct Node
+    {
+        const char*       name;
+        Function          function;
+        std::vector<Task> dependents;
+        uint32_t          dependencyCount;
+        Status            status;
+        float             start;    // ms since run()
+        float             duration; // ms
+    };
+
+    struct State
+    {
+        std::atomic<uint32_t> pending; // unfinished dependencies
+        std::atomic<bool>     blocked; // a dependency failed or was skipped
+    };
+
+    void execute(Task task) noexcept;
+
+    std::vector<Node>        m_nodes;
+    std::unique_ptr<State[]> m_states;
+    JobSystem*               m_jobs;
+    JobSystem::Counter       m_counter;
+    Clock::time_point        m_start;
+    float                    m_wallTime; // ms
+};
+
+#endif // !TASK_GRAPH_HPP
\ No newline at end of file
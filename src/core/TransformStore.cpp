@@ -0,0 +1,349 @@
+#include "core/TransformStore.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define TRANSFORM_STORE_AVX
+
+    #ifdef _MSC_VER
+        #include <intrin.h>
+        #define AVX_TARGET
+    #else
+        #include <immintrin.h>
+        #define AVX_TARGET __attribute__((target("avx")))
+    #endif
+#endif
+
+
+namespace
+{
+    constexpr uint32_t BATCH = 8;
+
+    struct Components
+    {
+        const float* position[3];
+        const float* rotation[4];
+        const float* scale[3];
+    };
+
+
+//  Model = translation * rotation * scale, column major. The AVX path below runs the same operations in the same order
+    void compose_model(const Components& c, uint32_t i, mat4s& model) noexcept
+    {
+        const float x = c.rotation[0][i], y = c.rotation[1][i], z = c.rotation[2][i], w = c.rotation[3][i];
+        const float x2 = x + x, y2 = y + y, z2 = z + z;
+
+        const float xx = x * x2, yy = y * y2, zz = z * z2;
+        const float xy = x * y2, xz = x * z2, yz = y * z2;
+        const float wx = w * x2, wy = w * y2, wz = w * z2;
+
+        const float sx = c.scale[0][i], sy = c.scale[1][i], sz = c.scale[2][i];
+
+        float* m = &model.raw[0][0];
+
+        m[0]  = (1.f - (yy + zz)) * sx;
+        m[1]  = (xy + wz) * sx;
+        m[2]  = (xz - wy) * sx;
+        m[3]  = 0.f;
+
+        m[4]  = (xy - wz) * sy;
+        m[5]  = (1.f - (xx + zz)) * sy;
+        m[6]  = (yz + wx) * sy;
+        m[7]  = 0.f;
+
+        m[8]  = (xz + wy) * sz;
+        m[9]  = (yz - wx) * sz;
+        m[10] = (1.f - (xx + yy)) * sz;
+        m[11] = 0.f;
+
+        m[12] = c.position[0][i];
+        m[13] = c.position[1][i];
+        m[14] = c.position[2][i];
+        m[15] = 1.f;
+    }
+
+#ifdef TRANSFORM_STORE_AVX
+    bool has_avx() noexcept
+    {
+    #ifdef _MSC_VER
+        int info[4];
+        __cpuid(info, 1);
+
+    //  The OS has to save the YMM registers as well
+        const bool osxsave = (info[2] & (1 << 27)) != 0;
+        const bool avx     = (info[2] & (1 << 28)) != 0;
+
+        return osxsave && avx && (_xgetbv(0) & 6) == 6;
+    #else
+        return __builtin_cpu_supports("avx");
+    #endif
+    }
+
+
+    AVX_TARGET inline __m256 load_batch(const float* data, const uint32_t* indices, bool contiguous) noexcept
+    {
+        if(contiguous)
+            return _mm256_loadu_ps(data + indices[0]);
+
+        return _mm256_setr_ps(data[indices[0]], data[indices[1]], data[indices[2]], data[indices[3]],
+                              data[indices[4]], data[indices[5]], data[indices[6]], data[indices[7]]);
+    }
+
+
+//  Rows hold one matrix element of eight objects, afterwards each row holds eight elements of one object
+    AVX_TARGET inline void transpose(__m256 (&r)[8]) noexcept
+    {
+        const __m256 t0 = _mm256_unpacklo_ps(r[0], r[1]);
+        const __m256 t1 = _mm256_unpackhi_ps(r[0], r[1]);
+        const __m256 t2 = _mm256_unpacklo_ps(r[2], r[3]);
+        const __m256 t3 = _mm256_unpackhi_ps(r[2], r[3]);
+        const __m256 t4 = _mm256_unpacklo_ps(r[4], r[5]);
+        const __m256 t5 = _mm256_unpackhi_ps(r[4], r[5]);
+        const __m256 t6 = _mm256_unpacklo_ps(r[6], r[7]);
+        const __m256 t7 = _mm256_unpackhi_ps(r[6], r[7]);
+
+        const __m256 s0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+        const __m256 s1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+        const __m256 s2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+        const __m256 s3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+        const __m256 s4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+        const __m256 s5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+        const __m256 s6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+        const __m256 s7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+
+        r[0] = _mm256_permute2f128_ps(s0, s4, 0x20);
+        r[1] = _mm256_permute2f128_ps(s1, s5, 0x20);
+        r[2] = _mm256_permute2f128_ps(s2, s6, 0x20);
+        r[3] = _mm256_permute2f128_ps(s3, s7, 0x20);
+        r[4] = _mm256_permute2f128_ps(s0, s4, 0x31);
+        r[5] = _mm256_permute2f128_ps(s1, s5, 0x31);
+        r[6] = _mm256_permute2f128_ps(s2, s6, 0x31);
+        r[7] = _mm256_permute2f128_ps(s3, s7, 0x31);
+    }
+
+
+//  The dirty list is in marking order, so a batch only counts as a run when every lane follows the previous one
+    bool is_contiguous(const uint32_t* indices) noexcept
+    {
+        for (uint32_t i = 1; i < BATCH; ++i)
+            if(indices[i] != indices[0] + i)
+                return false;
+
+        return true;
+    }
+
+
+//  Eight objects per iteration, one lane each. Dirty runs are often consecutive (everything after start-up), those load directly
+    AVX_TARGET void compose_models_avx(const Components& c, const uint32_t* indices, mat4s* models) noexcept
+    {
+        const bool contiguous = is_contiguous(indices);
+
+        const __m256 x = load_batch(c.rotation[0], indices, contiguous);
+        const __m256 y = load_batch(c.rotation[1], indices, contiguous);
+        const __m256 z = load_batch(c.rotation[2], indices, contiguous);
+        const __m256 w = load_batch(c.rotation[3], indices, contiguous);
+
+        const __m256 x2 = _mm256_add_ps(x, x);
+        const __m256 y2 = _mm256_add_ps(y, y);
+        const __m256 z2 = _mm256_add_ps(z, z);
+
+        const __m256 xx = _mm256_mul_ps(x, x2), yy = _mm256_mul_ps(y, y2), zz = _mm256_mul_ps(z, z2);
+        const __m256 xy = _mm256_mul_ps(x, y2), xz = _mm256_mul_ps(x, z2), yz = _mm256_mul_ps(y, z2);
+        const __m256 wx = _mm256_mul_ps(w, x2), wy = _mm256_mul_ps(w, y2), wz = _mm256_mul_ps(w, z2);
+
+        const __m256 sx = load_batch(c.scale[0], indices, contiguous);
+        const __m256 sy = load_batch(c.scale[1], indices, contiguous);
+        const __m256 sz = load_batch(c.scale[2], indices, contiguous);
+
+        const __m256 one  = _mm256_set1_ps(1.f);
+        const __m256 zero = _mm256_setzero_ps();
+
+        __m256 low[8] =
+        {
+            _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(yy, zz)), sx),
+            _mm256_mul_ps(_mm256_add_ps(xy, wz), sx),
+            _mm256_mul_ps(_mm256_sub_ps(xz, wy), sx),
+            zero,
+            _mm256_mul_ps(_mm256_sub_ps(xy, wz), sy),
+            _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, zz)), sy),
+            _mm256_mul_ps(_mm256_add_ps(yz, wx), sy),
+            zero
+        };
+
+        __m256 high[8] =
+        {
+            _mm256_mul_ps(_mm256_add_ps(xz, wy), sz),
+            _mm256_mul_ps(_mm256_sub_ps(yz, wx), sz),
+            _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, yy)), sz),
+            zero,
+            load_batch(c.position[0], indices, contiguous),
+            load_batch(c.position[1], indices, contiguous),
+            load_batch(c.position[2], indices, contiguous),
+            one
+        };
+
+        transpose(low);
+        transpose(high);
+
+        for (uint32_t i = 0; i < BATCH; ++i)
+        {
+            float* m = &models[indices[i]].raw[0][0];
+
+            _mm256_storeu_ps(m, low[i]);
+            _mm256_storeu_ps(m + 8, high[i]);
+        }
+    }
+#endif
+}
+
+
+TransformStore::TransformStore() noexcept:
+    m_avx(false)
+{
+#ifdef TRANSFORM_STORE_AVX
+    m_avx = has_avx();
+#endif
+}
+
+
+void TransformStore::reserve(uint32_t count) noexcept
+{
+    for (auto& array : m_position) array.reserve(count);
+    for (auto& array : m_rotation) array.reserve(count);
+    for (auto& array : m_scale)    array.reserve(count);
+
+    m_models.reserve(count);
+    m_isDirty.reserve(count);
+    m_dirty.reserve(count);
+    m_updated.reserve(count);
+    m_free.reserve(count);
+}
+
+
+TransformStore::Index TransformStore::add(vec3s position, versors rotation, vec3s scale) noexcept
+{
+    if(!m_free.empty())
+    {
+        const Index index = m_free.back();
+        m_free.pop_back();
+
+        setPosition(index, position);
+        setRotation(index, rotation);
+        setScale(index, scale);
+
+        return index;
+    }
+
+    const auto index = static_cast<Index>(m_models.size());
+
+    for (uint32_t i = 0; i < 3; ++i) m_position[i].push_back(position.raw[i]);
+    for (uint32_t i = 0; i < 4; ++i) m_rotation[i].push_back(rotation.raw[i]);
+    for (uint32_t i = 0; i < 3; ++i) m_scale[i].push_back(scale.raw[i]);
+
+    m_models.push_back(glms_mat4_identity());
+    m_isDirty.push_back(0);
+
+//  Room for every object to be dirty at once, so marking never allocates
+    m_dirty.reserve(m_models.size());
+    m_updated.reserve(m_models.size());
+
+    markDirty(index);
+
+    return index;
+}
+
+
+void TransformStore::remove(Index index) noexcept
+{
+    m_free.push_back(index);
+}
+
+
+void TransformStore::setPosition(Index index, vec3s position) noexcept
+{
+    for (uint32_t i = 0; i < 3; ++i)
+        m_position[i][index] = position.raw[i];
+
+    markDirty(index);
+}
+
+
+void TransformStore::setRotation(Index index, versors rotation) noexcept
+{
+    for (uint32_t i = 0; i < 4; ++i)
+        m_rotation[i][index] = rotation.raw[i];
+
+    markDirty(index);
+}
+
+
+void TransformStore::setScale(Index index, vec3s scale) noexcept
+{
+    for (uint32_t i = 0; i < 3; ++i)
+        m_scale[i][index] = scale.raw[i];
+
+    markDirty(index);
+}
+
+
+vec3s TransformStore::getPosition(Index index) const noexcept
+{
+    return vec3s { m_position[0][index], m_position[1][index], m_position[2][index] };
+}
+
+
+std::span<const TransformStore::Index> TransformStore::update() noexcept
+{
+    m_updated.clear();
+    m_updated.swap(m_dirty);
+
+    const Components components =
+    {
+        .position = { m_position[0].data(), m_position[1].data(), m_position[2].data() },
+        .rotation = { m_rotation[0].data(), m_rotation[1].data(), m_rotation[2].data(), m_rotation[3].data() },
+        .scale    = { m_scale[0].data(), m_scale[1].data(), m_scale[2].data() }
+    };
+
+    const auto count = static_cast<uint32_t>(m_updated.size());
+    uint32_t   first = 0;
+
+#ifdef TRANSFORM_STORE_AVX
+    if(m_avx)
+        for (; first + BATCH <= count; first += BATCH)
+            compose_models_avx(components, m_updated.data() + first, m_models.data());
+#endif
+
+    for (uint32_t i = first; i < count; ++i)
+        compose_model(components, m_updated[i], m_models[m_updated[i]]);
+
+    for (auto index : m_updated)
+        m_isDirty[index] = 0;
+
+    return m_updated;
+}
+
+
+const mat4s& TransformStore::getModel(Index index) const noexcept
+{
+    return m_models[index];
+}
+
+
+std::span<const mat4s> TransformStore::getModels() const noexcept
+{
+    return m_models;
+}
+
+
+uint32_t TransformStore::getCount() const noexcept
+{
+    return static_cast<uint32_t>(m_models.size());
+}
+
+
+void TransformStore::markDirty(Index index) noexcept
+{
+    if(m_isDirty[index])
+        return;
+
+    m_isDirty[index] = 1;
+    m_dirty.push_back(index);
+}
\ No newline at end of file
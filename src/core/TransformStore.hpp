@@ -0,0 +1,58 @@
+#ifndef TRANSFORM_STORE_HPP
+#define TRANSFORM_STORE_HPP
+
+#include <span>
+#include <array>
+#include <vector>
+#include <cstdint>
+
+#include <cglm/struct/mat4.h>
+#include <cglm/struct/quat.h>
+
+
+// Position, rotation and scale of every object in structure-of-arrays layout, with the model matrices they compose to.
+// Setters only mark an object dirty, update() rebuilds the matrices of the dirty objects eight at a time with AVX
+// (scalar on CPUs without it) and returns their indices, so its cost follows the number of changed objects.
+// Nothing allocates after the objects have been added.
+class TransformStore
+{
+public:
+    using Index = uint32_t;
+
+    TransformStore() noexcept;
+
+    void  reserve(uint32_t count) noexcept;
+    Index add(vec3s position, versors rotation, vec3s scale = { 1.f, 1.f, 1.f }) noexcept;
+    void  remove(Index index) noexcept; // the slot keeps its last matrix until add() reuses it
+
+    void setPosition(Index index, vec3s position)  noexcept;
+    void setRotation(Index index, versors rotation) noexcept;
+    void setScale(Index index, vec3s scale)        noexcept;
+
+    vec3s getPosition(Index index) const noexcept;
+
+//  Rebuilds the dirty matrices, the indices stay valid until the next call
+    std::span<const Index> update() noexcept;
+
+//  As of the last update()
+    const mat4s&           getModel(Index index) const noexcept;
+    std::span<const mat4s> getModels()           const noexcept;
+
+    uint32_t getCount() const noexcept; // slots, removed ones included
+
+private:
+    void markDirty(Index index) noexcept;
+
+    std::array<std::vector<float>, 3> m_position;
+    std::array<std::vector<float>, 4> m_rotation; // unit quaternion x, y, z, w
+    std::array<std::vector<float>, 3> m_scale;
+    std::vector<mat4s>                m_models;
+
+    std::vector<uint8_t> m_isDirty;
+    std::vector<Index>   m_dirty;
+    std::vector<Index>   m_updated; // swapped with m_dirty, both keep their capacity
+    std::vector<Index>   m_free;
+    bool                 m_avx;
+};
+
+#endif // !TRANSFORM_STORE_HPP
\ No newline at end of file
@@ -1,9 +1,47 @@
+#include <cstdlib>
+#include <cstring>
+
 #include "Application.hpp"
 
 
-int main()
+int main(int argc, char* argv[])
 {
+    Application::Settings settings;
+
+//  --frames-in-flight N, --swapchain-images N, --low-latency, --fps N,
+//  --dynamic-resolution, --min-scale X, --max-scale X, --gpu-budget MS, --lod-error PX, --no-cluster-culling, --mesh-shading,
+//  --depth-prepass, --no-depth-prepass
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--frames-in-flight") == 0 && i + 1 < argc)
+            settings.framesInFlight = static_cast<uint32_t>(atoi(argv[++i]));
+        else if (strcmp(argv[i], "--swapchain-images") == 0 && i + 1 < argc)
+            settings.swapchainImages = static_cast<uint32_t>(atoi(argv[++i]));
+        else if (strcmp(argv[i], "--low-latency") == 0)
+            settings.lowLatency = true;
+        else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc)
+            settings.targetFrameRate = static_cast<float>(atof(argv[++i]));
+        else if (strcmp(argv[i], "--dynamic-resolution") == 0)
+            settings.dynamicResolution = true;
+        else if (strcmp(argv[i], "--min-scale") == 0 && i + 1 < argc)
+            settings.minResolutionScale = static_cast<float>(atof(argv[++i]));
+        else if (strcmp(argv[i], "--max-scale") == 0 && i + 1 < argc)
+            settings.maxResolutionScale = static_cast<float>(atof(argv[++i]));
+        else if (strcmp(argv[i], "--gpu-budget") == 0 && i + 1 < argc)
+            settings.gpuBudgetMs = static_cast<float>(atof(argv[++i]));
+        else if (strcmp(argv[i], "--lod-error") == 0 && i + 1 < argc)
+            settings.lodPixelError = static_cast<float>(atof(argv[++i]));
+        else if (strcmp(argv[i], "--no-cluster-culling") == 0)
+            settings.clusterCulling = false;
+        else if (strcmp(argv[i], "--mesh-shading") == 0)
+            settings.meshShading = true;
+        else if (strcmp(argv[i], "--depth-prepass") == 0)
+            settings.depthPrepass = true;
+        else if (strcmp(argv[i], "--no-depth-prepass") == 0)
+            settings.depthPrepass = false;
+    }
+
     Application app;
 
-    return app.run();
-}
+    return app.run(settings);
+}
\ No newline at end of file
@@ -0,0 +1,544 @@
+#include <cfloat>
+#include <functional>
+
+#include "scene/Bvh.hpp"
+
+
+namespace
+{
+    constexpr uint32_t BINS = 16;
+
+    struct Box
+    {
+        float min[3] = {  FLT_MAX,  FLT_MAX,  FLT_MAX };
+        float max[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+        void grow(const float* lower, const float* upper) noexcept
+        {
+            for (uint32_t axis = 0; axis < 3; ++axis)
+            {
+                min[axis] = std::min(min[axis], lower[axis]);
+                max[axis] = std::max(max[axis], upper[axis]);
+            }
+        }
+
+        float getArea() const noexcept
+        {
+            const float x = max[0] - min[0], y = max[1] - min[1], z = max[2] - min[2];
+
+            return (x < 0.f) ? 0.f : 2.f * (x * y + y * z + z * x);
+        }
+    };
+
+
+    float get_centroid(const Bvh::Bounds& bounds, uint32_t axis) noexcept
+    {
+        return (bounds.min.raw[axis] + bounds.max.raw[axis]) * 0.5f;
+    }
+
+
+//  Distance at which the ray enters the box, false when it misses it within maxDistance
+    bool intersect_box(const float* min, const float* max, vec3s origin, vec3s inverse, float maxDistance, float& entry) noexcept
+    {
+        float tMin = 0.f;
+        float tMax = maxDistance;
+
+        for (uint32_t axis = 0; axis < 3; ++axis)
+        {
+            float t0 = (min[axis] - origin.raw[axis]) * inverse.raw[axis];
+            float t1 = (max[axis] - origin.raw[axis]) * inverse.raw[axis];
+
+            if(t0 > t1)
+                std::swap(t0, t1);
+
+            tMin = std::max(tMin, t0);
+            tMax = std::min(tMax, t1);
+        }
+
+        entry = tMin;
+
+        return tMin <= tMax;
+    }
+}
+
+
+Bvh::Bvh() noexcept:
+    m_cost(0.f),
+    m_buildCost(0.f),
+    m_jobs(nullptr),
+    m_rebuilding(false)
+{
+
+}
+
+
+Bvh::~Bvh()
+{
+    destroy();
+}
+
+
+void Bvh::build(std::span<const uint32_t> items, std::span<const Bounds> bounds) noexcept
+{
+    destroy();
+
+    uint32_t itemCount = 0;
+
+    for (auto item : items)
+        itemCount = std::max(itemCount, item + 1);
+
+    m_bounds.assign(itemCount, Bounds {});
+    m_leaves.assign(itemCount, NONE);
+
+    for (size_t i = 0; i < items.size(); ++i)
+        m_bounds[items[i]] = bounds[i];
+
+    m_rebuild.order.assign(items.begin(), items.end());
+    buildTree(m_rebuild, m_bounds);
+    adopt(m_rebuild);
+
+//  Rebuilds reuse this memory, so neither the worker nor the swap allocates
+    m_rebuild.nodes.reserve(m_tree.nodes.capacity());
+    m_rebuild.parents.reserve(m_tree.parents.capacity());
+    m_rebuild.order.reserve(m_tree.order.size());
+    m_rebuildBounds.reserve(m_bounds.size());
+}
+
+
+void Bvh::destroy() noexcept
+{
+    if(m_rebuilding)
+        m_jobs->wait(m_rebuildCounter);
+
+    m_rebuilding = false;
+    m_jobs       = nullptr;
+
+    m_tree    = {};
+    m_rebuild = {};
+    m_bounds.clear();
+    m_leaves.clear();
+    m_dirty.clear();
+    m_isDirty.clear();
+    m_rebuildBounds.clear();
+
+    m_cost      = 0.f;
+    m_buildCost = 0.f;
+}
+
+
+bool Bvh::contains(uint32_t item) const noexcept
+{
+    return item < m_leaves.size() && m_leaves[item] != NONE;
+}
+
+
+const Bvh::Bounds& Bvh::getBounds(uint32_t item) const noexcept
+{
+    return m_bounds[item];
+}
+
+
+void Bvh::setBounds(uint32_t item, const Bounds& bounds) noexcept
+{
+    m_bounds[item] = bounds;
+
+//  Marks the path up to the root, it stops where an earlier item already marked it
+    for (uint32_t node = m_leaves[item]; node != NONE && !m_isDirty[node]; node = m_tree.parents[node])
+    {
+        m_isDirty[node] = 1;
+        m_dirty.push_back(node);
+    }
+}
+
+
+void Bvh::refit(JobSystem& jobs) noexcept
+{
+    if(m_rebuilding && m_rebuildCounter.isDone())
+    {
+        m_rebuilding = false;
+        adopt(m_rebuild);
+    }
+
+    if(!m_dirty.empty())
+    {
+    //  Children come after their parents in depth-first order, so descending indices refit bottom-up
+        std::sort(m_dirty.begin(), m_dirty.end(), std::greater<uint32_t>());
+
+        for (auto node : m_dirty)
+        {
+            m_cost -= getCost(node);
+            refitNode(node);
+            m_cost += getCost(node);
+
+            m_isDirty[node] = 0;
+        }
+
+        m_dirty.clear();
+    }
+
+    if(m_rebuilding || m_tree.nodes.size() < 2 || getNormalizedCost() <= m_buildCost * REBUILD_RATIO)
+        return;
+
+//  The worker only touches the snapshot and m_rebuild, moves made meanwhile are picked up by adopt()
+    m_rebuildBounds.assign(m_bounds.begin(), m_bounds.end());
+    m_rebuild.order.assign(m_tree.order.begin(), m_tree.order.end());
+
+    m_jobs       = &jobs;
+    m_rebuilding = true;
+
+    jobs.schedule([this]
+    {
+        buildTree(m_rebuild, m_rebuildBounds);
+    }, m_rebuildCounter);
+}
+
+
+bool Bvh::raycast(vec3s origin, vec3s direction, float maxDistance, Hit& hit) const noexcept
+{
+    if(m_tree.nodes.empty())
+        return false;
+
+    const vec3s inverse = { 1.f / direction.x, 1.f / direction.y, 1.f / direction.z };
+
+    float    closest = maxDistance;
+    uint32_t found   = NONE;
+
+    uint32_t stack[STACK_SIZE];
+    uint32_t size = 0;
+
+    stack[size++] = 0;
+
+    while (size)
+    {
+        const Node& node = m_tree.nodes[stack[--size]];
+
+    //  Pushed when it was hit, but a closer item may have been found since
+        if(float entry; !intersect_box(node.min, node.max, origin, inverse, closest, entry))
+            continue;
+
+        if(node.count)
+        {
+            for (uint32_t i = 0; i < node.count; ++i)
+            {
+                const uint32_t item   = m_tree.order[node.offset + i];
+                const Bounds&  bounds = m_bounds[item];
+
+                if(float entry; intersect_box(bounds.min.raw, bounds.max.raw, origin, inverse, closest, entry) && entry < closest)
+                {
+                    closest = entry;
+                    found   = item;
+                }
+            }
+
+            continue;
+        }
+
+    //  The nearer child goes on top, its hits shorten the ray for the other one
+        const uint32_t left  = static_cast<uint32_t>(&node - m_tree.nodes.data()) + 1;
+        const uint32_t right = node.offset;
+
+        float leftEntry, rightEntry;
+        const bool hitLeft  = intersect_box(m_tree.nodes[left].min, m_tree.nodes[left].max, origin, inverse, closest, leftEntry);
+        const bool hitRight = intersect_box(m_tree.nodes[right].min, m_tree.nodes[right].max, origin, inverse, closest, rightEntry);
+
+        if(hitLeft && hitRight)
+        {
+            stack[size++] = (leftEntry < rightEntry) ? right : left;
+            stack[size++] = (leftEntry < rightEntry) ? left : right;
+        }
+        else if(hitLeft)  stack[size++] = left;
+        else if(hitRight) stack[size++] = right;
+    }
+
+    if(found == NONE)
+        return false;
+
+    hit = { found, closest };
+
+    return true;
+}
+
+
+// Gribb-Hartmann: each plane is the last row of the matrix plus or minus one of the others
+Bvh::Frustum Bvh::makeFrustum(const mat4s& viewProjection) noexcept
+{
+    auto row = [&viewProjection](uint32_t r) noexcept
+    {
+        return vec4s { viewProjection.raw[0][r], viewProjection.raw[1][r], viewProjection.raw[2][r], viewProjection.raw[3][r] };
+    };
+
+    const vec4s w = row(3);
+
+    Frustum frustum =
+    {
+        .planes =
+        {
+            glms_vec4_add(w, row(0)), glms_vec4_sub(w, row(0)),
+            glms_vec4_add(w, row(1)), glms_vec4_sub(w, row(1)),
+            glms_vec4_add(w, row(2)), glms_vec4_sub(w, row(2))
+        }
+    };
+
+    for (auto& plane : frustum.planes)
+    {
+        const float length = std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+
+        if(length > 0.f)
+            plane = glms_vec4_scale(plane, 1.f / length);
+    }
+
+    return frustum;
+}
+
+
+Bvh::Bounds Bvh::makeBounds(vec3s center, float radius) noexcept
+{
+    const vec3s extent = { radius, radius, radius };
+
+    return { glms_vec3_sub(center, extent), glms_vec3_add(center, extent) };
+}
+
+
+uint32_t Bvh::getNodeCount() const noexcept
+{
+    return static_cast<uint32_t>(m_tree.nodes.size());
+}
+
+
+void Bvh::buildTree(Tree& tree, std::span<const Bounds> bounds) noexcept
+{
+    const auto count = static_cast<uint32_t>(tree.order.size());
+
+    tree.nodes.clear();
+    tree.parents.clear();
+
+    if(count == 0)
+        return;
+
+    tree.nodes.reserve(2 * count - 1);
+    tree.parents.reserve(2 * count - 1);
+
+    tree.nodes.push_back({});
+    tree.parents.push_back(NONE);
+
+    buildNode(tree, bounds, 0, 0, count, 0);
+}
+
+
+// Binned SAH: the centroids of every axis are sorted into BINS slabs and the split between two slabs
+// with the lowest left area * left count + right area * right count wins
+void Bvh::buildNode(Tree& tree, std::span<const Bounds> bounds, uint32_t index, uint32_t first, uint32_t count, uint32_t depth) noexcept
+{
+    uint32_t* const items = tree.order.data() + first;
+
+    Box box, centroids;
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const Bounds& b = bounds[items[i]];
+        const float   c[3] = { get_centroid(b, 0), get_centroid(b, 1), get_centroid(b, 2) };
+
+        box.grow(b.min.raw, b.max.raw);
+        centroids.grow(c, c);
+    }
+
+    Node& node = tree.nodes[index];
+
+    std::copy_n(box.min, 3, node.min);
+    std::copy_n(box.max, 3, node.max);
+
+    if(count <= MAX_LEAF_ITEMS)
+    {
+        node.offset = first;
+        node.count  = count;
+
+        return;
+    }
+
+    uint32_t axis = 0;
+
+    for (uint32_t a = 1; a < 3; ++a)
+        if(centroids.max[a] - centroids.min[a] > centroids.max[axis] - centroids.min[axis])
+            axis = a;
+
+    uint32_t middle = 0;
+
+    if(depth < SAH_DEPTH && centroids.max[axis] > centroids.min[axis])
+    {
+        float    bestCost = FLT_MAX;
+        uint32_t bestAxis = 0, bestBin = 0;
+
+        for (uint32_t a = 0; a < 3; ++a)
+        {
+            const float extent = centroids.max[a] - centroids.min[a];
+
+            if(extent <= 0.f)
+                continue;
+
+            const float scale = BINS / extent;
+
+            Box      binBoxes[BINS];
+            uint32_t binCounts[BINS] = {};
+
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                const Bounds&  b   = bounds[items[i]];
+                const uint32_t bin = std::min(static_cast<uint32_t>((get_centroid(b, a) - centroids.min[a]) * scale), BINS - 1);
+
+                binBoxes[bin].grow(b.min.raw, b.max.raw);
+                ++binCounts[bin];
+            }
+
+        //  Areas and counts left of each split, then swept from the right
+            float    leftAreas[BINS - 1];
+            uint32_t leftCounts[BINS - 1];
+            Box      left;
+            uint32_t leftCount = 0;
+
+            for (uint32_t i = 0; i < BINS - 1; ++i)
+            {
+                left.grow(binBoxes[i].min, binBoxes[i].max);
+                leftCount += binCounts[i];
+
+                leftAreas[i]  = left.getArea();
+                leftCounts[i] = leftCount;
+            }
+
+            Box      right;
+            uint32_t rightCount = 0;
+
+            for (uint32_t i = BINS - 1; i > 0; --i)
+            {
+                right.grow(binBoxes[i].min, binBoxes[i].max);
+                rightCount += binCounts[i];
+
+                if(leftCounts[i - 1] == 0 || rightCount == 0)
+                    continue;
+
+                const float cost = leftAreas[i - 1] * leftCounts[i - 1] + right.getArea() * rightCount;
+
+                if(cost < bestCost)
+                {
+                    bestCost = cost;
+                    bestAxis = a;
+                    bestBin  = i - 1;
+                }
+            }
+        }
+
+        if(bestCost < FLT_MAX)
+        {
+            const float minimum = centroids.min[bestAxis];
+            const float scale   = BINS / (centroids.max[bestAxis] - minimum);
+
+            uint32_t* split = std::partition(items, items + count, [&](uint32_t item)
+            {
+                return std::min(static_cast<uint32_t>((get_centroid(bounds[item], bestAxis) - minimum) * scale), BINS - 1) <= bestBin;
+            });
+
+            middle = static_cast<uint32_t>(split - items);
+        }
+    }
+
+//  Equal centroids or too deep: half the items on each side
+    if(middle == 0 || middle == count)
+    {
+        middle = count / 2;
+
+        std::nth_element(items, items + middle, items + count, [&](uint32_t a, uint32_t b)
+        {
+            return get_centroid(bounds[a], axis) < get_centroid(bounds[b], axis);
+        });
+    }
+
+    const auto left = static_cast<uint32_t>(tree.nodes.size());
+
+    tree.nodes.push_back({});
+    tree.parents.push_back(index);
+    buildNode(tree, bounds, left, first, middle, depth + 1);
+
+    const auto right = static_cast<uint32_t>(tree.nodes.size());
+
+    tree.nodes.push_back({});
+    tree.parents.push_back(index);
+    buildNode(tree, bounds, right, first + middle, count - middle, depth + 1);
+
+    tree.nodes[index].offset = right;
+    tree.nodes[index].count  = 0;
+}
+
+
+void Bvh::adopt(Tree& tree) noexcept
+{
+    std::swap(m_tree, tree);
+
+    std::fill(m_leaves.begin(), m_leaves.end(), NONE);
+
+    for (uint32_t i = 0; i < m_tree.nodes.size(); ++i)
+        for (uint32_t j = 0; j < m_tree.nodes[i].count; ++j)
+            m_leaves[m_tree.order[m_tree.nodes[i].offset + j]] = i;
+
+    const auto nodeCount = static_cast<uint32_t>(m_tree.nodes.size());
+
+    m_isDirty.assign(nodeCount, 0);
+    m_dirty.clear();
+    m_dirty.reserve(nodeCount);
+
+//  A rebuilt tree was fitted to the snapshot, items may have moved since
+    m_cost = 0.f;
+
+    for (uint32_t i = nodeCount; i-- > 0;)
+    {
+        refitNode(i);
+        m_cost += getCost(i);
+    }
+
+    m_buildCost = getNormalizedCost();
+}
+
+
+void Bvh::refitNode(uint32_t index) noexcept
+{
+    Node& node = m_tree.nodes[index];
+    Box   box;
+
+    if(node.count)
+    {
+        for (uint32_t i = 0; i < node.count; ++i)
+        {
+            const Bounds& b = m_bounds[m_tree.order[node.offset + i]];
+            box.grow(b.min.raw, b.max.raw);
+        }
+    }
+    else
+    {
+        box.grow(m_tree.nodes[index + 1].min, m_tree.nodes[index + 1].max);
+        box.grow(m_tree.nodes[node.offset].min, m_tree.nodes[node.offset].max);
+    }
+
+    std::copy_n(box.min, 3, node.min);
+    std::copy_n(box.max, 3, node.max);
+}
+
+
+float Bvh::getCost(uint32_t index) const noexcept
+{
+    const Node& node = m_tree.nodes[index];
+
+    Box box;
+    box.grow(node.min, node.max);
+
+    return box.getArea() * static_cast<float>(node.count ? node.count : 1);
+}
+
+
+// Relative to the root's area, so the whole scene growing or shrinking does not count as degradation
+float Bvh::getNormalizedCost() const noexcept
+{
+    if(m_tree.nodes.empty())
+        return 0.f;
+
+    const float rootArea = getCost(0);
+
+    return (rootArea > 0.f) ? m_cost / rootArea : 0.f;
+}
\ No newline at end of file
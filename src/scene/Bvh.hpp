@@ -0,0 +1,264 @@
+#ifndef BVH_HPP
+#define BVH_HPP
+
+#include <span>
+#include <cmath>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+#include <cglm/struct/vec3.h>
+#include <cglm/struct/vec4.h>
+#include <cglm/struct/mat4.h>
+
+#include "core/JobSystem.hpp"
+
+
+// Bounding volume hierarchy over axis-aligned boxes, built with binned SAH (surface area heuristic).
+// Nodes are flattened in depth-first order, 32 bytes each: the left child follows its parent, the right one is referenced,
+// so a descent mostly walks forward through memory. Leaves reference a run of the item array, items are caller ids such as transform slots.
+// Moving items only refits the boxes on their path to the root. A refitted tree degrades as items drift apart,
+// once its SAH cost has grown by REBUILD_RATIO a new tree is built from a snapshot on a worker and swapped in when done.
+// Queries call back with the ids they find, adding or removing items takes another build().
+class Bvh
+{
+public:
+    static constexpr uint32_t MAX_LEAF_ITEMS = 4;
+    static constexpr float    REBUILD_RATIO  = 1.5f;
+
+    struct Bounds
+    {
+        vec3s min;
+        vec3s max;
+    };
+
+//  Inward facing planes n.x + d >= 0 in world space, vec4 (n, d)
+    struct Frustum
+    {
+        vec4s planes[6];
+    };
+
+    struct Hit
+    {
+        uint32_t item     = UINT32_MAX;
+        float    distance = 0.f;
+    };
+
+    Bvh() noexcept;
+    ~Bvh();
+
+    Bvh(const Bvh&)            = delete;
+    Bvh& operator=(const Bvh&) = delete;
+
+//  bounds[i] belongs to items[i], ids do not have to be dense
+    void build(std::span<const uint32_t> items, std::span<const Bounds> bounds) noexcept;
+    void destroy() noexcept; // waits for a rebuild in flight
+
+    bool          contains(uint32_t item)  const noexcept;
+    const Bounds& getBounds(uint32_t item) const noexcept;
+    void          setBounds(uint32_t item, const Bounds& bounds) noexcept;
+
+//  Refits the nodes above items that moved, swaps in a finished rebuild and starts one when the tree has degraded. Once per frame
+    void refit(JobSystem& jobs) noexcept;
+
+//  f(item) for every item whose box is not fully outside one of the planes
+    template <class F>
+    void queryFrustum(const Frustum& frustum, F&& f) const noexcept;
+
+//  f(item) for every item whose box overlaps the sphere
+    template <class F>
+    void querySphere(vec3s center, float radius, F&& f) const noexcept;
+
+//  Closest box along the ray, direction needs no normalization but distances are measured in its length
+    bool raycast(vec3s origin, vec3s direction, float maxDistance, Hit& hit) const noexcept;
+
+    static Frustum makeFrustum(const mat4s& viewProjection) noexcept;
+    static Bounds  makeBounds(vec3s center, float radius)   noexcept;
+
+    uint32_t getNodeCount() const noexcept;
+
+private:
+    static constexpr uint32_t NONE       = UINT32_MAX;
+    static constexpr uint32_t STACK_SIZE = 64; // the build keeps the depth below, see buildNode()
+    static constexpr uint32_t SAH_DEPTH  = 32; // deeper nodes split at the median, which halves the items every level
+
+    struct Node
+    {
+        float    min[3];
+        uint32_t offset; // leaf: first entry of m_order, interior: right child
+        float    max[3];
+        uint32_t count;  // items of a leaf, 0 for interior nodes
+    };
+
+    static_assert(sizeof(Node) == 32);
+
+//  A whole tree, the live one and the one a worker rebuilds have the same shape
+    struct Tree
+    {
+        std::vector<Node>     nodes;
+        std::vector<uint32_t> parents;
+        std::vector<uint32_t> order; // item ids grouped by leaf
+    };
+
+//  Builds over the ids in tree.order, bounds are indexed by id
+    static void buildTree(Tree& tree, std::span<const Bounds> bounds) noexcept;
+    static void buildNode(Tree& tree, std::span<const Bounds> bounds, uint32_t index, uint32_t first, uint32_t count, uint32_t depth) noexcept;
+
+    void  adopt(Tree& tree) noexcept; // makes tree the live one and fits it to the current bounds
+    void  refitNode(uint32_t index) noexcept;
+    float getCost(uint32_t index) const noexcept; // contribution of one node to the SAH cost
+    float getNormalizedCost()     const noexcept;
+
+    Tree                  m_tree;
+    std::vector<Bounds>   m_bounds; // by item id
+    std::vector<uint32_t> m_leaves; // leaf of each item id, NONE when absent
+
+    std::vector<uint32_t> m_dirty; // nodes whose boxes have to be refitted
+    std::vector<uint8_t>  m_isDirty;
+
+    float m_cost;      // sum of getCost() over all nodes
+    float m_buildCost; // normalized cost right after the last build
+
+    Tree                m_rebuild;
+    std::vector<Bounds> m_rebuildBounds; // snapshot the worker builds from
+    JobSystem::Counter  m_rebuildCounter;
+    JobSystem*          m_jobs;
+    bool                m_rebuilding;
+};
+
+
+namespace bvh_detail
+{
+//  False when the box is fully outside one of the planes in mask, planes the box is fully inside are cleared from mask
+    template <class Frustum>
+    bool intersects_frustum(const float* min, const float* max, const Frustum& frustum, uint32_t& mask) noexcept
+    {
+        for (uint32_t i = 0; i < 6; ++i)
+        {
+            if(!(mask & (1U << i)))
+                continue;
+
+            const vec4s& plane = frustum.planes[i];
+
+            float distance = plane.w;
+            float radius   = 0.f;
+
+            for (uint32_t axis = 0; axis < 3; ++axis)
+            {
+                distance += plane.raw[axis] * (min[axis] + max[axis]) * 0.5f;
+                radius   += std::abs(plane.raw[axis]) * (max[axis] - min[axis]) * 0.5f;
+            }
+
+            if(distance + radius < 0.f)
+                return false;
+
+            if(distance - radius >= 0.f)
+                mask &= ~(1U << i);
+        }
+
+        return true;
+    }
+
+
+    inline bool overlaps_sphere(const float* min, const float* max, vec3s center, float radius) noexcept
+    {
+        float distance = 0.f;
+
+        for (uint32_t axis = 0; axis < 3; ++axis)
+        {
+            const float d = std::max({ min[axis] - center.raw[axis], 0.f, center.raw[axis] - max[axis] });
+            distance += d * d;
+        }
+
+        return distance <= radius * radius;
+    }
+}
+
+
+template <class F>
+void Bvh::queryFrustum(const Frustum& frustum, F&& f) const noexcept
+{
+    if(m_tree.nodes.empty())
+        return;
+
+//  Each entry carries the planes its box still straddles, a box fully inside a plane spares its subtree the test
+    struct Entry
+    {
+        uint32_t node;
+        uint32_t planes;
+    };
+
+    Entry    stack[STACK_SIZE];
+    uint32_t size = 0;
+
+    stack[size++] = { 0, 0x3F };
+
+    while (size)
+    {
+        const Entry  entry = stack[--size];
+        const Node&  node  = m_tree.nodes[entry.node];
+        uint32_t     mask  = entry.planes;
+
+        if(!bvh_detail::intersects_frustum(node.min, node.max, frustum, mask))
+            continue;
+
+        if(node.count)
+        {
+            for (uint32_t i = 0; i < node.count; ++i)
+            {
+                const uint32_t item       = m_tree.order[node.offset + i];
+                const Bounds&  bounds     = m_bounds[item];
+                uint32_t       itemPlanes = mask;
+
+                if(bvh_detail::intersects_frustum(bounds.min.raw, bounds.max.raw, frustum, itemPlanes))
+                    f(item);
+            }
+        }
+        else
+        {
+            stack[size++] = { node.offset, mask };
+            stack[size++] = { entry.node + 1, mask };
+        }
+    }
+}
+
+
+template <class F>
+void Bvh::querySphere(vec3s center, float radius, F&& f) const noexcept
+{
+    if(m_tree.nodes.empty())
+        return;
+
+    uint32_t stack[STACK_SIZE];
+    uint32_t size = 0;
+
+    stack[size++] = 0;
+
+    while (size)
+    {
+        const uint32_t index = stack[--size];
+        const Node&    node  = m_tree.nodes[index];
+
+        if(!bvh_detail::overlaps_sphere(node.min, node.max, center, radius))
+            continue;
+
+        if(node.count)
+        {
+            for (uint32_t i = 0; i < node.count; ++i)
+            {
+                const uint32_t item   = m_tree.order[node.offset + i];
+                const Bounds&  bounds = m_bounds[item];
+
+                if(bvh_detail::overlaps_sphere(bounds.min.raw, bounds.max.raw, center, radius))
+                    f(item);
+            }
+        }
+        else
+        {
+            stack[size++] = node.offset;
+            stack[size++] = index + 1;
+        }
+    }
+}
+
+#endif // !BVH_HPP
\ No newline at end of file
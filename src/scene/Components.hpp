@@ -0,0 +1,31 @@
+#ifndef COMPONENTS_HPP
+#define COMPONENTS_HPP
+
+#include <cglm/struct/vec3.h>
+
+#include "core/TransformStore.hpp"
+
+
+// Components of the scene's entities, plain data for World's chunks
+
+//  Slot in the application's TransformStore, which is also the draw index into the instance buffer
+struct Transform
+{
+    TransformStore::Index index;
+};
+
+//  Drawn with the cube mesh
+struct Renderable
+{
+    float radius; // of the bounding sphere around the transform's position
+};
+
+//  Turns about a fixed axis
+struct Spin
+{
+    vec3s axis;
+    float speed; // radians per second
+    float angle;
+};
+
+#endif // !COMPONENTS_HPP
\ No newline at end of file
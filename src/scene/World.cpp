@@ -0,0 +1,388 @@
+#include <new>
+#include <bit>
+#include <cstdio>
+#include <cstdlib>
+
+#include "scene/World.hpp"
+
+
+namespace
+{
+    constexpr size_t CHUNK_ALIGNMENT = 64;
+
+    size_t align_up(size_t offset, size_t alignment) noexcept
+    {
+        return (offset + alignment - 1) & ~(alignment - 1);
+    }
+}
+
+
+World::World() noexcept:
+    m_entityCount(0)
+{
+
+}
+
+
+World::~World()
+{
+    for (const auto& archetype : m_archetypes)
+        for (auto chunk : archetype->chunks)
+            ::operator delete(chunk, std::align_val_t(CHUNK_ALIGNMENT));
+}
+
+
+void World::destroy(Entity entity) noexcept
+{
+    if(!isAlive(entity))
+        return;
+
+    const Record& record = m_records[entity.index];
+
+    if(record.archetype != PENDING)
+        removeRow(*m_archetypes[record.archetype], record.row);
+
+    releaseEntity(entity);
+}
+
+
+void World::destroyDeferred(Entity entity) noexcept
+{
+    m_commands.push_back({ CommandType::Destroy, entity, 0, 0, 0 });
+}
+
+
+void World::flush() noexcept
+{
+//  Commands run in the order they were queued, so a later one sees the result of an earlier one on the same entity
+    for (const auto& command : m_commands)
+    {
+        switch (command.type)
+        {
+            case CommandType::Create:
+            {
+                if(!isAlive(command.entity)) // destroyed before it was placed
+                    break;
+
+                if(!migrate(command.entity, command.mask))
+                {
+                    releaseEntity(command.entity);
+                    break;
+                }
+
+                size_t offset = command.data;
+
+                for (uint32_t i = 0; i < command.count; ++i)
+                {
+                    uint32_t id;
+                    memcpy(&id, m_commandData.data() + offset, sizeof(id));
+
+                    const uint32_t size = getComponentInfo(id).size;
+                    memcpy(getComponentData(command.entity, id), m_commandData.data() + offset + sizeof(id), size);
+
+                    offset += sizeof(id) + size;
+                }
+            }
+            break;
+
+            case CommandType::Destroy:
+                destroy(command.entity);
+            break;
+
+            case CommandType::Add:
+            {
+                uint32_t id;
+                memcpy(&id, m_commandData.data() + command.data, sizeof(id));
+                setComponent(command.entity, id, m_commandData.data() + command.data + sizeof(id));
+            }
+            break;
+
+            case CommandType::Remove:
+                removeComponent(command.entity, static_cast<uint32_t>(std::countr_zero(command.mask)));
+            break;
+        }
+    }
+
+    m_commands.clear();
+    m_commandData.clear();
+}
+
+
+bool World::isAlive(Entity entity) const noexcept
+{
+    return entity.index < m_records.size() &&
+           m_records[entity.index].generation == entity.generation &&
+           m_records[entity.index].archetype != NO_ARCHETYPE;
+}
+
+
+uint32_t World::getEntityCount() const noexcept
+{
+    return m_entityCount;
+}
+
+
+uint32_t World::getArchetypeCount() const noexcept
+{
+    return static_cast<uint32_t>(m_archetypes.size());
+}
+
+
+uint32_t World::registerComponent(uint32_t size, uint32_t alignment) noexcept
+{
+    auto& registry = getRegistry();
+
+    if(registry.size() == MAX_COMPONENTS || alignment > CHUNK_ALIGNMENT)
+    {
+        printf("World: component type %zu does not fit, at most %u types aligned to %zu bytes\n", registry.size(), MAX_COMPONENTS, CHUNK_ALIGNMENT);
+        std::abort();
+    }
+
+    registry.push_back({ size, alignment });
+
+    return static_cast<uint32_t>(registry.size() - 1);
+}
+
+
+const World::ComponentInfo& World::getComponentInfo(uint32_t id) noexcept
+{
+    return getRegistry()[id];
+}
+
+
+std::vector<World::ComponentInfo>& World::getRegistry() noexcept
+{
+    static std::vector<ComponentInfo> registry;
+
+    return registry;
+}
+
+
+World::Entity World::allocateEntity() noexcept
+{
+    uint32_t index;
+
+    if(m_freeRecords.empty())
+    {
+        index = static_cast<uint32_t>(m_records.size());
+        m_records.push_back({ NO_ARCHETYPE, 0, 0 });
+    }
+    else
+    {
+        index = m_freeRecords.back();
+        m_freeRecords.pop_back();
+    }
+
+    m_records[index].archetype = PENDING;
+    ++m_entityCount;
+
+    return { index, m_records[index].generation };
+}
+
+
+void World::releaseEntity(Entity entity) noexcept
+{
+    Record& record = m_records[entity.index];
+
+    record.archetype = NO_ARCHETYPE;
+    ++record.generation;
+
+    m_freeRecords.push_back(entity.index);
+    --m_entityCount;
+}
+
+
+uint32_t World::findArchetype(Mask mask) noexcept
+{
+    if(auto it = m_archetypeByMask.find(mask); it != m_archetypeByMask.end())
+        return it->second;
+
+    auto archetype = std::make_unique<Archetype>();
+
+    archetype->mask  = mask;
+    archetype->count = 0;
+    archetype->offsets.fill(NO_OFFSET);
+
+    size_t rowSize = sizeof(Entity);
+
+    for (Mask bits = mask; bits; bits &= bits - 1)
+    {
+        const auto id = static_cast<uint32_t>(std::countr_zero(bits));
+
+        archetype->components.push_back(id);
+        rowSize += getComponentInfo(id).size;
+    }
+
+//  As many rows as fit in a chunk once every array is aligned, a row larger than a chunk gets a chunk of its own
+    auto layout = [&archetype](uint32_t capacity) noexcept
+    {
+        size_t offset = sizeof(Entity) * capacity;
+
+        for (auto id : archetype->components)
+        {
+            const ComponentInfo& info = getComponentInfo(id);
+
+            offset = align_up(offset, info.alignment);
+            archetype->offsets[id] = static_cast<uint32_t>(offset);
+            offset += static_cast<size_t>(info.size) * capacity;
+        }
+
+        return offset;
+    };
+
+    uint32_t capacity = static_cast<uint32_t>(std::max<size_t>(CHUNK_SIZE / rowSize, 1));
+    size_t   size     = layout(capacity);
+
+    while (size > CHUNK_SIZE && capacity > 1)
+        size = layout(--capacity);
+
+    archetype->capacity  = capacity;
+    archetype->chunkSize = std::max<size_t>(size, 1);
+
+    const auto index = static_cast<uint32_t>(m_archetypes.size());
+
+    m_archetypes.push_back(std::move(archetype));
+    m_archetypeByMask.emplace(mask, index);
+
+    return index;
+}
+
+
+uint32_t World::allocateRow(Archetype& archetype, Entity entity) noexcept
+{
+    const uint32_t row   = archetype.count;
+    const uint32_t chunk = row / archetype.capacity;
+
+    if(chunk == archetype.chunks.size())
+    {
+        auto data = static_cast<std::byte*>(::operator new(archetype.chunkSize, std::align_val_t(CHUNK_ALIGNMENT), std::nothrow));
+
+        if(!data)
+            return UINT32_MAX;
+
+        archetype.chunks.push_back(data);
+    }
+
+    reinterpret_cast<Entity*>(archetype.chunks[chunk])[row % archetype.capacity] = entity;
+    ++archetype.count;
+
+    return row;
+}
+
+
+void World::removeRow(Archetype& archetype, uint32_t row) noexcept
+{
+    const uint32_t last = archetype.count - 1;
+
+    if(row != last)
+    {
+        const uint32_t chunk     = row / archetype.capacity,  slot     = row % archetype.capacity;
+        const uint32_t lastChunk = last / archetype.capacity, lastSlot = last % archetype.capacity;
+
+        const Entity moved = reinterpret_cast<const Entity*>(archetype.chunks[lastChunk])[lastSlot];
+        reinterpret_cast<Entity*>(archetype.chunks[chunk])[slot] = moved;
+
+        for (auto id : archetype.components)
+        {
+            const uint32_t size = getComponentInfo(id).size;
+
+            memcpy(getColumn(archetype, chunk, archetype.offsets[id]) + slot * size,
+                   getColumn(archetype, lastChunk, archetype.offsets[id]) + lastSlot * size, size);
+        }
+
+        m_records[moved.index].row = row;
+    }
+
+    --archetype.count;
+}
+
+
+bool World::migrate(Entity entity, Mask mask) noexcept
+{
+    const uint32_t target = findArchetype(mask);
+    const Record   record = m_records[entity.index];
+
+    if(record.archetype == target)
+        return true;
+
+    Archetype& to  = *m_archetypes[target];
+    const uint32_t row = allocateRow(to, entity);
+
+    if(row == UINT32_MAX)
+        return false;
+
+    if(record.archetype != PENDING)
+    {
+        Archetype& from = *m_archetypes[record.archetype];
+
+        const uint32_t fromChunk = record.row / from.capacity, fromSlot = record.row % from.capacity;
+        const uint32_t toChunk   = row / to.capacity,          toSlot   = row % to.capacity;
+
+        for (auto id : from.components)
+        {
+            if(to.offsets[id] == NO_OFFSET)
+                continue;
+
+            const uint32_t size = getComponentInfo(id).size;
+
+            memcpy(getColumn(to, toChunk, to.offsets[id]) + toSlot * size,
+                   getColumn(from, fromChunk, from.offsets[id]) + fromSlot * size, size);
+        }
+
+        removeRow(from, record.row);
+    }
+
+    m_records[entity.index].archetype = target;
+    m_records[entity.index].row       = row;
+
+    return true;
+}
+
+
+std::byte* World::getComponentData(Entity entity, uint32_t id) noexcept
+{
+    if(!isAlive(entity) || m_records[entity.index].archetype == PENDING)
+        return nullptr;
+
+    const Record&    record    = m_records[entity.index];
+    const Archetype& archetype = *m_archetypes[record.archetype];
+
+    if(archetype.offsets[id] == NO_OFFSET)
+        return nullptr;
+
+    return getColumn(archetype, record.row / archetype.capacity, archetype.offsets[id]) +
+           static_cast<size_t>(record.row % archetype.capacity) * getComponentInfo(id).size;
+}
+
+
+bool World::setComponent(Entity entity, uint32_t id, const void* data) noexcept
+{
+    if(!isAlive(entity) || m_records[entity.index].archetype == PENDING)
+        return false;
+
+    const Mask mask = m_archetypes[m_records[entity.index].archetype]->mask | (Mask(1) << id);
+
+    if(!migrate(entity, mask))
+        return false;
+
+    memcpy(getComponentData(entity, id), data, getComponentInfo(id).size);
+
+    return true;
+}
+
+
+void World::removeComponent(Entity entity, uint32_t id) noexcept
+{
+    if(!isAlive(entity) || m_records[entity.index].archetype == PENDING)
+        return;
+
+    const Mask mask = m_archetypes[m_records[entity.index].archetype]->mask & ~(Mask(1) << id);
+
+    migrate(entity, mask);
+}
+
+
+std::byte* World::getColumn(const Archetype& archetype, uint32_t chunk, uint32_t offset) noexcept
+{
+    return archetype.chunks[chunk] + offset;
+}
\ No newline at end of file
@@ -0,0 +1,310 @@
+#ifndef WORLD_HPP
+#define WORLD_HPP
+
+#include <array>
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <type_traits>
+#include <unordered_map>
+
+
+// Entity-component storage grouped by archetype, the set of component types an entity has.
+// An archetype keeps its entities in 16 KB chunks, each chunk holds one array per component type (structure of arrays),
+// so a query walks contiguous arrays chunk by chunk. Rows stay packed, removing one moves the archetype's last row into the hole.
+// Components must be trivially copyable with an alignment of at most 64, rows are moved with memcpy and never destructed.
+// Structural changes (create, destroy, add, remove) move rows and invalidate chunk pointers, so while systems run
+// they are queued with the *Deferred() calls and applied together by flush() once per frame.
+class World
+{
+public:
+    static constexpr uint32_t MAX_COMPONENTS = 64;
+    static constexpr size_t   CHUNK_SIZE     = 16 * 1024;
+
+    using Mask = uint64_t;
+
+    struct Entity
+    {
+        uint32_t index      = UINT32_MAX;
+        uint32_t generation = 0; // a destroyed entity's handle stops resolving once its slot is reused
+
+        bool operator==(const Entity&) const noexcept = default;
+    };
+
+    World() noexcept;
+    ~World();
+
+    World(const World&)            = delete;
+    World& operator=(const World&) = delete;
+
+    template <class C>
+    static uint32_t getComponentId() noexcept;
+
+    template <class... C>
+    static Mask getMask() noexcept;
+
+//  Immediate structural changes, not while a query runs. create() returns an invalid entity when a chunk cannot be allocated
+    template <class... C>
+    Entity create(const C&... components) noexcept;
+    void   destroy(Entity entity) noexcept;
+
+    template <class C>
+    bool add(Entity entity, const C& component) noexcept; // overwrites a component the entity already has
+
+    template <class C>
+    void remove(Entity entity) noexcept;
+
+//  Queued until flush(), a deferred entity is alive right away but has its components only after the flush
+    template <class... C>
+    Entity createDeferred(const C&... components) noexcept;
+    void   destroyDeferred(Entity entity) noexcept;
+
+    template <class C>
+    void addDeferred(Entity entity, const C& component) noexcept;
+
+    template <class C>
+    void removeDeferred(Entity entity) noexcept;
+
+    void flush() noexcept;
+
+    bool isAlive(Entity entity) const noexcept;
+
+    template <class C>
+    C* get(Entity entity) noexcept; // nullptr without the component
+
+//  f(count, const Entity* entities, C*... arrays) for every chunk whose archetype has all of C
+    template <class... C, class F>
+    void eachChunk(F&& f) noexcept;
+
+//  f(Entity, C&...) for every matching entity
+    template <class... C, class F>
+    void each(F&& f) noexcept;
+
+    template <class... C>
+    uint32_t count() const noexcept;
+
+    uint32_t getEntityCount()    const noexcept;
+    uint32_t getArchetypeCount() const noexcept;
+
+private:
+    static constexpr uint32_t NO_ARCHETYPE = UINT32_MAX;     // free slot
+    static constexpr uint32_t PENDING      = UINT32_MAX - 1; // created deferred, not placed yet
+    static constexpr uint32_t NO_OFFSET    = UINT32_MAX;
+
+    struct ComponentInfo
+    {
+        uint32_t size;
+        uint32_t alignment;
+    };
+
+    struct Archetype
+    {
+        Mask                                  mask;
+        std::vector<uint32_t>                 components; // ids present
+        std::array<uint32_t, MAX_COMPONENTS>  offsets;    // of each component's array in a chunk, NO_OFFSET when absent
+        uint32_t                              capacity;   // rows per chunk
+        size_t                                chunkSize;
+        std::vector<std::byte*>               chunks;     // all in use are full but the last, emptied ones are kept for reuse
+        uint32_t                              count;      // rows over all chunks, entities sit at the start of every chunk
+    };
+
+    struct Record
+    {
+        uint32_t archetype;
+        uint32_t row;
+        uint32_t generation;
+    };
+
+    enum class CommandType : uint8_t
+    {
+        Create,
+        Destroy,
+        Add,
+        Remove
+    };
+
+//  Component values follow in m_commandData at data, each as its id followed by its bytes
+    struct Command
+    {
+        CommandType type;
+        Entity      entity;
+        Mask        mask;
+        size_t      data;
+        uint32_t    count; // of component values
+    };
+
+    static uint32_t registerComponent(uint32_t size, uint32_t alignment) noexcept;
+    static const ComponentInfo& getComponentInfo(uint32_t id) noexcept;
+    static std::vector<ComponentInfo>& getRegistry() noexcept; // shared by every world, ids are the same in all of them
+
+    Entity     allocateEntity() noexcept; // alive but not placed in an archetype yet
+    void       releaseEntity(Entity entity) noexcept;
+    uint32_t   findArchetype(Mask mask) noexcept;
+    uint32_t   allocateRow(Archetype& archetype, Entity entity) noexcept; // UINT32_MAX when out of memory
+    void       removeRow(Archetype& archetype, uint32_t row) noexcept;
+    bool       migrate(Entity entity, Mask mask) noexcept; // moves the entity's row to the archetype of mask, keeping shared components
+    std::byte* getComponentData(Entity entity, uint32_t id) noexcept;
+    bool       setComponent(Entity entity, uint32_t id, const void* data) noexcept;
+    void       removeComponent(Entity entity, uint32_t id) noexcept;
+
+    template <class C>
+    void pushCommandData(const C& component) noexcept;
+
+    static std::byte* getColumn(const Archetype& archetype, uint32_t chunk, uint32_t offset) noexcept;
+
+    std::vector<std::unique_ptr<Archetype>> m_archetypes;
+    std::unordered_map<Mask, uint32_t>      m_archetypeByMask;
+
+    std::vector<Record>   m_records;
+    std::vector<uint32_t> m_freeRecords;
+    uint32_t              m_entityCount;
+
+    std::vector<Command>   m_commands;
+    std::vector<std::byte> m_commandData;
+};
+
+
+template <class C>
+uint32_t World::getComponentId() noexcept
+{
+    static_assert(std::is_trivially_copyable_v<C>, "components are moved with memcpy");
+
+    static const uint32_t id = registerComponent(sizeof(C), alignof(C));
+
+    return id;
+}
+
+
+template <class... C>
+World::Mask World::getMask() noexcept
+{
+    return (Mask(0) | ... | (Mask(1) << getComponentId<C>()));
+}
+
+
+template <class... C>
+World::Entity World::create(const C&... components) noexcept
+{
+    const Entity entity = allocateEntity();
+
+    if(!migrate(entity, getMask<C...>()))
+    {
+        releaseEntity(entity);
+        return {};
+    }
+
+    (memcpy(getComponentData(entity, getComponentId<C>()), &components, sizeof(C)), ...);
+
+    return entity;
+}
+
+
+template <class C>
+bool World::add(Entity entity, const C& component) noexcept
+{
+    return setComponent(entity, getComponentId<C>(), &component);
+}
+
+
+template <class C>
+void World::remove(Entity entity) noexcept
+{
+    removeComponent(entity, getComponentId<C>());
+}
+
+
+template <class... C>
+World::Entity World::createDeferred(const C&... components) noexcept
+{
+    const Entity entity = allocateEntity();
+
+    m_commands.push_back({ CommandType::Create, entity, getMask<C...>(), m_commandData.size(), sizeof...(C) });
+    (pushCommandData(components), ...);
+
+    return entity;
+}
+
+
+template <class C>
+void World::addDeferred(Entity entity, const C& component) noexcept
+{
+    m_commands.push_back({ CommandType::Add, entity, getMask<C>(), m_commandData.size(), 1 });
+    pushCommandData(component);
+}
+
+
+template <class C>
+void World::removeDeferred(Entity entity) noexcept
+{
+    m_commands.push_back({ CommandType::Remove, entity, getMask<C>(), 0, 0 });
+}
+
+
+template <class C>
+void World::pushCommandData(const C& component) noexcept
+{
+    const uint32_t id     = getComponentId<C>();
+    const size_t   offset = m_commandData.size();
+
+    m_commandData.resize(offset + sizeof(id) + sizeof(C));
+    memcpy(m_commandData.data() + offset, &id, sizeof(id));
+    memcpy(m_commandData.data() + offset + sizeof(id), &component, sizeof(C));
+}
+
+
+template <class C>
+C* World::get(Entity entity) noexcept
+{
+    return reinterpret_cast<C*>(getComponentData(entity, getComponentId<C>()));
+}
+
+
+template <class... C, class F>
+void World::eachChunk(F&& f) noexcept
+{
+    const Mask required = getMask<C...>();
+
+    for (const auto& archetype : m_archetypes)
+    {
+        if((archetype->mask & required) != required)
+            continue;
+
+        for (uint32_t chunk = 0; chunk * archetype->capacity < archetype->count; ++chunk)
+        {
+            const uint32_t count = std::min(archetype->capacity, archetype->count - chunk * archetype->capacity);
+
+            f(count, reinterpret_cast<const Entity*>(archetype->chunks[chunk]),
+              reinterpret_cast<C*>(getColumn(*archetype, chunk, archetype->offsets[getComponentId<C>()]))...);
+        }
+    }
+}
+
+
+template <class... C, class F>
+void World::each(F&& f) noexcept
+{
+    eachChunk<C...>([&f](uint32_t count, const Entity* entities, C*... components)
+    {
+        for (uint32_t i = 0; i < count; ++i)
+            f(entities[i], components[i]...);
+    });
+}
+
+
+template <class... C>
+uint32_t World::count() const noexcept
+{
+    const Mask required = getMask<C...>();
+    uint32_t   total    = 0;
+
+    for (const auto& archetype : m_archetypes)
+        if((archetype->mask & required) == required)
+            total += archetype->count;
+
+    return total;
+}
+
+#endif // !WORLD_HPP
\ No newline at end of file
@@ -0,0 +1,21 @@
+// Shared by cluster_task.task and cluster_mesh.mesh, the push constants must match MeshDrawConstants in Application.cpp
+
+layout(push_constant) uniform constants 
+{
+    mat4 modelViewProjection;
+    vec4 cameraPosition; // object space
+    uint clusterOffset;  // words into the cluster buffer
+    uint firstMeshlet;   // level of detail in the cluster blob
+    uint meshletCount;
+    int  vertexOffset;
+} draw;
+
+layout(binding = 2) readonly buffer Clusters { uint clusters[]; };
+
+// Meshlet record layout, see MeshOptimizer::Meshlet
+const uint MESHLET_WORDS = 12;
+
+struct ClusterPayload
+{
+    uint meshlets[32];
+};
\ No newline at end of file
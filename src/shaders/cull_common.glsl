@@ -0,0 +1,70 @@
+// Sphere tests shared by the culling shaders.
+// The including shader declares the push constant block "cull" (projection = P00, |P11|, P22, P32, znear, zfar, pyramidWidth, pyramidHeight)
+// and the depth pyramid sampler before the include.
+
+// center is in view space with +Z pointing forward
+bool isInsideFrustum(vec3 center, float radius)
+{
+    const float P00 = cull.projection.x;
+    const float P11 = cull.projection.y;
+
+    bool visible = center.z + radius > cull.znear && center.z - radius < cull.zfar;
+    visible = visible && (P00 * abs(center.x) - center.z) * inversesqrt(P00 * P00 + 1.f) < radius;
+    visible = visible && (P11 * abs(center.y) - center.z) * inversesqrt(P11 * P11 + 1.f) < radius;
+
+    return visible;
+}
+
+
+// 2D Polyhedral Bounds of a Clipped, Perspective-Projected 3D Sphere. Michael Mara, Morgan McGuire. 2013
+bool projectSphere(vec3 center, float radius, out vec4 aabb)
+{
+    if (center.z < radius + cull.znear)
+        return false;
+
+    const vec3 cr = center * radius;
+    const float czr2 = center.z * center.z - radius * radius;
+
+    const float vx = sqrt(center.x * center.x + czr2);
+    const float minx = (vx * center.x - cr.z) / (vx * center.z + cr.x);
+    const float maxx = (vx * center.x + cr.z) / (vx * center.z - cr.x);
+
+    const float vy = sqrt(center.y * center.y + czr2);
+    const float miny = (vy * center.y - cr.z) / (vy * center.z + cr.y);
+    const float maxy = (vy * center.y + cr.z) / (vy * center.z - cr.y);
+
+    aabb = vec4(minx * cull.projection.x, miny * cull.projection.y, maxx * cull.projection.x, maxy * cull.projection.y);
+    aabb = aabb.xwzy * vec4(0.5f, -0.5f, 0.5f, -0.5f) + vec4(0.5f); // clip space -> uv space
+
+    return true;
+}
+
+
+bool isOccluded(vec3 center, float radius)
+{
+    vec4 aabb;
+
+    if (!projectSphere(center, radius, aabb))
+        return false; // the sphere intersects the near plane
+
+    aabb = clamp(aabb, 0.f, 1.f);
+
+    const float width  = (aabb.z - aabb.x) * cull.pyramidWidth;
+    const float height = (aabb.w - aabb.y) * cull.pyramidHeight;
+
+//  On this level the rectangle spans at most 2x2 texels
+    const int level = clamp(int(ceil(log2(max(max(width, height), 1.f)))), 0, textureQueryLevels(depthPyramid) - 1);
+    const ivec2 size = textureSize(depthPyramid, level);
+    const ivec2 p0 = clamp(ivec2(aabb.xy * vec2(size)), ivec2(0), size - 1);
+    const ivec2 p1 = clamp(ivec2(aabb.zw * vec2(size)), ivec2(0), size - 1);
+
+    const float depth = max(
+        max(texelFetch(depthPyramid, p0, level).x, texelFetch(depthPyramid, ivec2(p1.x, p0.y), level).x),
+        max(texelFetch(depthPyramid, ivec2(p0.x, p1.y), level).x, texelFetch(depthPyramid, p1, level).x));
+
+//  Depth of the sphere point nearest to the camera
+    const float z = center.z - radius;
+    const float sphereDepth = (cull.projection.z * -z + cull.projection.w) / z;
+
+    return sphereDepth > depth;
+}
\ No newline at end of file
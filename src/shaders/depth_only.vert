@@ -0,0 +1,21 @@
+#version 460
+
+layout(push_constant) uniform constants 
+{
+    mat4 viewProjection;
+} camera;
+
+// written by InstanceBuffer, firstInstance of every draw is the object index
+layout(std430, binding = 1) readonly buffer Instances
+{
+    mat4 models[];
+};
+
+layout(location = 0) in vec3 inPosition;
+
+invariant gl_Position;
+
+void main() 
+{
+    gl_Position = camera.viewProjection * (models[gl_InstanceIndex] * vec4(inPosition, 1.f));
+}
\ No newline at end of file
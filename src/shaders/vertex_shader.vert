@@ -2,16 +2,25 @@
 
 layout(push_constant) uniform constants 
 {
-    mat4 modelViewProjection;
-} matrices;
+    mat4 viewProjection;
+} camera;
+
+// written by InstanceBuffer, firstInstance of every draw is the object index
+layout(std430, binding = 1) readonly buffer Instances
+{
+    mat4 models[];
+};
 
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec2 inTexCoord;
 
 layout(location = 0) out vec2 fragTexCoord;
 
+// must match depth_only.vert bit for bit, the color pass tests depth with EQUAL after the pre-pass
+invariant gl_Position;
+
 void main() 
 {
-    gl_Position = matrices.modelViewProjection * vec4(inPosition, 1.f);
+    gl_Position = camera.viewProjection * (models[gl_InstanceIndex] * vec4(inPosition, 1.f));
     fragTexCoord = inTexCoord;
 }
\ No newline at end of file
@@ -6,13 +6,14 @@
 CommandBufferPool::CommandBufferPool() noexcept:
     handle(nullptr)
 {
-    for(auto& buffer : commandBuffers)
-        buffer = nullptr;
+
 }
 
 
-bool CommandBufferPool::create(VkDevice device, uint32_t queueFamilyIndex) noexcept
+bool CommandBufferPool::create(VkDevice device, uint32_t queueFamilyIndex, uint32_t bufferCount) noexcept
 {
+    commandBuffers.assign(bufferCount, nullptr);
+
     VkCommandPoolCreateInfo poolInfo = {};
     poolInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
     poolInfo.flags            = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
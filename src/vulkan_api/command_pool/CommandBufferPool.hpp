@@ -1,22 +1,20 @@
 #ifndef COMMAND_BUFFER_POOL_HPP
 #define COMMAND_BUFFER_POOL_HPP
 
-#include <array>
+#include <vector>
 
 #include <vulkan/vulkan.h>
 
-#include "vulkan_api/utils/Defines.hpp"
-
 class CommandBufferPool
 {
 public:
     CommandBufferPool() noexcept;
 
-    bool create(VkDevice device, uint32_t queueFamilyIndex) noexcept;
+    bool create(VkDevice device, uint32_t queueFamilyIndex, uint32_t bufferCount) noexcept;
     void destroy(VkDevice device) noexcept;
 
     VkCommandPool handle;
-    std::array<VkCommandBuffer, MAX_FRAMES_IN_FLIGHT> commandBuffers;
+    std::vector<VkCommandBuffer> commandBuffers; // one per frame in flight
 };
 
 #endif // !COMMAND_BUFFER_POOL_HPP
\ No newline at end of file
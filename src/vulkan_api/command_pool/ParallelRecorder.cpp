@@ -0,0 +1,211 @@
+#include <algorithm>
+
+#include "vulkan_api/utils/Helpers.hpp"
+#include "vulkan_api/context/VulkanContext.hpp"
+#include "vulkan_api/presentation/MainView.hpp"
+#include "vulkan_api/render/Render.hpp"
+#include "vulkan_api/command_pool/ParallelRecorder.hpp"
+
+
+// Splitting below this many draws per range costs more than it saves
+static constexpr uint32_t MIN_DRAWS_PER_RANGE = 16;
+
+// record() calls per frame the buffer lists are sized for (pre-pass and color pass, early and late phase), more only grow them once
+static constexpr uint32_t RECORDS_PER_FRAME = 8;
+
+
+ParallelRecorder::ParallelRecorder() noexcept:
+    m_device(nullptr),
+    m_depthFormat(VK_FORMAT_UNDEFINED),
+    m_jobs(nullptr)
+{
+
+}
+
+
+ParallelRecorder::~ParallelRecorder()
+{
+    destroy();
+}
+
+
+bool ParallelRecorder::create(const MainView& view, JobSystem& jobs, uint32_t maxRanges, uint32_t framesInFlight) noexcept
+{
+    auto context  = view.getContext();
+    m_device      = context->getDevice();
+    m_depthFormat = vk::findDepthFormat(context->getPhysicalDevice());
+    m_jobs        = &jobs;
+
+//  More ranges than threads would only add secondaries
+    const uint32_t rangeCount = std::clamp(jobs.getThreadCount(), 1U, std::max(maxRanges, 1U));
+
+    framesInFlight = std::max(framesInFlight, 1U);
+    m_slots.resize(rangeCount);
+    m_recorded.resize(rangeCount);
+
+    for (auto& data : m_slots)
+    {
+        data.pools.assign(framesInFlight, nullptr);
+        data.buffers.resize(framesInFlight);
+        data.used.assign(framesInFlight, 0);
+
+        for (auto& buffers : data.buffers)
+            buffers.reserve(RECORDS_PER_FRAME);
+    }
+
+    const VkCommandPoolCreateInfo poolInfo = 
+    {
+        .sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+        .pNext            = nullptr,
+        .flags            = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+        .queueFamilyIndex = context->getMainQueueFamilyIndex()
+    };
+
+    for (auto& data : m_slots)
+        for (auto& pool : data.pools)
+            if (vkCreateCommandPool(m_device, &poolInfo, nullptr, &pool) != VK_SUCCESS)
+                return false;
+
+    return true;
+}
+
+
+void ParallelRecorder::destroy() noexcept
+{
+//  Destroying a pool frees every buffer allocated from it
+    for (auto& data : m_slots)
+        for (auto pool : data.pools)
+            if(pool)
+                vkDestroyCommandPool(m_device, pool, nullptr);
+
+    m_slots.clear();
+    m_recorded.clear();
+    m_jobs = nullptr;
+}
+
+
+VkResult ParallelRecorder::resetFrame(uint32_t frame) noexcept
+{
+    for (auto& data : m_slots)
+    {
+        if (auto result = vkResetCommandPool(m_device, data.pools[frame], 0); result != VK_SUCCESS)
+            return result;
+
+        data.used[frame] = 0;
+    }
+
+    return VK_SUCCESS;
+}
+
+
+void ParallelRecorder::record(VkCommandBuffer primary, uint32_t frame, const MainView& view, const VkExtent2D& extent, uint32_t drawCount,
+                              const void* function, RecordFunction recordRange) noexcept
+{
+    if(drawCount == 0)
+        return;
+
+    const uint32_t slotCount  = static_cast<uint32_t>(m_slots.size());
+    const uint32_t usedRanges = std::clamp((drawCount + MIN_DRAWS_PER_RANGE - 1) / MIN_DRAWS_PER_RANGE, 1U, slotCount);
+    const uint32_t rangeSize  = (drawCount + usedRanges - 1) / usedRanges;
+
+    const VkFormat colorFormat = view.getFormat();
+
+    const VkCommandBufferInheritanceRenderingInfo renderingInfo = 
+    {
+        .sType                   = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO,
+        .pNext                   = nullptr,
+        .flags                   = 0,
+        .viewMask                = 0,
+        .colorAttachmentCount    = 1,
+        .pColorAttachmentFormats = &colorFormat,
+        .depthAttachmentFormat   = m_depthFormat,
+        .stencilAttachmentFormat = VK_FORMAT_UNDEFINED,
+        .rasterizationSamples    = VK_SAMPLE_COUNT_1_BIT
+    };
+
+    const VkCommandBufferInheritanceInfo inheritanceInfo = 
+    {
+        .sType                = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+        .pNext                = &renderingInfo,
+        .renderPass           = nullptr,
+        .subpass              = 0,
+        .framebuffer          = nullptr,
+        .occlusionQueryEnable = VK_FALSE,
+        .queryFlags           = 0,
+        .pipelineStatistics   = 0
+    };
+
+    const VkCommandBufferBeginInfo beginInfo = 
+    {
+        .sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .pNext            = nullptr,
+        .flags            = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT,
+        .pInheritanceInfo = &inheritanceInfo
+    };
+
+//  Range i records into slot i, whichever thread picks it up
+    const auto task = [&](uint32_t first, uint32_t last, uint32_t slot)
+    {
+        VkCommandBuffer cmd = acquire(slot, frame);
+        m_recorded[slot] = cmd;
+
+        if(!cmd || vkBeginCommandBuffer(cmd, &beginInfo) != VK_SUCCESS)
+        {
+            m_recorded[slot] = nullptr;
+            return;
+        }
+
+    //  Dynamic state is not inherited from the primary
+        Render::setViewport(cmd, extent);
+        recordRange(function, cmd, first, last);
+
+        if(vkEndCommandBuffer(cmd) != VK_SUCCESS)
+            m_recorded[slot] = nullptr;
+    };
+
+    std::fill(m_recorded.begin(), m_recorded.end(), nullptr);
+
+    m_jobs->parallelFor(drawCount, rangeSize, task);
+
+//  Ranges are executed in draw list order
+    auto last = std::remove(m_recorded.begin(), m_recorded.end(), nullptr);
+    const uint32_t count = static_cast<uint32_t>(std::distance(m_recorded.begin(), last));
+
+    if(count)
+        vkCmdExecuteCommands(primary, count, m_recorded.data());
+}
+
+
+uint32_t ParallelRecorder::getRangeCount() const noexcept
+{
+    return static_cast<uint32_t>(m_slots.size());
+}
+
+
+VkCommandBuffer ParallelRecorder::acquire(uint32_t slot, uint32_t frame) noexcept
+{
+    auto& data    = m_slots[slot];
+    auto& buffers = data.buffers[frame];
+    auto& used    = data.used[frame];
+
+    if(used == buffers.size())
+    {
+        const VkCommandBufferAllocateInfo allocInfo = 
+        {
+            .sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+            .pNext              = nullptr,
+            .commandPool        = data.pools[frame],
+            .level              = VK_COMMAND_BUFFER_LEVEL_SECONDARY,
+            .commandBufferCount = 1
+        };
+
+        VkCommandBuffer cmd = nullptr;
+
+        if(vkAllocateCommandBuffers(m_device, &allocInfo, &cmd) != VK_SUCCESS)
+            return nullptr;
+
+        buffers.push_back(cmd);
+    }
+
+    return buffers[used++];
+}
\ No newline at end of file
@@ -0,0 +1,65 @@
+#ifndef PARALLEL_RECORDER_HPP
+#define PARALLEL_RECORDER_HPP
+
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "core/JobSystem.hpp"
+
+
+// Records disjoint ranges of a draw list into secondary command buffers as jobs of the engine's JobSystem.
+// Every range slot owns one command pool per frame in flight and only one job records a slot at a time, 
+// so recording needs no locking and the pools are reset wholesale once the frame's timeline value has been reached.
+// The primary must be inside a rendering instance begun with VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT.
+class ParallelRecorder
+{
+public:
+    ParallelRecorder() noexcept;
+    ~ParallelRecorder();
+
+    bool create(const class MainView& view, JobSystem& jobs, uint32_t maxRanges, uint32_t framesInFlight) noexcept;
+    void destroy() noexcept;
+
+    VkResult resetFrame(uint32_t frame) noexcept;
+
+//  recordRange(cmd, first, last) is called by reference, so capturing lambdas cost no allocation
+    template <class F>
+    void record(VkCommandBuffer primary, uint32_t frame, const class MainView& view, const VkExtent2D& extent, uint32_t drawCount, const F& recordRange) noexcept;
+
+    uint32_t getRangeCount() const noexcept;
+
+private:
+    using RecordFunction = void(*)(const void* function, VkCommandBuffer cmd, uint32_t first, uint32_t last);
+
+    void record(VkCommandBuffer primary, uint32_t frame, const class MainView& view, const VkExtent2D& extent, uint32_t drawCount,
+                const void* function, RecordFunction recordRange) noexcept;
+
+    struct SlotData
+    {
+        std::vector<VkCommandPool>                pools;   // indexed by frame
+        std::vector<std::vector<VkCommandBuffer>> buffers;
+        std::vector<uint32_t>                     used;
+    };
+
+    VkCommandBuffer acquire(uint32_t slot, uint32_t frame) noexcept;
+
+    VkDevice   m_device;
+    VkFormat   m_depthFormat;
+    JobSystem* m_jobs;
+
+    std::vector<SlotData>        m_slots;
+    std::vector<VkCommandBuffer> m_recorded;
+};
+
+
+template <class F>
+void ParallelRecorder::record(VkCommandBuffer primary, uint32_t frame, const MainView& view, const VkExtent2D& extent, uint32_t drawCount, const F& recordRange) noexcept
+{
+    record(primary, frame, view, extent, drawCount, &recordRange, [](const void* function, VkCommandBuffer cmd, uint32_t first, uint32_t last)
+    {
+        (*static_cast<const F*>(function))(cmd, first, last);
+    });
+}
+
+#endif // !PARALLEL_RECORDER_HPP
\ No newline at end of file
@@ -11,6 +11,9 @@
 
 namespace
 {
+//  Driver queries of setup code: surface formats, present modes and the like
+    constexpr size_t SCRATCH_ARENA_SIZE = 64 * 1024;
+
 #ifdef DEBUG
     constexpr std::array<const char*, 1> VALIDATION_LAYERS = 
     {
@@ -53,7 +56,10 @@ VulkanContext::VulkanContext() noexcept:
     m_physicalDevice(nullptr),
     m_device(nullptr),
     m_queue(nullptr),
-    m_mainQueueFamilyIndex(0)
+    m_mainQueueFamilyIndex(0),
+    m_presentWait(false),
+    m_meshShader(false),
+    m_indirectFirstInstance(false)
 {
 
 }
@@ -64,6 +70,9 @@ VulkanContext::~VulkanContext() = default;
 
 VkResult VulkanContext::initialize() noexcept
 {
+    if(!m_scratch.create(SCRATCH_ARENA_SIZE))
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+
     if(createInstance() == VK_SUCCESS)
         if(selectVideoCard() == VK_SUCCESS)
             if(createDevice() == VK_SUCCESS)
@@ -75,8 +84,10 @@ VkResult VulkanContext::initialize() noexcept
 
 void VulkanContext::destroy() noexcept
 {
+    m_deletionQueue.destroy();
     vkDestroyDevice(m_device, VK_NULL_HANDLE);
     vkDestroyInstance(m_instance, VK_NULL_HANDLE);
+    m_scratch.destroy();
 }
 
 
@@ -110,6 +121,36 @@ uint32_t VulkanContext::getMainQueueFamilyIndex() const noexcept
 }
 
 
+bool VulkanContext::isPresentWaitSupported() const noexcept
+{
+    return m_presentWait;
+}
+
+
+bool VulkanContext::isMeshShaderSupported() const noexcept
+{
+    return m_meshShader;
+}
+
+
+bool VulkanContext::isIndirectFirstInstanceSupported() const noexcept
+{
+    return m_indirectFirstInstance;
+}
+
+
+DeletionQueue& VulkanContext::getDeletionQueue() noexcept
+{
+    return m_deletionQueue;
+}
+
+
+LinearAllocator& VulkanContext::getScratchAllocator() noexcept
+{
+    return m_scratch;
+}
+
+
 VkResult VulkanContext::createInstance() noexcept
 {
 #ifdef DEBUG
@@ -250,6 +291,11 @@ VkResult VulkanContext::createDevice() noexcept
     if (supportedFeatures.fillModeNonSolid)
         enabledFeatures.fillModeNonSolid = VK_TRUE;
 
+    if (supportedFeatures.drawIndirectFirstInstance)
+        enabledFeatures.drawIndirectFirstInstance = VK_TRUE;
+
+    m_indirectFirstInstance = supportedFeatures.drawIndirectFirstInstance;
+
     {// Find main queue family index
         uint32_t queueFamilyCount;
         vkGetPhysicalDeviceQueueFamilyProperties(m_physicalDevice, &queueFamilyCount, nullptr);
@@ -302,23 +348,82 @@ VkResult VulkanContext::createDevice() noexcept
             if(deviceExtensions.find(extension) == deviceExtensions.end())
                 return VK_ERROR_INITIALIZATION_FAILED;
 
-        constexpr VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamic_rendering_feature = 
+        std::vector<const char*> enabledExtensions(requiredExtensions.begin(), requiredExtensions.end());
+
+    //  Optional: present id/wait drive the low-latency mode
+        VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures = {};
+        presentWaitFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+
+        VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures = {};
+        presentIdFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+        presentIdFeatures.pNext = &presentWaitFeatures;
+
+        if (deviceExtensions.contains(VK_KHR_PRESENT_ID_EXTENSION_NAME) && deviceExtensions.contains(VK_KHR_PRESENT_WAIT_EXTENSION_NAME))
         {
-            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR,
-            .dynamicRendering = VK_TRUE
-        };
+            VkPhysicalDeviceFeatures2 features2 = {};
+            features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+            features2.pNext = &presentIdFeatures;
+
+            vkGetPhysicalDeviceFeatures2(m_physicalDevice, &features2);
+
+            m_presentWait = presentIdFeatures.presentId && presentWaitFeatures.presentWait;
+        }
+
+        if (m_presentWait)
+        {
+            enabledExtensions.push_back(VK_KHR_PRESENT_ID_EXTENSION_NAME);
+            enabledExtensions.push_back(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+        }
+
+    //  Optional: task and mesh shaders for the mesh shading path
+        VkPhysicalDeviceMeshShaderFeaturesEXT meshShaderFeatures = {};
+        meshShaderFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MESH_SHADER_FEATURES_EXT;
+
+        if (deviceExtensions.contains(VK_EXT_MESH_SHADER_EXTENSION_NAME))
+        {
+            VkPhysicalDeviceFeatures2 features2 = {};
+            features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+            features2.pNext = &meshShaderFeatures;
+
+            vkGetPhysicalDeviceFeatures2(m_physicalDevice, &features2);
+
+            m_meshShader = meshShaderFeatures.taskShader && meshShaderFeatures.meshShader;
+        }
+
+        if (m_meshShader)
+        {
+            enabledExtensions.push_back(VK_EXT_MESH_SHADER_EXTENSION_NAME);
+
+        //  Only what the path uses, the rest would need further features (multiview, shading rate, queries)
+            meshShaderFeatures = {};
+            meshShaderFeatures.sType      = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MESH_SHADER_FEATURES_EXT;
+            meshShaderFeatures.pNext      = m_presentWait ? &presentIdFeatures : nullptr;
+            meshShaderFeatures.taskShader = VK_TRUE;
+            meshShaderFeatures.meshShader = VK_TRUE;
+        }
+
+        VkPhysicalDeviceVulkan12Features vulkan12Features = {};
+        vulkan12Features.sType             = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+        vulkan12Features.timelineSemaphore = VK_TRUE; // frame and upload tracking in SyncManager
+        vulkan12Features.pNext             = m_meshShader ? static_cast<void*>(&meshShaderFeatures) : (m_presentWait ? static_cast<void*>(&presentIdFeatures) : nullptr);
+
+        VkPhysicalDeviceVulkan13Features vulkan13Features = {};
+        vulkan13Features.sType            = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+        vulkan13Features.pNext            = &vulkan12Features;
+        vulkan13Features.synchronization2 = VK_TRUE; // vkCmdPipelineBarrier2 in the render graph
+        vulkan13Features.dynamicRendering = VK_TRUE;
 
         VkDeviceCreateInfo deviceInfo = 
         {
             .sType                   = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
-            .pNext                   = &dynamic_rendering_feature,
+            .pNext                   = &vulkan13Features,
             .flags                   = 0,
             .queueCreateInfoCount    = 1,
             .pQueueCreateInfos       = &queueInfo,
             .enabledLayerCount       = 0,
             .ppEnabledLayerNames     = nullptr,
-            .enabledExtensionCount   = static_cast<uint32_t>(requiredExtensions.size()),
-            .ppEnabledExtensionNames = requiredExtensions.data(),
+            .enabledExtensionCount   = static_cast<uint32_t>(enabledExtensions.size()),
+            .ppEnabledExtensionNames = enabledExtensions.data(),
             .pEnabledFeatures        = &enabledFeatures
         };
 #ifdef DEBUG
@@ -329,6 +434,7 @@ VkResult VulkanContext::createDevice() noexcept
         if(vkCreateDevice(m_physicalDevice, &deviceInfo, nullptr, &m_device) == VK_SUCCESS)
         {
             vkGetDeviceQueue(m_device, m_mainQueueFamilyIndex, 0, &m_queue);
+            m_deletionQueue.create(m_device);
 
             return VK_SUCCESS;
         }
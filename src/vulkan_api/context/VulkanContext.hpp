@@ -3,6 +3,9 @@
 
 #include <vulkan/vulkan.h>
 
+#include "core/LinearAllocator.hpp"
+#include "vulkan_api/resources/DeletionQueue.hpp"
+
 
 class VulkanContext
 {
@@ -18,6 +21,11 @@ public:
     VkDevice         getDevice()               const noexcept;
     VkQueue          getQueue()                const noexcept;
     uint32_t         getMainQueueFamilyIndex() const noexcept;
+    bool             isPresentWaitSupported()  const noexcept; // VK_KHR_present_id and VK_KHR_present_wait are enabled
+    bool             isMeshShaderSupported()   const noexcept; // VK_EXT_mesh_shader is enabled with task and mesh shaders
+    bool             isIndirectFirstInstanceSupported() const noexcept; // indirect draws may start past instance 0
+    DeletionQueue&   getDeletionQueue()              noexcept;
+    LinearAllocator& getScratchAllocator()           noexcept; // setup code on one thread at a time, every user rewinds it with a LinearAllocator::Scope
 
 private:
     VkResult createInstance()  noexcept;
@@ -29,6 +37,11 @@ private:
     VkDevice         m_device;
     VkQueue          m_queue;
     uint32_t         m_mainQueueFamilyIndex;
+    bool             m_presentWait;
+    bool             m_meshShader;
+    bool             m_indirectFirstInstance;
+    DeletionQueue    m_deletionQueue;
+    LinearAllocator  m_scratch;
 };
 
 #endif // !VULKAN_CONTEXT_HPP
\ No newline at end of file
@@ -0,0 +1,393 @@
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+#include "vulkan_api/utils/Helpers.hpp"
+#include "vulkan_api/context/VulkanContext.hpp"
+#include "vulkan_api/culling/ClusterCuller.hpp"
+
+
+namespace
+{
+    struct CullConstants
+    {
+        mat4s    view;
+        float    projection[4];
+        float    cameraPosition[4];
+        float    znear;
+        float    zfar;
+        float    pyramidWidth;
+        float    pyramidHeight;
+        uint32_t instanceCount;
+        uint32_t late;
+    };
+
+    void fill_commands(VkCommandBuffer cmd, VkBuffer commands, VkBuffer visibility) noexcept
+    {
+        vkCmdFillBuffer(cmd, commands, 0, VK_WHOLE_SIZE, 0);
+
+        if(visibility)
+            vkCmdFillBuffer(cmd, visibility, 0, VK_WHOLE_SIZE, 0);
+
+        const VkMemoryBarrier fillBarrier = 
+        {
+            .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+            .pNext         = nullptr,
+            .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT
+        };
+
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &fillBarrier, 0, nullptr, 0, nullptr);
+    }
+}
+
+
+
+ClusterCuller::ClusterCuller() noexcept:
+    m_GPU(nullptr),
+    m_device(nullptr),
+    m_clusterBuffer(nullptr),
+    m_pyramidExtent({}),
+    m_maxInstances(0),
+    m_maxClusters(0),
+    m_maxIndices(0),
+    m_resetVisibility(true)
+{
+
+}
+
+
+VkResult ClusterCuller::create(const VulkanContext& context, VkBuffer clusterBuffer, const OcclusionCuller& occlusion, 
+                               uint32_t maxInstances, uint32_t maxClusters, uint32_t maxIndices, uint32_t framesInFlight) noexcept
+{
+    if(!clusterBuffer)
+        return VK_ERROR_INITIALIZATION_FAILED;
+
+    m_GPU           = context.getPhysicalDevice();
+    m_device        = context.getDevice();
+    m_clusterBuffer = clusterBuffer;
+    m_maxInstances  = std::max(maxInstances, 1U);
+    m_maxClusters   = std::max(maxClusters, 1U);
+    m_maxIndices    = std::max(maxIndices, 1U);
+
+    framesInFlight = std::max(framesInFlight, 1U);
+    m_instances.assign(framesInFlight, {});
+    m_mappedInstances.assign(framesInFlight, nullptr);
+    m_instanceCounts.assign(framesInFlight, 0);
+    m_meshletMax.assign(framesInFlight, 0);
+    m_descriptorSets.assign(framesInFlight * 2, nullptr);
+
+    {// Pipeline
+        ShaderStage cullShader;
+
+        if(cullShader.loadFromFile(m_device, VK_SHADER_STAGE_COMPUTE_BIT, "res/shaders/cluster_cull.spv") != VK_SUCCESS)
+            return VK_ERROR_INITIALIZATION_FAILED;
+
+        DescriptorSetLayout cullDescriptors;
+        cullDescriptors.addDescriptor(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT); // instances
+        cullDescriptors.addDescriptor(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT); // clusters
+        cullDescriptors.addDescriptor(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT); // visibility
+        cullDescriptors.addDescriptor(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT); // commands of the phase
+        cullDescriptors.addDescriptor(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT); // indices of the phase
+        cullDescriptors.addDescriptor(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT); // depth pyramid
+
+        const VkResult result = m_cullPipeline.create(m_device, cullShader, cullDescriptors, sizeof(CullConstants));
+
+        cullShader.destroy(m_device);
+
+        if(result != VK_SUCCESS)
+            return result;
+    }
+
+    {// Buffers
+        const VkDeviceSize instancesSize = sizeof(GpuInstance) * m_maxInstances;
+        const VkDeviceSize commandsSize  = sizeof(VkDrawIndexedIndirectCommand) * m_maxInstances;
+        const VkDeviceSize indicesSize   = sizeof(uint32_t) * static_cast<VkDeviceSize>(m_maxIndices);
+
+        for (uint32_t i = 0; i < framesInFlight; ++i)
+        {
+            m_instances[i].handle = vk::createBuffer(instancesSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_instances[i].memory, m_device, m_GPU);
+
+            if(!m_instances[i].handle)
+                return VK_ERROR_INITIALIZATION_FAILED;
+
+            if (void* ptr; vkMapMemory(m_device, m_instances[i].memory, 0, instancesSize, 0, &ptr) == VK_SUCCESS)
+                m_mappedInstances[i] = static_cast<GpuInstance*>(ptr);
+            else 
+                return VK_ERROR_MEMORY_MAP_FAILED;
+        }
+
+        const VkBufferUsageFlags commandsUsage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+        const VkBufferUsageFlags indicesUsage  = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+
+        m_visibility.handle    = vk::createBuffer(sizeof(uint32_t) * m_maxClusters, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_visibility.memory, m_device, m_GPU);
+        m_earlyCommands.handle = vk::createBuffer(commandsSize, commandsUsage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_earlyCommands.memory, m_device, m_GPU);
+        m_lateCommands.handle  = vk::createBuffer(commandsSize, commandsUsage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_lateCommands.memory, m_device, m_GPU);
+        m_earlyIndices.handle  = vk::createBuffer(indicesSize, indicesUsage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_earlyIndices.memory, m_device, m_GPU);
+        m_lateIndices.handle   = vk::createBuffer(indicesSize, indicesUsage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_lateIndices.memory, m_device, m_GPU);
+
+        if(!m_visibility.handle || !m_earlyCommands.handle || !m_lateCommands.handle || !m_earlyIndices.handle || !m_lateIndices.handle)
+            return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    if(auto result = createDescriptorSets(); result != VK_SUCCESS)
+        return result;
+
+    writeDescriptors(occlusion);
+
+    return VK_SUCCESS;
+}
+
+
+VkResult ClusterCuller::resize(VulkanContext& context, const OcclusionCuller& occlusion) noexcept
+{
+//  Queued frames may still bind the old sets, see OcclusionCuller::resize
+    if(m_descriptorPool)
+        context.getDeletionQueue().retire(m_descriptorPool->getPool());
+
+    if(auto result = createDescriptorSets(); result != VK_SUCCESS)
+        return result;
+
+    writeDescriptors(occlusion);
+    m_resetVisibility = true;
+
+    return VK_SUCCESS;
+}
+
+
+void ClusterCuller::destroy() noexcept
+{
+    if(!m_device)
+        return;
+
+    if(m_descriptorPool)
+        m_descriptorPool->destroy();
+
+    auto destroyBuffer = [this](BufferData& buffer)
+    {
+        if(buffer.handle)
+            vkDestroyBuffer(m_device, buffer.handle, nullptr);
+
+        if(buffer.memory)
+            vkFreeMemory(m_device, buffer.memory, nullptr);
+
+        buffer = {};
+    };
+
+    for (auto& instances : m_instances)
+        destroyBuffer(instances);
+
+    destroyBuffer(m_visibility);
+    destroyBuffer(m_earlyCommands);
+    destroyBuffer(m_lateCommands);
+    destroyBuffer(m_earlyIndices);
+    destroyBuffer(m_lateIndices);
+
+    m_cullPipeline.destroy(m_device);
+
+    m_mappedInstances = {};
+    m_clusterBuffer = nullptr;
+    m_device        = nullptr;
+}
+
+
+bool ClusterCuller::setInstances(uint32_t frame, std::span<const Instance> instances) noexcept
+{
+    const uint32_t count = std::min(static_cast<uint32_t>(instances.size()), m_maxInstances);
+
+    uint32_t firstIndex      = 0;
+    uint32_t firstVisibility = 0;
+    uint32_t meshletMax      = 0;
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const auto& instance = instances[i];
+
+        if(instance.indexCount > m_maxIndices - firstIndex || instance.meshletCount > m_maxClusters - firstVisibility)
+        {
+            m_instanceCounts[frame] = 0;
+            m_meshletMax[frame]     = 0;
+
+            return false;
+        }
+
+        m_mappedInstances[frame][i] = 
+        {
+            .model           = instance.model,
+            .clusterOffset   = instance.clusterOffset,
+            .firstMeshlet    = instance.firstMeshlet,
+            .meshletCount    = instance.meshletCount,
+            .vertexOffset    = instance.vertexOffset,
+            .firstIndex      = firstIndex,
+            .firstVisibility = firstVisibility,
+            .pad             = {}
+        };
+
+        firstIndex      += instance.indexCount;
+        firstVisibility += instance.meshletCount;
+        meshletMax       = std::max(meshletMax, instance.meshletCount);
+    }
+
+    m_instanceCounts[frame] = count;
+    m_meshletMax[frame]     = meshletMax;
+
+    return true;
+}
+
+
+void ClusterCuller::cullEarly(VkCommandBuffer cmd, uint32_t frame, const OcclusionCuller::ViewParams& params) noexcept
+{
+//  Without known visibility phase 1 draws nothing and phase 2 tests every cluster
+    fill_commands(cmd, m_earlyCommands.handle, m_resetVisibility ? m_visibility.handle : nullptr);
+    m_resetVisibility = false;
+
+    dispatchCull(cmd, frame, params, false);
+}
+
+
+void ClusterCuller::cullLate(VkCommandBuffer cmd, uint32_t frame, const OcclusionCuller::ViewParams& params) noexcept
+{
+    fill_commands(cmd, m_lateCommands.handle, nullptr);
+    dispatchCull(cmd, frame, params, true);
+}
+
+
+VkBuffer ClusterCuller::getEarlyCommands() const noexcept
+{
+    return m_earlyCommands.handle;
+}
+
+
+VkBuffer ClusterCuller::getLateCommands() const noexcept
+{
+    return m_lateCommands.handle;
+}
+
+
+VkBuffer ClusterCuller::getEarlyIndices() const noexcept
+{
+    return m_earlyIndices.handle;
+}
+
+
+VkBuffer ClusterCuller::getLateIndices() const noexcept
+{
+    return m_lateIndices.handle;
+}
+
+
+VkBuffer ClusterCuller::getVisibility() const noexcept
+{
+    return m_visibility.handle;
+}
+
+
+VkResult ClusterCuller::createDescriptorSets() noexcept
+{
+    const uint32_t setCount = static_cast<uint32_t>(m_descriptorSets.size());
+
+    m_descriptorPool = std::make_unique<DescriptorPool>(m_device);
+
+    const std::array<VkDescriptorPoolSize, 2> poolSizes = 
+    {
+        VkDescriptorPoolSize
+        {
+            .type            = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            .descriptorCount = setCount
+        },
+        VkDescriptorPoolSize
+        {
+            .type            = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = 5 * setCount
+        }
+    };
+
+    if(m_descriptorPool->create(poolSizes, setCount) != VK_SUCCESS)
+        return VK_ERROR_INITIALIZATION_FAILED;
+
+    const std::vector<VkDescriptorSetLayout> layouts(setCount, m_cullPipeline.getDescriptorSetLayout());
+
+    if(m_descriptorPool->allocateDescriptorSets(m_descriptorSets, layouts) != VK_SUCCESS)
+        return VK_ERROR_INITIALIZATION_FAILED;
+
+    return VK_SUCCESS;
+}
+
+
+void ClusterCuller::writeDescriptors(const OcclusionCuller& occlusion) noexcept
+{
+    m_pyramidExtent = occlusion.getDepthPyramidExtent();
+
+    const VkDescriptorBufferInfo clustersInfo   = { m_clusterBuffer, 0, VK_WHOLE_SIZE };
+    const VkDescriptorBufferInfo visibilityInfo = { m_visibility.handle, 0, VK_WHOLE_SIZE };
+
+    const std::array<VkDescriptorBufferInfo, 2> commandsInfo = 
+    {
+        VkDescriptorBufferInfo{ m_earlyCommands.handle, 0, VK_WHOLE_SIZE },
+        VkDescriptorBufferInfo{ m_lateCommands.handle, 0, VK_WHOLE_SIZE }
+    };
+
+    const std::array<VkDescriptorBufferInfo, 2> indicesInfo = 
+    {
+        VkDescriptorBufferInfo{ m_earlyIndices.handle, 0, VK_WHOLE_SIZE },
+        VkDescriptorBufferInfo{ m_lateIndices.handle, 0, VK_WHOLE_SIZE }
+    };
+
+    const VkDescriptorImageInfo pyramidInfo = 
+    {
+        .sampler     = occlusion.getDepthPyramidSampler(),
+        .imageView   = occlusion.getDepthPyramidView(),
+        .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+    };
+
+    for (uint32_t i = 0; i < m_descriptorSets.size(); ++i)
+    {
+        const uint32_t frame = i / 2;
+        const uint32_t phase = i % 2;
+
+        const VkDescriptorBufferInfo instancesInfo = { m_instances[frame].handle, 0, VK_WHOLE_SIZE };
+
+        m_descriptorPool->writeStorageBuffer(&instancesInfo, m_descriptorSets[i], 0);
+        m_descriptorPool->writeStorageBuffer(&clustersInfo, m_descriptorSets[i], 1);
+        m_descriptorPool->writeStorageBuffer(&visibilityInfo, m_descriptorSets[i], 2);
+        m_descriptorPool->writeStorageBuffer(&commandsInfo[phase], m_descriptorSets[i], 3);
+        m_descriptorPool->writeStorageBuffer(&indicesInfo[phase], m_descriptorSets[i], 4);
+        m_descriptorPool->writeCombinedImageSampler(&pyramidInfo, m_descriptorSets[i], 5);
+    }
+}
+
+
+void ClusterCuller::dispatchCull(VkCommandBuffer cmd, uint32_t frame, const OcclusionCuller::ViewParams& params, bool late) noexcept
+{
+    if(!m_instanceCounts[frame] || !m_meshletMax[frame])
+        return;
+
+//  The camera sits at the translation of the inverse view
+    const mat4s inverseView = glms_mat4_inv(params.view);
+
+    const CullConstants constants = 
+    {
+        .view           = params.view,
+        .projection     = 
+        { 
+            params.projection.col[0].x, 
+            std::fabs(params.projection.col[1].y), // Y is flipped for Vulkan
+            params.projection.col[2].z, 
+            params.projection.col[3].z 
+        },
+        .cameraPosition = { inverseView.col[3].x, inverseView.col[3].y, inverseView.col[3].z, 1.f },
+        .znear          = params.znear,
+        .zfar           = params.zfar,
+        .pyramidWidth   = static_cast<float>(m_pyramidExtent.width),
+        .pyramidHeight  = static_cast<float>(m_pyramidExtent.height),
+        .instanceCount  = m_instanceCounts[frame],
+        .late           = late ? 1U : 0U
+    };
+
+    const VkDescriptorSet descriptorSet = m_descriptorSets[frame * 2 + (late ? 1 : 0)];
+
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_cullPipeline.getHandle());
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_cullPipeline.getLayout(), 0, 1, &descriptorSet, 0, nullptr);
+    vkCmdPushConstants(cmd, m_cullPipeline.getLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(CullConstants), &constants);
+    vkCmdDispatch(cmd, m_meshletMax[frame], m_instanceCounts[frame], 1);
+}
\ No newline at end of file
@@ -0,0 +1,103 @@
+#ifndef CLUSTER_CULLER_HPP
+#define CLUSTER_CULLER_HPP
+
+#include <span>
+#include <vector>
+#include <memory>
+
+#include <vulkan/vulkan.h>
+#include <cglm/struct/mat4.h>
+
+#include "vulkan_api/pipeline/ComputePipeline.hpp"
+#include "vulkan_api/pipeline/descriptors/DescriptorPool.hpp"
+#include "vulkan_api/culling/OcclusionCuller.hpp"
+
+
+// Per-meshlet culling on top of the two-phase scheme of OcclusionCuller, whose depth pyramid it reads.
+// Every cluster of every instance is tested against the frustum, its normal cone and the pyramid,
+// and the surviving triangles are appended to the instance's range of a 32-bit output index buffer.
+// Each instance owns one VkDrawIndexedIndirectCommand per phase, drawn with the output buffer bound instead of the pool's indices.
+// Visibility is remembered per cluster, so the late phase only draws clusters that became visible.
+// Entries are laid out by the instances of the frame, a level change leaves stale entries for a frame, which costs draws but never drops any.
+class ClusterCuller
+{
+public:
+    struct Instance
+    {
+        mat4s    model;
+        uint32_t clusterOffset; // GeometryPool::Mesh::clusterOffset
+        uint32_t firstMeshlet;  // level of detail to draw
+        uint32_t meshletCount;
+        int32_t  vertexOffset;
+        uint32_t indexCount;    // of the level, bounds the output range
+    };
+
+    ClusterCuller() noexcept;
+
+    VkResult create(const class VulkanContext& context, VkBuffer clusterBuffer, const OcclusionCuller& occlusion, 
+                    uint32_t maxInstances, uint32_t maxClusters, uint32_t maxIndices, uint32_t framesInFlight) noexcept;
+    VkResult resize(class VulkanContext& context, const OcclusionCuller& occlusion) noexcept; // after the occlusion culler rebuilt its pyramid
+    void     destroy() noexcept;
+
+//  False when the instances exceed the cluster or index budget, nothing is drawn then
+    bool setInstances(uint32_t frame, std::span<const Instance> instances) noexcept;
+
+    void cullEarly(VkCommandBuffer cmd, uint32_t frame, const OcclusionCuller::ViewParams& params) noexcept;
+    void cullLate(VkCommandBuffer cmd, uint32_t frame, const OcclusionCuller::ViewParams& params) noexcept;
+
+    VkBuffer getEarlyCommands() const noexcept;
+    VkBuffer getLateCommands()  const noexcept;
+    VkBuffer getEarlyIndices()  const noexcept;
+    VkBuffer getLateIndices()   const noexcept;
+    VkBuffer getVisibility()    const noexcept;
+
+private:
+    struct BufferData
+    {
+        VkBuffer       handle = nullptr;
+        VkDeviceMemory memory = nullptr;
+    };
+
+    struct GpuInstance
+    {
+        mat4s    model;
+        uint32_t clusterOffset;
+        uint32_t firstMeshlet;
+        uint32_t meshletCount;
+        int32_t  vertexOffset;
+        uint32_t firstIndex;
+        uint32_t firstVisibility;
+        uint32_t pad[2];
+    };
+
+    VkResult createDescriptorSets() noexcept;
+    void     writeDescriptors(const OcclusionCuller& occlusion) noexcept;
+    void     dispatchCull(VkCommandBuffer cmd, uint32_t frame, const OcclusionCuller::ViewParams& params, bool late) noexcept;
+
+    VkPhysicalDevice m_GPU;
+    VkDevice         m_device;
+    VkBuffer         m_clusterBuffer;
+
+    ComputePipeline m_cullPipeline;
+    std::unique_ptr<DescriptorPool> m_descriptorPool;
+    std::vector<VkDescriptorSet>    m_descriptorSets; // early and late per frame in flight
+
+//  One instance buffer per frame in flight
+    std::vector<BufferData>   m_instances;
+    std::vector<GpuInstance*> m_mappedInstances;
+    std::vector<uint32_t>     m_instanceCounts;
+    std::vector<uint32_t>     m_meshletMax; // largest meshlet count of the frame, the dispatch width
+
+    BufferData m_visibility;
+    BufferData m_earlyCommands;
+    BufferData m_lateCommands;
+    BufferData m_earlyIndices;
+    BufferData m_lateIndices;
+    VkExtent2D m_pyramidExtent;
+    uint32_t   m_maxInstances;
+    uint32_t   m_maxClusters;
+    uint32_t   m_maxIndices;
+    bool       m_resetVisibility;
+};
+
+#endif // !CLUSTER_CULLER_HPP
\ No newline at end of file
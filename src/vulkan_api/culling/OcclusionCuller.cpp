@@ -0,0 +1,576 @@
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+#include "vulkan_api/utils/Helpers.hpp"
+#include "vulkan_api/context/VulkanContext.hpp"
+#include "vulkan_api/presentation/MainView.hpp"
+#include "vulkan_api/culling/OcclusionCuller.hpp"
+
+
+namespace
+{
+    struct ReduceConstants
+    {
+        uint32_t inputSize[2];
+        uint32_t outputSize[2];
+    };
+
+    struct CullConstants
+    {
+        mat4s    view;
+        float    projection[4];
+        float    znear;
+        float    zfar;
+        float    pyramidWidth;
+        float    pyramidHeight;
+        uint32_t objectCount;
+        uint32_t late;
+    };
+
+    constexpr uint32_t CULL_GROUP_SIZE   = 64;
+    constexpr uint32_t REDUCE_GROUP_SIZE = 8;
+
+//  Power of two size keeps every next level an exact 2x2 reduction of the previous one
+    VkExtent2D get_pyramid_extent(const VkExtent2D& extent) noexcept
+    {
+        return 
+        {
+            .width  = std::bit_floor(std::max(extent.width, 1U)),
+            .height = std::bit_floor(std::max(extent.height, 1U))
+        };
+    }
+}
+
+
+
+OcclusionCuller::OcclusionCuller() noexcept:
+    m_GPU(nullptr),
+    m_device(nullptr),
+    m_reduceDescriptorSets({}),
+    m_pyramidImage(nullptr),
+    m_pyramidMemory(nullptr),
+    m_pyramidView(nullptr),
+    m_pyramidLevelViews({}),
+    m_sampler(nullptr),
+    m_pyramidExtent({}),
+    m_pyramidLevels(0),
+    m_depthInput(nullptr),
+    m_maxObjects(0),
+    m_resetVisibility(true)
+{
+
+}
+
+
+VkResult OcclusionCuller::create(const MainView& view, uint32_t maxObjects, uint32_t framesInFlight) noexcept
+{
+    m_GPU        = view.getContext()->getPhysicalDevice();
+    m_device     = view.getContext()->getDevice();
+    m_maxObjects = std::max(maxObjects, 1U);
+
+    framesInFlight = std::max(framesInFlight, 1U);
+    m_objects.assign(framesInFlight, {});
+    m_mappedObjects.assign(framesInFlight, nullptr);
+    m_objectCounts.assign(framesInFlight, 0);
+    m_cullDescriptorSets.assign(framesInFlight, nullptr);
+
+    {// Pipelines
+        ShaderStage reduceShader;
+        ShaderStage cullShader;
+
+        if(reduceShader.loadFromFile(m_device, VK_SHADER_STAGE_COMPUTE_BIT, "res/shaders/depth_pyramid.spv") != VK_SUCCESS)
+            return VK_ERROR_INITIALIZATION_FAILED;
+
+        if(cullShader.loadFromFile(m_device, VK_SHADER_STAGE_COMPUTE_BIT, "res/shaders/occlusion_cull.spv") != VK_SUCCESS)
+        {
+            reduceShader.destroy(m_device);
+
+            return VK_ERROR_INITIALIZATION_FAILED;
+        }
+
+        DescriptorSetLayout reduceDescriptors;
+        reduceDescriptors.addDescriptor(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT);
+        reduceDescriptors.addDescriptor(VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT);
+
+        DescriptorSetLayout cullDescriptors;
+        cullDescriptors.addDescriptor(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT); // objects
+        cullDescriptors.addDescriptor(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT); // visibility
+        cullDescriptors.addDescriptor(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT); // early commands
+        cullDescriptors.addDescriptor(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT); // late commands
+        cullDescriptors.addDescriptor(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT); // depth pyramid
+
+        VkResult result = m_reducePipeline.create(m_device, reduceShader, reduceDescriptors, sizeof(ReduceConstants));
+
+        if(result == VK_SUCCESS)
+            result = m_cullPipeline.create(m_device, cullShader, cullDescriptors, sizeof(CullConstants));
+
+        reduceShader.destroy(m_device);
+        cullShader.destroy(m_device);
+
+        if(result != VK_SUCCESS)
+            return result;
+    }
+
+    {// Buffers
+        const VkDeviceSize objectsSize  = sizeof(Object) * m_maxObjects;
+        const VkDeviceSize commandsSize = sizeof(VkDrawIndexedIndirectCommand) * m_maxObjects;
+
+        for (uint32_t i = 0; i < framesInFlight; ++i)
+        {
+            m_objects[i].handle = vk::createBuffer(objectsSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_objects[i].memory, m_device, m_GPU);
+
+            if(!m_objects[i].handle)
+                return VK_ERROR_INITIALIZATION_FAILED;
+
+            if (void* ptr; vkMapMemory(m_device, m_objects[i].memory, 0, objectsSize, 0, &ptr) == VK_SUCCESS)
+                m_mappedObjects[i] = static_cast<Object*>(ptr);
+            else 
+                return VK_ERROR_MEMORY_MAP_FAILED;
+        }
+
+        m_visibility.handle    = vk::createBuffer(sizeof(uint32_t) * m_maxObjects, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_visibility.memory, m_device, m_GPU);
+        m_earlyCommands.handle = vk::createBuffer(commandsSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_earlyCommands.memory, m_device, m_GPU);
+        m_lateCommands.handle  = vk::createBuffer(commandsSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_lateCommands.memory, m_device, m_GPU);
+
+        if(!m_visibility.handle || !m_earlyCommands.handle || !m_lateCommands.handle)
+            return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    {// Sampler, the shaders only use texelFetch, so filtering does not matter
+        const VkSamplerCreateInfo samplerInfo = 
+        {
+            .sType                   = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
+            .pNext                   = nullptr,
+            .flags                   = 0,
+            .magFilter               = VK_FILTER_NEAREST,
+            .minFilter               = VK_FILTER_NEAREST,
+            .mipmapMode              = VK_SAMPLER_MIPMAP_MODE_NEAREST,
+            .addressModeU            = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+            .addressModeV            = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+            .addressModeW            = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+            .mipLodBias              = 0.f,
+            .anisotropyEnable        = VK_FALSE,
+            .maxAnisotropy           = 1.f,
+            .compareEnable           = VK_FALSE,
+            .compareOp               = VK_COMPARE_OP_ALWAYS,
+            .minLod                  = 0.f,
+            .maxLod                  = static_cast<float>(MAX_PYRAMID_LEVELS),
+            .borderColor             = VK_BORDER_COLOR_FLOAT_OPAQUE_BLACK,
+            .unnormalizedCoordinates = VK_FALSE
+        };
+
+        if(vkCreateSampler(m_device, &samplerInfo, nullptr, &m_sampler) != VK_SUCCESS)
+            return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    return resize(view);
+}
+
+
+VkResult OcclusionCuller::resize(const MainView& view) noexcept
+{
+    if(!needsRebuild(view))
+        return VK_SUCCESS;
+
+//  Queued frames may still read the old pyramid through the old descriptor sets, so both are retired instead of destroyed
+    auto& deletionQueue = view.getContext()->getDeletionQueue();
+
+    for (auto& levelView : m_pyramidLevelViews)
+    {
+        deletionQueue.retire(levelView);
+        levelView = nullptr;
+    }
+
+    deletionQueue.retire(m_pyramidView);
+    deletionQueue.retire(m_pyramidImage, m_pyramidMemory);
+
+    m_pyramidView   = nullptr;
+    m_pyramidImage  = nullptr;
+    m_pyramidMemory = nullptr;
+
+    if(m_descriptorPool)
+        deletionQueue.retire(m_descriptorPool->getPool());
+
+    if(auto result = createDescriptorSets(); result != VK_SUCCESS)
+        return result;
+
+    if(auto result = createDepthPyramid(view); result != VK_SUCCESS)
+        return result;
+
+    writeDescriptors(view);
+    m_resetVisibility = true;
+
+    return VK_SUCCESS;
+}
+
+
+// The pyramid only depends on the depth view and the power of two below the extent, most resizes keep both
+bool OcclusionCuller::needsRebuild(const MainView& view) const noexcept
+{
+    const VkExtent2D pyramidExtent = get_pyramid_extent(view.getExtent());
+
+    return (view.getDepthImageView() != m_depthInput) ||
+           (pyramidExtent.width != m_pyramidExtent.width) || 
+           (pyramidExtent.height != m_pyramidExtent.height);
+}
+
+
+void OcclusionCuller::destroy() noexcept
+{
+    if(!m_device)
+        return;
+
+    destroyDepthPyramid();
+
+    if(m_descriptorPool)
+        m_descriptorPool->destroy();
+
+    if(m_sampler)
+        vkDestroySampler(m_device, m_sampler, nullptr);
+
+    auto destroyBuffer = [this](BufferData& buffer)
+    {
+        if(buffer.handle)
+            vkDestroyBuffer(m_device, buffer.handle, nullptr);
+
+        if(buffer.memory)
+            vkFreeMemory(m_device, buffer.memory, nullptr);
+
+        buffer = {};
+    };
+
+    for (auto& objects : m_objects)
+        destroyBuffer(objects);
+
+    destroyBuffer(m_visibility);
+    destroyBuffer(m_earlyCommands);
+    destroyBuffer(m_lateCommands);
+
+    m_reducePipeline.destroy(m_device);
+    m_cullPipeline.destroy(m_device);
+
+    m_mappedObjects = {};
+    m_sampler = nullptr;
+    m_device  = nullptr;
+}
+
+
+void OcclusionCuller::setObjects(uint32_t frame, std::span<const Object> objects) noexcept
+{
+    const uint32_t count = std::min(static_cast<uint32_t>(objects.size()), m_maxObjects);
+
+    memcpy(m_mappedObjects[frame], objects.data(), sizeof(Object) * count);
+    m_objectCounts[frame] = count;
+}
+
+
+void OcclusionCuller::cullEarly(VkCommandBuffer cmd, uint32_t frame, const ViewParams& params) noexcept
+{
+    if(m_resetVisibility)
+    {// Nothing is known to be visible: phase 1 draws nothing and phase 2 tests every object
+        vkCmdFillBuffer(cmd, m_visibility.handle, 0, VK_WHOLE_SIZE, 0);
+
+        const VkMemoryBarrier fillBarrier = 
+        {
+            .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+            .pNext         = nullptr,
+            .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT
+        };
+
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &fillBarrier, 0, nullptr, 0, nullptr);
+
+        m_resetVisibility = false;
+    }
+
+    dispatchCull(cmd, frame, params, false);
+}
+
+
+// Expects the depth attachment in SHADER_READ_ONLY_OPTIMAL and the pyramid in GENERAL
+void OcclusionCuller::buildDepthPyramid(VkCommandBuffer cmd, const VkExtent2D& depthExtent) noexcept
+{
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_reducePipeline.getHandle());
+
+    VkExtent2D inputSize = depthExtent;
+
+    for (uint32_t level = 0; level < m_pyramidLevels; ++level)
+    {
+        const VkExtent2D outputSize = 
+        {
+            .width  = std::max(m_pyramidExtent.width >> level, 1U),
+            .height = std::max(m_pyramidExtent.height >> level, 1U)
+        };
+
+        const ReduceConstants constants = 
+        {
+            .inputSize  = { inputSize.width, inputSize.height },
+            .outputSize = { outputSize.width, outputSize.height }
+        };
+
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_reducePipeline.getLayout(), 0, 1, &m_reduceDescriptorSets[level], 0, nullptr);
+        vkCmdPushConstants(cmd, m_reducePipeline.getLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(ReduceConstants), &constants);
+        vkCmdDispatch(cmd, (outputSize.width + REDUCE_GROUP_SIZE - 1) / REDUCE_GROUP_SIZE, (outputSize.height + REDUCE_GROUP_SIZE - 1) / REDUCE_GROUP_SIZE, 1);
+
+        const VkImageMemoryBarrier levelBarrier = 
+        {
+            .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+            .pNext               = nullptr,
+            .srcAccessMask       = VK_ACCESS_SHADER_WRITE_BIT,
+            .dstAccessMask       = VK_ACCESS_SHADER_READ_BIT,
+            .oldLayout           = VK_IMAGE_LAYOUT_GENERAL,
+            .newLayout           = VK_IMAGE_LAYOUT_GENERAL,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image               = m_pyramidImage,
+            .subresourceRange    = 
+            {
+                .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+                .baseMipLevel   = level,
+                .levelCount     = 1,
+                .baseArrayLayer = 0,
+                .layerCount     = 1
+            }
+        };
+
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &levelBarrier);
+
+        inputSize = outputSize;
+    }
+}
+
+
+void OcclusionCuller::cullLate(VkCommandBuffer cmd, uint32_t frame, const ViewParams& params) noexcept
+{
+    dispatchCull(cmd, frame, params, true);
+}
+
+
+VkBuffer OcclusionCuller::getEarlyCommands() const noexcept
+{
+    return m_earlyCommands.handle;
+}
+
+
+VkBuffer OcclusionCuller::getLateCommands() const noexcept
+{
+    return m_lateCommands.handle;
+}
+
+
+VkBuffer OcclusionCuller::getVisibility() const noexcept
+{
+    return m_visibility.handle;
+}
+
+
+VkImage OcclusionCuller::getDepthPyramid() const noexcept
+{
+    return m_pyramidImage;
+}
+
+
+VkImageView OcclusionCuller::getDepthPyramidView() const noexcept
+{
+    return m_pyramidView;
+}
+
+
+VkSampler OcclusionCuller::getDepthPyramidSampler() const noexcept
+{
+    return m_sampler;
+}
+
+
+VkExtent2D OcclusionCuller::getDepthPyramidExtent() const noexcept
+{
+    return m_pyramidExtent;
+}
+
+
+uint32_t OcclusionCuller::getDepthPyramidLevels() const noexcept
+{
+    return m_pyramidLevels;
+}
+
+
+// A fresh pool per pyramid, the sets of the previous one may still be bound by queued frames
+VkResult OcclusionCuller::createDescriptorSets() noexcept
+{
+    const uint32_t framesInFlight = static_cast<uint32_t>(m_cullDescriptorSets.size());
+
+    m_descriptorPool = std::make_unique<DescriptorPool>(m_device);
+
+    const std::array<VkDescriptorPoolSize, 3> poolSizes = 
+    {
+        VkDescriptorPoolSize
+        {
+            .type            = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            .descriptorCount = MAX_PYRAMID_LEVELS + framesInFlight
+        },
+        VkDescriptorPoolSize
+        {
+            .type            = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+            .descriptorCount = MAX_PYRAMID_LEVELS
+        },
+        VkDescriptorPoolSize
+        {
+            .type            = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = 4 * framesInFlight
+        }
+    };
+
+    if(m_descriptorPool->create(poolSizes, MAX_PYRAMID_LEVELS + framesInFlight) != VK_SUCCESS)
+        return VK_ERROR_INITIALIZATION_FAILED;
+
+    std::array<VkDescriptorSetLayout, MAX_PYRAMID_LEVELS> reduceLayouts;
+    reduceLayouts.fill(m_reducePipeline.getDescriptorSetLayout());
+
+    const std::vector<VkDescriptorSetLayout> cullLayouts(framesInFlight, m_cullPipeline.getDescriptorSetLayout());
+
+    if(m_descriptorPool->allocateDescriptorSets(m_reduceDescriptorSets, reduceLayouts) != VK_SUCCESS)
+        return VK_ERROR_INITIALIZATION_FAILED;
+
+    if(m_descriptorPool->allocateDescriptorSets(m_cullDescriptorSets, cullLayouts) != VK_SUCCESS)
+        return VK_ERROR_INITIALIZATION_FAILED;
+
+    return VK_SUCCESS;
+}
+
+
+VkResult OcclusionCuller::createDepthPyramid(const MainView& view) noexcept
+{
+    const VkExtent2D& extent = view.getExtent();
+
+    m_pyramidExtent = get_pyramid_extent(extent);
+
+    m_pyramidLevels = std::min(static_cast<uint32_t>(std::bit_width(std::max(m_pyramidExtent.width, m_pyramidExtent.height))), MAX_PYRAMID_LEVELS);
+
+    if(vk::createImage2D(
+        m_pyramidExtent.width,
+        m_pyramidExtent.height,
+        VK_FORMAT_R32_SFLOAT,
+        VK_IMAGE_TILING_OPTIMAL,
+        VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        m_pyramidImage,
+        m_pyramidMemory,
+        m_GPU,
+        m_device,
+        m_pyramidLevels) != VK_SUCCESS)
+        return VK_ERROR_INITIALIZATION_FAILED;
+
+    if(vk::createImageView2D(m_device, m_pyramidImage, VK_FORMAT_R32_SFLOAT, VK_IMAGE_ASPECT_COLOR_BIT, m_pyramidView, 0, m_pyramidLevels) != VK_SUCCESS)
+        return VK_ERROR_INITIALIZATION_FAILED;
+
+    for (uint32_t level = 0; level < m_pyramidLevels; ++level)
+        if(vk::createImageView2D(m_device, m_pyramidImage, VK_FORMAT_R32_SFLOAT, VK_IMAGE_ASPECT_COLOR_BIT, m_pyramidLevelViews[level], level, 1) != VK_SUCCESS)
+            return VK_ERROR_INITIALIZATION_FAILED;
+
+    return VK_SUCCESS;
+}
+
+
+void OcclusionCuller::destroyDepthPyramid() noexcept
+{
+    for (auto& levelView : m_pyramidLevelViews)
+    {
+        if(levelView)
+            vkDestroyImageView(m_device, levelView, nullptr);
+
+        levelView = nullptr;
+    }
+
+    if(m_pyramidView)
+        vkDestroyImageView(m_device, m_pyramidView, nullptr);
+
+    if(m_pyramidImage)
+        vkDestroyImage(m_device, m_pyramidImage, nullptr);
+
+    if(m_pyramidMemory)
+        vkFreeMemory(m_device, m_pyramidMemory, nullptr);
+
+    m_pyramidView   = nullptr;
+    m_pyramidImage  = nullptr;
+    m_pyramidMemory = nullptr;
+    m_pyramidLevels = 0;
+    m_pyramidExtent = {};
+    m_depthInput    = nullptr;
+}
+
+
+void OcclusionCuller::writeDescriptors(const MainView& view) noexcept
+{
+    m_depthInput = view.getDepthImageView();
+
+    for (uint32_t level = 0; level < m_pyramidLevels; ++level)
+    {
+        const VkDescriptorImageInfo inputInfo = 
+        {
+            .sampler     = m_sampler,
+            .imageView   = level ? m_pyramidLevelViews[level - 1] : view.getDepthImageView(),
+            .imageLayout = level ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+        };
+
+        const VkDescriptorImageInfo outputInfo = 
+        {
+            .sampler     = nullptr,
+            .imageView   = m_pyramidLevelViews[level],
+            .imageLayout = VK_IMAGE_LAYOUT_GENERAL
+        };
+
+        m_descriptorPool->writeCombinedImageSampler(&inputInfo, m_reduceDescriptorSets[level], 0);
+        m_descriptorPool->writeStorageImage(&outputInfo, m_reduceDescriptorSets[level], 1);
+    }
+
+    const VkDescriptorBufferInfo visibilityInfo    = { m_visibility.handle, 0, VK_WHOLE_SIZE };
+    const VkDescriptorBufferInfo earlyCommandsInfo = { m_earlyCommands.handle, 0, VK_WHOLE_SIZE };
+    const VkDescriptorBufferInfo lateCommandsInfo  = { m_lateCommands.handle, 0, VK_WHOLE_SIZE };
+
+    const VkDescriptorImageInfo pyramidInfo = 
+    {
+        .sampler     = m_sampler,
+        .imageView   = m_pyramidView,
+        .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+    };
+
+    for (uint32_t i = 0; i < m_cullDescriptorSets.size(); ++i)
+    {
+        const VkDescriptorBufferInfo objectsInfo = { m_objects[i].handle, 0, VK_WHOLE_SIZE };
+
+        m_descriptorPool->writeStorageBuffer(&objectsInfo, m_cullDescriptorSets[i], 0);
+        m_descriptorPool->writeStorageBuffer(&visibilityInfo, m_cullDescriptorSets[i], 1);
+        m_descriptorPool->writeStorageBuffer(&earlyCommandsInfo, m_cullDescriptorSets[i], 2);
+        m_descriptorPool->writeStorageBuffer(&lateCommandsInfo, m_cullDescriptorSets[i], 3);
+        m_descriptorPool->writeCombinedImageSampler(&pyramidInfo, m_cullDescriptorSets[i], 4);
+    }
+}
+
+
+void OcclusionCuller::dispatchCull(VkCommandBuffer cmd, uint32_t frame, const ViewParams& params, bool late) noexcept
+{
+    const CullConstants constants = 
+    {
+        .view          = params.view,
+        .projection    = 
+        { 
+            params.projection.col[0].x, 
+            std::fabs(params.projection.col[1].y), // Y is flipped for Vulkan
+            params.projection.col[2].z, 
+            params.projection.col[3].z 
+        },
+        .znear         = params.znear,
+        .zfar          = params.zfar,
+        .pyramidWidth  = static_cast<float>(m_pyramidExtent.width),
+        .pyramidHeight = static_cast<float>(m_pyramidExtent.height),
+        .objectCount   = m_objectCounts[frame],
+        .late          = late ? 1U : 0U
+    };
+
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_cullPipeline.getHandle());
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_cullPipeline.getLayout(), 0, 1, &m_cullDescriptorSets[frame], 0, nullptr);
+    vkCmdPushConstants(cmd, m_cullPipeline.getLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(CullConstants), &constants);
+    vkCmdDispatch(cmd, (m_objectCounts[frame] + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE, 1, 1);
+}
\ No newline at end of file
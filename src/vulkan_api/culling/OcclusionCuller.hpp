@@ -0,0 +1,110 @@
+#ifndef OCCLUSION_CULLER_HPP
+#define OCCLUSION_CULLER_HPP
+
+#include <array>
+#include <span>
+#include <vector>
+#include <memory>
+
+#include <vulkan/vulkan.h>
+#include <cglm/struct/mat4.h>
+
+#include "vulkan_api/pipeline/ComputePipeline.hpp"
+#include "vulkan_api/pipeline/descriptors/DescriptorPool.hpp"
+
+
+// Two-phase hierarchical-Z occlusion culling.
+// Phase 1 draws the objects that were visible in the previous frame, then a depth pyramid (HZB) is built from that depth.
+// Phase 2 tests every object against the pyramid and draws only the ones that became visible.
+// Each object owns one VkDrawIndexedIndirectCommand in both command buffers, instanceCount is 0 for culled objects.
+// Barriers between the steps are left to the caller (see RenderGraph), only the ones inside a step are recorded here.
+class OcclusionCuller
+{
+public:
+    struct Object
+    {
+        float    sphere[4]; // world space center and radius
+        uint32_t indexCount;
+        uint32_t firstIndex;
+        int32_t  vertexOffset;
+        uint32_t firstInstance;
+    };
+
+    struct ViewParams
+    {
+        mat4s view;
+        mat4s projection;
+        float znear;
+        float zfar;
+    };
+
+    OcclusionCuller() noexcept;
+
+    VkResult create(const class MainView& view, uint32_t maxObjects, uint32_t framesInFlight) noexcept;
+    VkResult resize(const class MainView& view) noexcept;
+    bool     needsRebuild(const class MainView& view) const noexcept;
+    void     destroy() noexcept;
+
+    void setObjects(uint32_t frame, std::span<const Object> objects) noexcept;
+
+    void cullEarly(VkCommandBuffer cmd, uint32_t frame, const ViewParams& params) noexcept;
+    void buildDepthPyramid(VkCommandBuffer cmd, const VkExtent2D& depthExtent) noexcept; // extent actually rendered, may be smaller than the depth image
+    void cullLate(VkCommandBuffer cmd, uint32_t frame, const ViewParams& params) noexcept;
+
+    VkBuffer getEarlyCommands() const noexcept;
+    VkBuffer getLateCommands()  const noexcept;
+    VkBuffer getVisibility()    const noexcept;
+
+    VkImage     getDepthPyramid()        const noexcept;
+    VkImageView getDepthPyramidView()    const noexcept;
+    VkSampler   getDepthPyramidSampler() const noexcept;
+    VkExtent2D  getDepthPyramidExtent()  const noexcept;
+    uint32_t    getDepthPyramidLevels()  const noexcept;
+
+private:
+    struct BufferData
+    {
+        VkBuffer       handle = nullptr;
+        VkDeviceMemory memory = nullptr;
+    };
+
+    VkResult createDescriptorSets() noexcept;
+    VkResult createDepthPyramid(const class MainView& view) noexcept;
+    void     destroyDepthPyramid() noexcept;
+    void     writeDescriptors(const class MainView& view) noexcept;
+    void     dispatchCull(VkCommandBuffer cmd, uint32_t frame, const ViewParams& params, bool late) noexcept;
+
+    static constexpr uint32_t MAX_PYRAMID_LEVELS = 16;
+
+    VkPhysicalDevice m_GPU;
+    VkDevice         m_device;
+
+    ComputePipeline m_reducePipeline;
+    ComputePipeline m_cullPipeline;
+    std::unique_ptr<DescriptorPool> m_descriptorPool;
+    std::array<VkDescriptorSet, MAX_PYRAMID_LEVELS>   m_reduceDescriptorSets;
+    std::vector<VkDescriptorSet>                    m_cullDescriptorSets; // one per frame in flight
+
+//  Depth pyramid
+    VkImage        m_pyramidImage;
+    VkDeviceMemory m_pyramidMemory;
+    VkImageView    m_pyramidView;
+    std::array<VkImageView, MAX_PYRAMID_LEVELS> m_pyramidLevelViews;
+    VkSampler      m_sampler;
+    VkExtent2D     m_pyramidExtent;
+    uint32_t       m_pyramidLevels;
+    VkImageView    m_depthInput; // depth view the first reduction reads
+
+//  One object buffer per frame in flight
+    std::vector<BufferData> m_objects;
+    std::vector<Object*>    m_mappedObjects;
+    std::vector<uint32_t>   m_objectCounts;
+
+    BufferData m_visibility;
+    BufferData m_earlyCommands;
+    BufferData m_lateCommands;
+    uint32_t   m_maxObjects;
+    bool       m_resetVisibility;
+};
+
+#endif // !OCCLUSION_CULLER_HPP
\ No newline at end of file
@@ -0,0 +1,90 @@
+#include "vulkan_api/pipeline/ComputePipeline.hpp"
+
+
+ComputePipeline::ComputePipeline() noexcept:
+    m_descriptorSetLayout(nullptr),
+    m_layout(nullptr),
+    m_handle(nullptr)
+{
+
+}
+
+
+VkResult ComputePipeline::create(VkDevice device, const ShaderStage& shader, const DescriptorSetLayout& uniformDescriptorSet, uint32_t pushConstantSize) noexcept
+{
+    destroy(device);
+
+    const VkDescriptorSetLayoutCreateInfo layoutInfo = uniformDescriptorSet.getInfo();
+
+    if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &m_descriptorSetLayout) != VK_SUCCESS)
+        return VK_ERROR_INITIALIZATION_FAILED;
+
+    const VkPushConstantRange pushConstantRange = 
+    {
+        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+        .offset     = 0,
+        .size       = pushConstantSize
+    };
+
+    const VkPipelineLayoutCreateInfo pipelineLayoutInfo = 
+    {
+        .sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+        .pNext                  = nullptr,
+        .flags                  = 0,
+        .setLayoutCount         = 1,
+        .pSetLayouts            = &m_descriptorSetLayout,
+        .pushConstantRangeCount = pushConstantSize ? 1U : 0U,
+        .pPushConstantRanges    = pushConstantSize ? &pushConstantRange : nullptr
+    };
+
+    if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &m_layout) != VK_SUCCESS)
+        return VK_ERROR_INITIALIZATION_FAILED;
+
+    const VkComputePipelineCreateInfo pipelineInfo = 
+    {
+        .sType              = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+        .pNext              = nullptr,
+        .flags              = 0,
+        .stage              = shader.getInfo(),
+        .layout             = m_layout,
+        .basePipelineHandle = nullptr,
+        .basePipelineIndex  = 0
+    };
+
+    return vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_handle);
+}
+
+
+void ComputePipeline::destroy(VkDevice device) noexcept
+{
+    if(m_handle)
+        vkDestroyPipeline(device, m_handle, nullptr);
+
+    if(m_layout)
+        vkDestroyPipelineLayout(device, m_layout, nullptr);
+
+    if(m_descriptorSetLayout)
+        vkDestroyDescriptorSetLayout(device, m_descriptorSetLayout, nullptr);
+
+    m_handle = nullptr;
+    m_layout = nullptr;
+    m_descriptorSetLayout = nullptr;
+}
+
+
+VkDescriptorSetLayout ComputePipeline::getDescriptorSetLayout() const noexcept
+{
+    return m_descriptorSetLayout;
+}
+
+
+VkPipelineLayout ComputePipeline::getLayout() const noexcept
+{
+    return m_layout;
+}
+
+
+VkPipeline ComputePipeline::getHandle() const noexcept
+{
+    return m_handle;
+}
\ No newline at end of file
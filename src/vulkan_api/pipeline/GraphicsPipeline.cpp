@@ -7,31 +7,42 @@
 #include "vulkan_api/pipeline/GraphicsPipeline.hpp"
 
 
-struct GraphicsPipelineStages
+GraphicsPipeline::State::State() noexcept:
+    m_shaders(),
+    m_shaderCount(0),
+    m_vertexInputState(),
+    m_inputAssembly(),
+    m_viewportState(),
+    m_rasterizer(),
+    m_multisampling(),
+    m_colorBlending(),
+    m_depthStencil
+    {
+        .sType                 = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
+        .pNext                 = VK_NULL_HANDLE,
+        .flags                 = 0,
+        .depthTestEnable       = VK_TRUE,
+        .depthWriteEnable      = VK_TRUE,
+        .depthCompareOp        = VK_COMPARE_OP_LESS,
+        .depthBoundsTestEnable = VK_FALSE,
+        .stencilTestEnable     = VK_FALSE,
+        .front                 = {},
+        .back                  = {},
+        .minDepthBounds        = 0.f,
+        .maxDepthBounds        = 1.f
+    },
+    m_layoutInfo(),
+    m_pushConstants{ VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(mat4s) }
 {
-    std::vector<VkPipelineShaderStageCreateInfo> shaders;
-    std::unique_ptr<VertexInputState>            vertexInputState;
-    VkPipelineInputAssemblyStateCreateInfo       inputAssembly;
-    VkPipelineViewportStateCreateInfo            viewportState;
-    VkPipelineRasterizationStateCreateInfo       rasterizer;
-    VkPipelineMultisampleStateCreateInfo         multisampling;
-    VkPipelineColorBlendAttachmentState          colorBlending;
-    DescriptorSetLayout                          layoutInfo;
-};
+
+}
 
 
 GraphicsPipeline::State* GraphicsPipeline::State::setupShaderStages(std::span<const ShaderStage> shaders) noexcept
 {
-    if(!m_data)
-        m_data = std::make_shared<GraphicsPipelineStages>();
-
-    auto stages = static_cast<GraphicsPipelineStages*>(m_data.get());
-
-    if(!shaders.empty())
-    {
-        for(const auto shader : shaders)
-            stages->shaders.push_back(shader.getInfo());
-    }
+    for(const auto& shader : shaders)
+        if(m_shaderCount < MAX_SHADER_STAGES)
+            m_shaders[m_shaderCount++] = shader.getInfo();
 
     return this;
 }
@@ -39,24 +50,23 @@ GraphicsPipeline::State* GraphicsPipeline::State::setupShaderStages(std::span<co
 
 GraphicsPipeline::State* GraphicsPipeline::State::setupVertexInput(std::span<const VertexInputState::Attribute> attributes) noexcept
 {
-    if(!m_data)
-        m_data = std::make_shared<GraphicsPipelineStages>();
-
-    auto stages = static_cast<GraphicsPipelineStages*>(m_data.get());
-    stages->vertexInputState = std::make_unique<VertexInputState>(attributes);
+    m_vertexInputState.emplace(attributes);
 
     return this;
 }
 
 
-GraphicsPipeline::State* GraphicsPipeline::State::setupInputAssembler(const VkPrimitiveTopology primitive) noexcept
+GraphicsPipeline::State* GraphicsPipeline::State::setupVertexInput(std::span<const VertexInputState::Binding> bindings) noexcept
 {
-    if(!m_data)
-        m_data = std::make_shared<GraphicsPipelineStages>();
+    m_vertexInputState.emplace(bindings);
+
+    return this;
+}
 
-    auto stages = static_cast<GraphicsPipelineStages*>(m_data.get());
 
-    stages->inputAssembly = VkPipelineInputAssemblyStateCreateInfo
+GraphicsPipeline::State* GraphicsPipeline::State::setupInputAssembler(const VkPrimitiveTopology primitive) noexcept
+{
+    m_inputAssembly = VkPipelineInputAssemblyStateCreateInfo
     {    
         .sType                  = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
         .pNext                  = nullptr,
@@ -71,12 +81,7 @@ GraphicsPipeline::State* GraphicsPipeline::State::setupInputAssembler(const VkPr
 
 GraphicsPipeline::State* GraphicsPipeline::State::setupViewport() noexcept
 {
-    if(!m_data)
-        m_data = std::make_shared<GraphicsPipelineStages>();
-
-    auto stages = static_cast<GraphicsPipelineStages*>(m_data.get());
-
-    stages->viewportState = VkPipelineViewportStateCreateInfo     
+    m_viewportState = VkPipelineViewportStateCreateInfo     
     {
         .sType         = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
         .pNext         = nullptr,
@@ -93,12 +98,7 @@ GraphicsPipeline::State* GraphicsPipeline::State::setupViewport() noexcept
 
 GraphicsPipeline::State* GraphicsPipeline::State::setupRasterization(VkPolygonMode mode) noexcept
 {
-    if(!m_data)
-        m_data = std::make_shared<GraphicsPipelineStages>();
-
-    auto stages = static_cast<GraphicsPipelineStages*>(m_data.get());
-
-    stages->rasterizer = VkPipelineRasterizationStateCreateInfo
+    m_rasterizer = VkPipelineRasterizationStateCreateInfo
     {
         .sType                   = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
         .pNext                   = nullptr,
@@ -121,12 +121,7 @@ GraphicsPipeline::State* GraphicsPipeline::State::setupRasterization(VkPolygonMo
 
 GraphicsPipeline::State* GraphicsPipeline::State::setupMultisampling() noexcept
 {
-    if(!m_data)
-        m_data = std::make_shared<GraphicsPipelineStages>();
-
-    auto stages = static_cast<GraphicsPipelineStages*>(m_data.get());
-
-    stages->multisampling = VkPipelineMultisampleStateCreateInfo
+    m_multisampling = VkPipelineMultisampleStateCreateInfo
     {
         .sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
         .pNext = nullptr,
@@ -143,14 +138,9 @@ GraphicsPipeline::State* GraphicsPipeline::State::setupMultisampling() noexcept
 }
 
 
-GraphicsPipeline::State* GraphicsPipeline::State::setupColorBlending(VkBool32 enabled) noexcept
+GraphicsPipeline::State* GraphicsPipeline::State::setupColorBlending(VkBool32 enabled, VkColorComponentFlags writeMask) noexcept
 {
-    if(!m_data)
-        m_data = std::make_shared<GraphicsPipelineStages>();
-
-    auto stages = static_cast<GraphicsPipelineStages*>(m_data.get());
-
-    stages->colorBlending = VkPipelineColorBlendAttachmentState
+    m_colorBlending = VkPipelineColorBlendAttachmentState
     {
         .blendEnable         = enabled,
         .srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA,
@@ -159,21 +149,36 @@ GraphicsPipeline::State* GraphicsPipeline::State::setupColorBlending(VkBool32 en
         .srcAlphaBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA,
         .dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA,
         .alphaBlendOp        = VK_BLEND_OP_ADD,
-        .colorWriteMask      = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT
+        .colorWriteMask      = writeMask
     };
     
     return this;
 }
 
 
+// Depth pre-pass: the depth-only pipeline keeps the defaults (write, LESS), 
+// the color pipeline drawn after it uses EQUAL without writes, so only the nearest fragment is shaded
+GraphicsPipeline::State* GraphicsPipeline::State::setupDepthStencil(VkBool32 writeEnabled, VkCompareOp compareOp) noexcept
+{
+    m_depthStencil.depthWriteEnable = writeEnabled;
+    m_depthStencil.depthCompareOp   = compareOp;
+    
+    return this;
+}
+
+
 GraphicsPipeline::State* GraphicsPipeline::State::setupDescriptorSetLayout(const DescriptorSetLayout& uniformDescriptorSet) noexcept
 {
-    if(!m_data)
-        m_data = std::make_shared<GraphicsPipelineStages>();
+    m_layoutInfo = uniformDescriptorSet;
+    
+    return this;
+}
 
-    auto stages = static_cast<GraphicsPipelineStages*>(m_data.get());
 
-    stages->layoutInfo = uniformDescriptorSet;
+
+GraphicsPipeline::State* GraphicsPipeline::State::setupPushConstants(VkShaderStageFlags shaderStages, uint32_t size) noexcept
+{
+    m_pushConstants = { shaderStages, 0, size };
     
     return this;
 }
@@ -191,9 +196,7 @@ GraphicsPipeline::GraphicsPipeline() noexcept:
 
 VkResult GraphicsPipeline::create(const class MainView& view, const GraphicsPipeline::State& state) noexcept
 {
-    auto stages = static_cast<GraphicsPipelineStages*>(state.m_data.get());
-
-    if(!stages)
+    if(state.m_shaderCount == 0)
         return VK_ERROR_INITIALIZATION_FAILED;
 
    auto GPU = view.getContext()->getPhysicalDevice();
@@ -214,12 +217,14 @@ VkResult GraphicsPipeline::create(const class MainView& view, const GraphicsPipe
         .stencilAttachmentFormat = VK_FORMAT_UNDEFINED
     };
 
-    const auto& shaderStages  = stages->shaders;
-    const auto vertexInput    = stages->vertexInputState->getinfo();
-    const auto& inputAssembly = stages->inputAssembly;
-    const auto& viewportState = stages->viewportState;
-    const auto& rasterizer    = stages->rasterizer;
-    const auto& multisampling = stages->multisampling;
+//  Mesh shading pipelines have neither vertex input nor input assembly
+    const bool meshShading    = !state.m_vertexInputState;
+    const auto& shaderStages  = state.m_shaders;
+    const auto vertexInput    = meshShading ? VkPipelineVertexInputStateCreateInfo{} : state.m_vertexInputState->getinfo();
+    const auto& inputAssembly = state.m_inputAssembly;
+    const auto& viewportState = state.m_viewportState;
+    const auto& rasterizer    = state.m_rasterizer;
+    const auto& multisampling = state.m_multisampling;
 
     VkPipelineColorBlendStateCreateInfo colorBlending
     {
@@ -229,7 +234,7 @@ VkResult GraphicsPipeline::create(const class MainView& view, const GraphicsPipe
         .logicOpEnable   = VK_FALSE,
         .logicOp         = VK_LOGIC_OP_COPY,
         .attachmentCount = 1,
-        .pAttachments    = &stages->colorBlending
+        .pAttachments    = &state.m_colorBlending
     };
 
     std::array<VkDynamicState, 2> dynamicStates = 
@@ -247,17 +252,12 @@ VkResult GraphicsPipeline::create(const class MainView& view, const GraphicsPipe
         .pDynamicStates    = dynamicStates.data()
     };
 
-    const VkDescriptorSetLayoutCreateInfo layoutInfo = stages->layoutInfo.getInfo();
+    const VkDescriptorSetLayoutCreateInfo layoutInfo = state.m_layoutInfo.getInfo();
 
     if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &m_descriptorSetLayout) != VK_SUCCESS)
         return VK_ERROR_INITIALIZATION_FAILED;
 
 
-    VkPushConstantRange pushConstantRange = {};
-    pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT; 
-    pushConstantRange.offset = 0; 
-    pushConstantRange.size = sizeof(mat4s);
-
     VkPipelineLayoutCreateInfo pipelineLayoutInfo = 
     {
         .sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
@@ -266,37 +266,23 @@ VkResult GraphicsPipeline::create(const class MainView& view, const GraphicsPipe
         .setLayoutCount         = 1,
         .pSetLayouts            = &m_descriptorSetLayout,
         .pushConstantRangeCount = 1,
-        .pPushConstantRanges    = &pushConstantRange
+        .pPushConstantRanges    = &state.m_pushConstants
     };
 
     if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &m_layout) != VK_SUCCESS)
         return VK_ERROR_INITIALIZATION_FAILED;
 
-    VkPipelineDepthStencilStateCreateInfo depthStencil = 
-    {
-        .sType                 = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
-        .pNext                 = VK_NULL_HANDLE,
-        .flags                 = 0,
-        .depthTestEnable       = VK_TRUE,
-        .depthWriteEnable      = VK_TRUE,
-        .depthCompareOp        = VK_COMPARE_OP_LESS,
-        .depthBoundsTestEnable = VK_FALSE,
-        .stencilTestEnable     = VK_FALSE,
-        .front                 = {},
-        .back                  = {},
-        .minDepthBounds        = 0.f,
-        .maxDepthBounds        = 1.f
-    };
+    const auto& depthStencil = state.m_depthStencil;
 
     VkGraphicsPipelineCreateInfo pipelineInfo = 
     {
         .sType               = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
         .pNext               = &pipelineRenderingInfo,
         .flags               = 0,
-        .stageCount          = static_cast<uint32_t>(shaderStages.size()),
+        .stageCount          = state.m_shaderCount,
         .pStages             = shaderStages.data(),
-        .pVertexInputState   = &vertexInput,
-        .pInputAssemblyState = &inputAssembly,
+        .pVertexInputState   = meshShading ? nullptr : &vertexInput,
+        .pInputAssemblyState = meshShading ? nullptr : &inputAssembly,
         .pTessellationState  = nullptr,
         .pViewportState      = &viewportState,
         .pRasterizationState = &rasterizer,
@@ -2,7 +2,8 @@
 #define GRAPHICS_PIPELINE_HPP
 
 #include <span>
-#include <memory>
+#include <array>
+#include <optional>
 
 #include <vulkan/vulkan.h>
 
@@ -11,22 +12,44 @@
 #include "vulkan_api/pipeline/stages/uniform/DescriptorSetLayout.hpp"
 
 
+// Classic pipelines read vertices through VertexInputState. A state without vertex input builds a mesh shading pipeline instead
+// (VK_EXT_mesh_shader): an optional task stage and a mesh stage fetch their own vertices, input assembly is skipped.
+// State keeps every description inline, so building a pipeline description needs no heap memory.
 class GraphicsPipeline
 {
 public:
     struct State
     {
+        State() noexcept;
+
         State* setupShaderStages(std::span<const ShaderStage> shaders)                   noexcept;
         State* setupVertexInput(std::span<const VertexInputState::Attribute> attributes) noexcept;
+        State* setupVertexInput(std::span<const VertexInputState::Binding> bindings)     noexcept;
         State* setupInputAssembler(const VkPrimitiveTopology primitive)                  noexcept;
         State* setupViewport()                                                           noexcept;
         State* setupRasterization(VkPolygonMode mode)                                    noexcept;
         State* setupMultisampling()                                                      noexcept;
-        State* setupColorBlending(VkBool32 enabled)                                      noexcept;
+        State* setupColorBlending(VkBool32 enabled, VkColorComponentFlags writeMask = 
+            VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT) noexcept;
+        State* setupDepthStencil(VkBool32 writeEnabled, VkCompareOp compareOp)           noexcept;
         State* setupDescriptorSetLayout(const DescriptorSetLayout& uniformDescriptorSet) noexcept;
+        State* setupPushConstants(VkShaderStageFlags shaderStages, uint32_t size)        noexcept; // the vertex stage gets a mat4 by default
 
     private:
-        std::shared_ptr<void> m_data;
+        static constexpr uint32_t MAX_SHADER_STAGES = 5;
+
+        std::array<VkPipelineShaderStageCreateInfo, MAX_SHADER_STAGES> m_shaders;
+        uint32_t                                                       m_shaderCount;
+        std::optional<VertexInputState>                                m_vertexInputState;
+        VkPipelineInputAssemblyStateCreateInfo                         m_inputAssembly;
+        VkPipelineViewportStateCreateInfo                              m_viewportState;
+        VkPipelineRasterizationStateCreateInfo                         m_rasterizer;
+        VkPipelineMultisampleStateCreateInfo                           m_multisampling;
+        VkPipelineColorBlendAttachmentState                            m_colorBlending;
+        VkPipelineDepthStencilStateCreateInfo                          m_depthStencil;
+        DescriptorSetLayout                                            m_layoutInfo;
+        VkPushConstantRange                                            m_pushConstants;
+
         friend class GraphicsPipeline;
     };
 
@@ -10,7 +10,7 @@ DescriptorPool::DescriptorPool(VkDevice device) noexcept:
 }
 
 
-VkResult DescriptorPool::create(std::span<const VkDescriptorPoolSize> poolSizes) noexcept
+VkResult DescriptorPool::create(std::span<const VkDescriptorPoolSize> poolSizes, uint32_t maxSets) noexcept
 {
     if(poolSizes.empty())
         return VK_ERROR_INITIALIZATION_FAILED;
@@ -23,7 +23,7 @@ VkResult DescriptorPool::create(std::span<const VkDescriptorPoolSize> poolSizes)
         .sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
         .pNext         = nullptr,
         .flags         = 0,
-        .maxSets       = MAX_FRAMES_IN_FLIGHT,
+        .maxSets       = maxSets,
         .poolSizeCount = static_cast<uint32_t>(poolSizes.size()),
         .pPoolSizes    = poolSizes.data()
     };
@@ -49,7 +49,7 @@ VkResult DescriptorPool::allocateDescriptorSets(std::span<VkDescriptorSet> descr
             .sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
             .pNext              = nullptr,
             .descriptorPool     = m_descriptorPool,
-            .descriptorSetCount = MAX_FRAMES_IN_FLIGHT,
+            .descriptorSetCount = static_cast<uint32_t>(descriptorSets.size()),
             .pSetLayouts        = layouts.data()
         };
 
@@ -80,6 +80,46 @@ void DescriptorPool::writeCombinedImageSampler(const VkDescriptorImageInfo* imag
 }
 
 
+void DescriptorPool::writeStorageImage(const VkDescriptorImageInfo* imageInfo, VkDescriptorSet descriptorSet, uint32_t dstBinding) noexcept
+{
+    VkWriteDescriptorSet descriptorWrite = 
+    {
+        .sType            = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+        .pNext            = nullptr,
+        .dstSet           = descriptorSet,
+        .dstBinding       = dstBinding,
+        .dstArrayElement  = 0,
+        .descriptorCount  = 1,
+        .descriptorType   = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+        .pImageInfo       = imageInfo,
+        .pBufferInfo      = nullptr,
+        .pTexelBufferView = nullptr
+    };
+
+    vkUpdateDescriptorSets(m_device, 1, &descriptorWrite, 0, nullptr);
+}
+
+
+void DescriptorPool::writeStorageBuffer(const VkDescriptorBufferInfo* bufferInfo, VkDescriptorSet descriptorSet, uint32_t dstBinding) noexcept
+{
+    VkWriteDescriptorSet descriptorWrite = 
+    {
+        .sType            = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+        .pNext            = nullptr,
+        .dstSet           = descriptorSet,
+        .dstBinding       = dstBinding,
+        .dstArrayElement  = 0,
+        .descriptorCount  = 1,
+        .descriptorType   = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+        .pImageInfo       = nullptr,
+        .pBufferInfo      = bufferInfo,
+        .pTexelBufferView = nullptr
+    };
+
+    vkUpdateDescriptorSets(m_device, 1, &descriptorWrite, 0, nullptr);
+}
+
+
 void DescriptorPool::destroy() noexcept
 {
     if(m_descriptorPool)
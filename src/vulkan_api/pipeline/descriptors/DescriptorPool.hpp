@@ -16,9 +16,11 @@ public:
     DescriptorPool& operator = (const DescriptorPool&) noexcept = delete;
     DescriptorPool& operator = (DescriptorPool&&) noexcept = delete;
 
-    VkResult create(std::span<const VkDescriptorPoolSize> poolSizes) noexcept;
+    VkResult create(std::span<const VkDescriptorPoolSize> poolSizes, uint32_t maxSets) noexcept;
     VkResult allocateDescriptorSets(std::span<VkDescriptorSet> descriptorSets, std::span<const VkDescriptorSetLayout> layouts) noexcept;
     void writeCombinedImageSampler(const VkDescriptorImageInfo* imageInfo, VkDescriptorSet descriptorSet, uint32_t dstBinding) noexcept;
+    void writeStorageImage(const VkDescriptorImageInfo* imageInfo, VkDescriptorSet descriptorSet, uint32_t dstBinding) noexcept;
+    void writeStorageBuffer(const VkDescriptorBufferInfo* bufferInfo, VkDescriptorSet descriptorSet, uint32_t dstBinding) noexcept;
 
     void destroy() noexcept;
 
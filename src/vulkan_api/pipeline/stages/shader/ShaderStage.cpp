@@ -16,37 +16,38 @@ ShaderStage::ShaderStage() noexcept:
 
 VkResult ShaderStage::loadFromFile(VkDevice device, VkShaderStageFlagBits stage, const std::filesystem::path& filepath) noexcept
 {
-    if (m_handle)
-        destroy(device);
+    std::vector<uint32_t> code;
 
-    std::ifstream stream;
-    stream.open(filepath, std::ios::ate | std::ios::binary);
+    if (!readFile(filepath, code))
+        return VK_ERROR_INITIALIZATION_FAILED;
 
-    if (stream.is_open())
-    {
-        size_t fileSize = (size_t)stream.tellg();
-        std::vector<char> byte_code(fileSize);
+    return create(device, stage, code);
+}
 
-        stream.seekg(0);
-        stream.read(byte_code.data(), fileSize);
-        stream.close();
 
-        const VkShaderModuleCreateInfo shaderModuleInfo = 
-        {
-            .sType    = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
-            .pNext    = nullptr,
-            .flags    = 0,
-            .codeSize = byte_code.size(),
-            .pCode    = reinterpret_cast<const uint32_t*>(byte_code.data())
-        };
+VkResult ShaderStage::create(VkDevice device, VkShaderStageFlagBits stage, std::span<const uint32_t> code) noexcept
+{
+    if (m_handle)
+        destroy(device);
 
-        if (auto result = vkCreateShaderModule(device, &shaderModuleInfo, nullptr, &m_handle); result == VK_SUCCESS)
-        {
-            m_stage = stage;
+    if (code.empty())
+        return VK_ERROR_INITIALIZATION_FAILED;
+
+    const VkShaderModuleCreateInfo shaderModuleInfo = 
+    {
+        .sType    = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+        .pNext    = nullptr,
+        .flags    = 0,
+        .codeSize = code.size_bytes(),
+        .pCode    = code.data()
+    };
+
+    if (auto result = vkCreateShaderModule(device, &shaderModuleInfo, nullptr, &m_handle); result == VK_SUCCESS)
+    {
+        m_stage = stage;
 
-            return result;
-        }
-    } 
+        return result;
+    }
 
     return VK_ERROR_INITIALIZATION_FAILED;
 }
@@ -82,4 +83,27 @@ VkPipelineShaderStageCreateInfo ShaderStage::getInfo() const noexcept
     }
 
     return {};
+}
+
+
+// SPIR-V is a stream of 32-bit words, reading into words keeps pCode aligned
+bool ShaderStage::readFile(const std::filesystem::path& filepath, std::vector<uint32_t>& code) noexcept
+{
+    std::ifstream stream;
+    stream.open(filepath, std::ios::ate | std::ios::binary);
+
+    if (!stream.is_open())
+        return false;
+
+    const size_t fileSize = (size_t)stream.tellg();
+
+    if (fileSize == 0 || fileSize % sizeof(uint32_t) != 0)
+        return false;
+
+    code.resize(fileSize / sizeof(uint32_t));
+
+    stream.seekg(0);
+    stream.read(reinterpret_cast<char*>(code.data()), fileSize);
+
+    return !stream.fail();
 }
\ No newline at end of file
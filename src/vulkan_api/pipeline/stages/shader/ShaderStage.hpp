@@ -1,6 +1,9 @@
 #ifndef SHADER_MODULE_HPP
 #define SHADER_MODULE_HPP
 
+#include <span>
+#include <vector>
+#include <cstdint>
 #include <filesystem>
 
 #include <vulkan/vulkan.h>
@@ -12,8 +15,12 @@ public:
     ShaderStage() noexcept;
 
     VkResult loadFromFile(VkDevice device, VkShaderStageFlagBits stage, const std::filesystem::path& filepath) noexcept;
+    VkResult create(VkDevice device, VkShaderStageFlagBits stage, std::span<const uint32_t> code) noexcept;
     void destroy(VkDevice device) noexcept;
 
+//  Needs no device, so SPIR-V can be read while the device is still being created
+    static bool readFile(const std::filesystem::path& filepath, std::vector<uint32_t>& code) noexcept;
+
     VkPipelineShaderStageCreateInfo getInfo() const noexcept;
 
 private:
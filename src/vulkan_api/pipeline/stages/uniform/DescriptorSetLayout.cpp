@@ -1,26 +1,27 @@
 #include "vulkan_api/pipeline/stages/uniform/DescriptorSetLayout.hpp"
 
 
-void DescriptorSetLayout::addDescriptor(VkDescriptorType type, VkShaderStageFlagBits shaderStage) noexcept
+void DescriptorSetLayout::addDescriptor(VkDescriptorType type, VkShaderStageFlags shaderStages) noexcept
 {
-    const uint32_t binding = m_bindings.size();
-    const VkShaderStageFlags flags = shaderStage;
-
-    m_bindings.emplace_back(VkDescriptorSetLayoutBinding
-        {
-            .binding            = binding,
-            .descriptorType     = type,
-            .descriptorCount    = 1,
-            .stageFlags         = flags,
-            .pImmutableSamplers = nullptr
-        }
-    );
+    if(m_bindingCount == MAX_BINDINGS)
+        return;
+
+    const uint32_t binding = m_bindingCount++;
+
+    m_bindings[binding] = VkDescriptorSetLayoutBinding
+    {
+        .binding            = binding,
+        .descriptorType     = type,
+        .descriptorCount    = 1,
+        .stageFlags         = shaderStages,
+        .pImmutableSamplers = nullptr
+    };
 }
 
 
 void DescriptorSetLayout::reset() noexcept
 {
-    m_bindings.clear();
+    m_bindingCount = 0;
 }
 
 
@@ -31,7 +32,7 @@ VkDescriptorSetLayoutCreateInfo DescriptorSetLayout::getInfo() const noexcept
         .sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
         .pNext        = nullptr,
         .flags        = 0,
-        .bindingCount = static_cast<uint32_t>(m_bindings.size()),
+        .bindingCount = m_bindingCount,
         .pBindings    = m_bindings.data()
     };
 }
@@ -1,21 +1,26 @@
 #ifndef DESCRIPTOR_SET_LAYOUT_HPP
 #define DESCRIPTOR_SET_LAYOUT_HPP
 
-#include <vector>
+#include <array>
+#include <cstdint>
 
 #include <vulkan/vulkan.h>
 
 
+// Bindings are numbered in the order they are added
 class DescriptorSetLayout
 {
 public:
-    void addDescriptor(VkDescriptorType type, VkShaderStageFlagBits shaderStage) noexcept;
+    static constexpr uint32_t MAX_BINDINGS = 16;
+
+    void addDescriptor(VkDescriptorType type, VkShaderStageFlags shaderStages) noexcept;
     void reset() noexcept;
 
     VkDescriptorSetLayoutCreateInfo getInfo() const noexcept;
 
 private:
-    std::vector<VkDescriptorSetLayoutBinding> m_bindings;
+    std::array<VkDescriptorSetLayoutBinding, MAX_BINDINGS> m_bindings {};
+    uint32_t                                               m_bindingCount = 0;
 };
 
 #endif // !DESCRIPTOR_SET_LAYOUT_HPP
\ No newline at end of file
@@ -1,3 +1,8 @@
+#include <bit>
+#include <cmath>
+#include <array>
+#include <algorithm>
+
 #include "vulkan_api/pipeline/stages/vertex/VertexInputState.hpp"
 
 namespace
@@ -12,6 +17,9 @@ namespace
 
             case VertexInputState::Attribute::Type::Float2:
             case VertexInputState::Attribute::Type::Int2:
+            case VertexInputState::Attribute::Type::Half2:
+            case VertexInputState::Attribute::Type::Snorm16x2:
+            case VertexInputState::Attribute::Type::Unorm16x2:
                 return 2;
 
             case VertexInputState::Attribute::Type::Float3:
@@ -20,6 +28,12 @@ namespace
 
             case VertexInputState::Attribute::Type::Float4:
             case VertexInputState::Attribute::Type::Int4:
+            case VertexInputState::Attribute::Type::Half4:
+            case VertexInputState::Attribute::Type::Snorm16x4:
+            case VertexInputState::Attribute::Type::Unorm16x4:
+            case VertexInputState::Attribute::Type::Unorm8x4:
+            case VertexInputState::Attribute::Type::A2B10G10R10Unorm:
+            case VertexInputState::Attribute::Type::A2B10G10R10Snorm:
                 return 4;
         }
 
@@ -42,6 +56,19 @@ namespace
             case VertexInputState::Attribute::Type::Int3:
             case VertexInputState::Attribute::Type::Int4:
                 return sizeof(int32_t) * shader_attribute_type_to_component_count(type);
+
+            case VertexInputState::Attribute::Type::Half2:
+            case VertexInputState::Attribute::Type::Half4:
+            case VertexInputState::Attribute::Type::Snorm16x2:
+            case VertexInputState::Attribute::Type::Snorm16x4:
+            case VertexInputState::Attribute::Type::Unorm16x2:
+            case VertexInputState::Attribute::Type::Unorm16x4:
+                return sizeof(uint16_t) * shader_attribute_type_to_component_count(type);
+
+            case VertexInputState::Attribute::Type::Unorm8x4:
+            case VertexInputState::Attribute::Type::A2B10G10R10Unorm:
+            case VertexInputState::Attribute::Type::A2B10G10R10Snorm:
+                return sizeof(uint32_t);
         }
 
         return 0;
@@ -61,10 +88,27 @@ namespace
             case VertexInputState::Attribute::Type::Int2: return VK_FORMAT_R32G32_SINT;
             case VertexInputState::Attribute::Type::Int3: return VK_FORMAT_R32G32B32_SINT;
             case VertexInputState::Attribute::Type::Int4: return VK_FORMAT_R32G32B32A32_SINT;
+
+            case VertexInputState::Attribute::Type::Half2:     return VK_FORMAT_R16G16_SFLOAT;
+            case VertexInputState::Attribute::Type::Half4:     return VK_FORMAT_R16G16B16A16_SFLOAT;
+            case VertexInputState::Attribute::Type::Snorm16x2: return VK_FORMAT_R16G16_SNORM;
+            case VertexInputState::Attribute::Type::Snorm16x4: return VK_FORMAT_R16G16B16A16_SNORM;
+            case VertexInputState::Attribute::Type::Unorm16x2: return VK_FORMAT_R16G16_UNORM;
+            case VertexInputState::Attribute::Type::Unorm16x4: return VK_FORMAT_R16G16B16A16_UNORM;
+            case VertexInputState::Attribute::Type::Unorm8x4:  return VK_FORMAT_R8G8B8A8_UNORM;
+
+            case VertexInputState::Attribute::Type::A2B10G10R10Unorm: return VK_FORMAT_A2B10G10R10_UNORM_PACK32;
+            case VertexInputState::Attribute::Type::A2B10G10R10Snorm: return VK_FORMAT_A2B10G10R10_SNORM_PACK32;
         }
 
         return VK_FORMAT_UNDEFINED;
     }
+
+
+    uint32_t quantize(float value, float lowest, float scale) noexcept
+    {
+        return static_cast<uint32_t>(static_cast<int32_t>(std::lround(std::clamp(value, lowest, 1.f) * scale)));
+    }
 }
 
 
@@ -77,25 +121,45 @@ VertexInputState::Attribute::Attribute(const Type attrType) noexcept:
 }
 
 
-VertexInputState::VertexInputState(std::span<const VertexInputState::Attribute> attributes) noexcept
+VertexInputState::VertexInputState(std::span<const VertexInputState::Attribute> attributes) noexcept:
+    VertexInputState(std::array<const Binding, 1>{ Binding{ .attributes = attributes } })
 {
-    m_attributeDescription.resize(attributes.size());
-    uint32_t offset = 0;
 
-    for (uint32_t i = 0; i < m_attributeDescription.size(); ++i)
+}
+
+
+VertexInputState::VertexInputState(std::span<const VertexInputState::Binding> bindings) noexcept:
+    m_attributeDescription(),
+    m_bindingDescription(),
+    m_attributeCount(0),
+    m_bindingCount(std::min(static_cast<uint32_t>(bindings.size()), MAX_BINDINGS))
+{
+    uint32_t location = 0;
+
+    for (uint32_t binding = 0; binding < m_bindingCount; ++binding)
     {
-        m_attributeDescription[i].location = i;
-        m_attributeDescription[i].binding = 0;
-        m_attributeDescription[i].format = shader_attribute_type_to_vk_format(attributes[i].type);
-        m_attributeDescription[i].offset = offset;
+        uint32_t offset = 0;
 
-        uint32_t sizeInBytes = shader_attribute_type_sizeof(attributes[i].type);
-        offset += sizeInBytes;
-    }
+        for (const auto& attribute : bindings[binding].attributes)
+        {
+            if(m_attributeCount < MAX_ATTRIBUTES)
+            {
+                m_attributeDescription[m_attributeCount++] =
+                {
+                    .location = location++,
+                    .binding  = binding,
+                    .format   = shader_attribute_type_to_vk_format(attribute.type),
+                    .offset   = offset
+                };
+            }
+
+            offset += static_cast<uint32_t>(shader_attribute_type_sizeof(attribute.type));
+        }
 
-    m_bindingDescription.binding = 0;
-    m_bindingDescription.stride = offset;
-    m_bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+        m_bindingDescription[binding].binding   = binding;
+        m_bindingDescription[binding].stride    = std::max(bindings[binding].stride, offset);
+        m_bindingDescription[binding].inputRate = bindings[binding].inputRate;
+    }
 }
 
 
@@ -106,9 +170,61 @@ VkPipelineVertexInputStateCreateInfo VertexInputState::getinfo() const noexcept
         .sType                           = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
         .pNext                           = nullptr,
         .flags                           = 0,
-        .vertexBindingDescriptionCount   = 1,
-        .pVertexBindingDescriptions      = &m_bindingDescription,
-        .vertexAttributeDescriptionCount = static_cast<uint32_t>(m_attributeDescription.size()),
+        .vertexBindingDescriptionCount   = m_bindingCount,
+        .pVertexBindingDescriptions      = m_bindingDescription.data(),
+        .vertexAttributeDescriptionCount = m_attributeCount,
         .pVertexAttributeDescriptions    = m_attributeDescription.data()
     };
+}
+
+
+// Round to nearest even, overflow goes to infinity and values below the normal range become denormals
+uint16_t VertexInputState::packHalf(float value) noexcept
+{
+    const uint32_t bits     = std::bit_cast<uint32_t>(value);
+    const uint32_t sign     = (bits >> 16) & 0x8000;
+    const uint32_t absolute = bits & 0x7FFFFFFF;
+
+    if (absolute >= 0x7F800000) // inf and NaN
+        return static_cast<uint16_t>(sign | 0x7C00 | ((absolute > 0x7F800000) ? 0x200 : 0));
+
+    if (absolute >= 0x477FF000) // rounds past 65504
+        return static_cast<uint16_t>(sign | 0x7C00);
+
+    if (absolute < 0x38800000) // below 2^-14, in units of 2^-24
+        return static_cast<uint16_t>(sign | static_cast<uint32_t>(std::nearbyint(std::bit_cast<float>(absolute) * 16777216.f)));
+
+    const uint32_t rounded = absolute + 0xFFF + ((absolute >> 13) & 1);
+
+    return static_cast<uint16_t>(sign | ((rounded - 0x38000000) >> 13));
+}
+
+
+uint16_t VertexInputState::packUnorm16(float value) noexcept
+{
+    return static_cast<uint16_t>(quantize(value, 0.f, 65535.f));
+}
+
+
+int16_t VertexInputState::packSnorm16(float value) noexcept
+{
+    return static_cast<int16_t>(quantize(value, -1.f, 32767.f));
+}
+
+
+uint8_t VertexInputState::packUnorm8(float value) noexcept
+{
+    return static_cast<uint8_t>(quantize(value, 0.f, 255.f));
+}
+
+
+uint32_t VertexInputState::packA2B10G10R10Unorm(float x, float y, float z, float w) noexcept
+{
+    return quantize(x, 0.f, 1023.f) | (quantize(y, 0.f, 1023.f) << 10) | (quantize(z, 0.f, 1023.f) << 20) | (quantize(w, 0.f, 3.f) << 30);
+}
+
+
+uint32_t VertexInputState::packA2B10G10R10Snorm(float x, float y, float z, float w) noexcept
+{
+    return (quantize(x, -1.f, 511.f) & 0x3FF) | ((quantize(y, -1.f, 511.f) & 0x3FF) << 10) | ((quantize(z, -1.f, 511.f) & 0x3FF) << 20) | (quantize(w, -1.f, 1.f) << 30);
 }
\ No newline at end of file
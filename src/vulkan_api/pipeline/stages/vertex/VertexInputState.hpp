@@ -3,7 +3,7 @@
 
 #include <cstdint>
 #include <span>
-#include <vector>
+#include <array>
 
 #include <vulkan/vulkan.h>
 
@@ -23,7 +23,19 @@ public:
             Int,
             Int2,
             Int3,
-            Int4
+            Int4,
+
+        //  Compact types, read as floats by the shader.
+        //  There are no 3-component 16-bit types, they are poorly supported for vertex input: use the 4-component ones
+            Half2,
+            Half4,
+            Snorm16x2,
+            Snorm16x4,
+            Unorm16x2,
+            Unorm16x4,
+            Unorm8x4,
+            A2B10G10R10Unorm, // x in the low bits, w in the 2 high ones
+            A2B10G10R10Snorm
         };
 
         Attribute(const Type attrType) noexcept;
@@ -32,13 +44,36 @@ public:
         size_t sizeInBytes;
     };
 
-    VertexInputState(std::span<const Attribute> attributes) noexcept;
+//  Attributes of a binding are packed in order, locations continue from one binding to the next
+    struct Binding
+    {
+        std::span<const Attribute> attributes;
+        uint32_t                   stride    = 0; // 0 packs the attributes tightly
+        VkVertexInputRate          inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+    };
+
+    VertexInputState(std::span<const Attribute> attributes) noexcept; // single tightly packed per-vertex binding
+    VertexInputState(std::span<const Binding> bindings) noexcept;
 
     VkPipelineVertexInputStateCreateInfo getinfo() const noexcept;
 
+//  CPU side encoders of the compact types
+    static uint16_t packHalf(float value)    noexcept;
+    static uint16_t packUnorm16(float value) noexcept;
+    static int16_t  packSnorm16(float value) noexcept;
+    static uint8_t  packUnorm8(float value)  noexcept;
+    static uint32_t packA2B10G10R10Unorm(float x, float y, float z, float w) noexcept;
+    static uint32_t packA2B10G10R10Snorm(float x, float y, float z, float w) noexcept;
+
+//  The limits every Vulkan implementation supports, extra attributes or bindings are dropped
+    static constexpr uint32_t MAX_ATTRIBUTES = 16;
+    static constexpr uint32_t MAX_BINDINGS   = 16;
+
 private:
-    std::vector<VkVertexInputAttributeDescription> m_attributeDescription;
-    VkVertexInputBindingDescription m_bindingDescription;
+    std::array<VkVertexInputAttributeDescription, MAX_ATTRIBUTES> m_attributeDescription;
+    std::array<VkVertexInputBindingDescription, MAX_BINDINGS>     m_bindingDescription;
+    uint32_t                                                      m_attributeCount;
+    uint32_t                                                      m_bindingCount;
 };
 
 #endif // !VERTEX_INPUT_STATE_HPP
\ No newline at end of file
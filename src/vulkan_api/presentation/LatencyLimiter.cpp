@@ -0,0 +1,91 @@
+#include <thread>
+#include <algorithm>
+
+#include "vulkan_api/context/VulkanContext.hpp"
+#include "vulkan_api/presentation/LatencyLimiter.hpp"
+
+
+namespace
+{
+//  A present can get lost (minimized window, out of date swapchain), so waiting is bounded
+    constexpr uint64_t MAX_WAIT_NS = 100'000'000;
+
+    constexpr float DEFAULT_REFRESH_PERIOD = 1.f / 60.f;
+    constexpr float MIN_WORK_ESTIMATE      = 0.001f;
+
+//  The work estimate grows fast after a missed vblank and shrinks slowly while frames make it
+    constexpr float MISS_INCREASE = 0.25f; // fractions of the refresh period
+    constexpr float HIT_DECREASE  = 0.01f;
+}
+
+
+LatencyLimiter::LatencyLimiter() noexcept:
+    m_device(nullptr),
+    m_waitForPresent(nullptr),
+    m_presentId(0),
+    m_refreshPeriod(DEFAULT_REFRESH_PERIOD),
+    m_workEstimate(DEFAULT_REFRESH_PERIOD)
+{
+
+}
+
+
+bool LatencyLimiter::create(const VulkanContext& context) noexcept
+{
+    if(!context.isPresentWaitSupported())
+        return false;
+
+    m_device         = context.getDevice();
+    m_waitForPresent = reinterpret_cast<PFN_vkWaitForPresentKHR>(vkGetDeviceProcAddr(m_device, "vkWaitForPresentKHR"));
+
+    reset();
+
+    return (m_waitForPresent != nullptr);
+}
+
+
+void LatencyLimiter::reset() noexcept
+{
+    m_presentId   = 0;
+    m_lastPresent = Clock::now();
+}
+
+
+void LatencyLimiter::wait(VkSwapchainKHR swapchain) noexcept
+{
+    if(m_presentId == 0 || !m_waitForPresent)
+        return;
+
+    const VkResult result = m_waitForPresent(m_device, swapchain, m_presentId, MAX_WAIT_NS);
+    const auto now = Clock::now();
+
+    if(result != VK_SUCCESS)
+        return;
+
+    const float interval = std::chrono::duration<float>(now - m_lastPresent).count();
+
+//  The frame was due one period after the previous present, anything later missed that vblank
+    if(interval > 1.5f * m_refreshPeriod)
+    {
+        m_workEstimate += MISS_INCREASE * m_refreshPeriod;
+    }
+    else
+    {
+        m_refreshPeriod += 0.1f * (interval - m_refreshPeriod);
+        m_workEstimate  -= HIT_DECREASE * m_refreshPeriod;
+    }
+
+    m_workEstimate = std::clamp(m_workEstimate, MIN_WORK_ESTIMATE, m_refreshPeriod);
+    m_lastPresent  = now;
+
+    const float slack = m_refreshPeriod - m_workEstimate;
+
+    if(slack > 0.f)
+        std::this_thread::sleep_until(now + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(slack)));
+}
+
+
+uint64_t LatencyLimiter::nextPresentId() noexcept
+{
+    return ++m_presentId;
+}
\ No newline at end of file
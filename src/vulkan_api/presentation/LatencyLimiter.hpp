@@ -0,0 +1,36 @@
+#ifndef LATENCY_LIMITER_HPP
+#define LATENCY_LIMITER_HPP
+
+#include <chrono>
+
+#include <vulkan/vulkan.h>
+
+
+// Low-latency pacing on top of VK_KHR_present_id / VK_KHR_present_wait.
+// Every present carries an increasing id. Before a frame starts, wait() blocks until the previous
+// present is on screen and then sleeps until only the estimated frame time is left before the next vblank,
+// so input is sampled as late as possible. This keeps at most one frame queued regardless of frames in flight.
+class LatencyLimiter
+{
+public:
+    LatencyLimiter() noexcept;
+
+    bool create(const class VulkanContext& context) noexcept; // false when present wait is not supported
+    void reset() noexcept;                                    // present ids restart with every swapchain
+
+    void     wait(VkSwapchainKHR swapchain) noexcept;
+    uint64_t nextPresentId() noexcept;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    VkDevice                m_device;
+    PFN_vkWaitForPresentKHR m_waitForPresent;
+
+    uint64_t          m_presentId;     // id of the last present handed to the queue
+    Clock::time_point m_lastPresent;   // when the previous wait returned, roughly the last vblank
+    float             m_refreshPeriod; // seconds, smoothed
+    float             m_workEstimate;  // seconds of CPU + GPU work to budget before the vblank
+};
+
+#endif // !LATENCY_LIMITER_HPP
\ No newline at end of file
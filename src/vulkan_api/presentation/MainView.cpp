@@ -1,5 +1,6 @@
-#include <vector>
-#include <memory>
+#include <span>
+#include <climits>
+#include <algorithm>
 
 #include <GLFW/glfw3.h>
 #include <GLFW/glfw3native.h>
@@ -38,34 +39,39 @@ namespace
             return {};
         }
 
-        VkSurfaceCapabilitiesKHR		capabilities;
-        std::vector<VkSurfaceFormatKHR> formats;
-        std::vector<VkPresentModeKHR>	presentModes;
+        VkSurfaceCapabilitiesKHR      capabilities;
+        std::span<VkSurfaceFormatKHR> formats;
+        std::span<VkPresentModeKHR>   presentModes;
     };
 
 
-    std::unique_ptr<SwapChainSupportDetails> query_swapchain_support(VkPhysicalDevice device, VkSurfaceKHR surface) noexcept
+//  The arrays live in the scratch arena, they are valid until the caller's scope rewinds it
+    SwapChainSupportDetails query_swapchain_support(VkPhysicalDevice device, VkSurfaceKHR surface, LinearAllocator& scratch) noexcept
     {
-        auto details = std::make_unique<SwapChainSupportDetails>();
+        SwapChainSupportDetails details = {};
 
-        vkGetPhysicalDeviceSurfaceCapabilitiesKHR(device, surface, &details->capabilities);
+        vkGetPhysicalDeviceSurfaceCapabilitiesKHR(device, surface, &details.capabilities);
 
-        uint32_t formatCount;
+        uint32_t formatCount = 0;
         vkGetPhysicalDeviceSurfaceFormatsKHR(device, surface, &formatCount, nullptr);
 
         if (formatCount != 0) 
         {
-            details->formats.resize(formatCount);
-            vkGetPhysicalDeviceSurfaceFormatsKHR(device, surface, &formatCount, details->formats.data());
+            details.formats = scratch.allocate<VkSurfaceFormatKHR>(formatCount);
+            formatCount     = static_cast<uint32_t>(details.formats.size());
+            vkGetPhysicalDeviceSurfaceFormatsKHR(device, surface, &formatCount, details.formats.data());
+            details.formats = details.formats.first(formatCount);
         }
 
-        uint32_t presentModeCount;
+        uint32_t presentModeCount = 0;
         vkGetPhysicalDeviceSurfacePresentModesKHR(device, surface, &presentModeCount, nullptr);
 
         if (presentModeCount != 0) 
         {
-            details->presentModes.resize(presentModeCount);
-            vkGetPhysicalDeviceSurfacePresentModesKHR(device, surface, &presentModeCount, details->presentModes.data());
+            details.presentModes = scratch.allocate<VkPresentModeKHR>(presentModeCount);
+            presentModeCount     = static_cast<uint32_t>(details.presentModes.size());
+            vkGetPhysicalDeviceSurfacePresentModesKHR(device, surface, &presentModeCount, details.presentModes.data());
+            details.presentModes = details.presentModes.first(presentModeCount);
         }
 
         return details;
@@ -81,8 +87,11 @@ MainView::MainView() noexcept:
     m_depthImage(VK_NULL_HANDLE),
     m_depthImageMemory(VK_NULL_HANDLE),
     m_depthImageView(VK_NULL_HANDLE),
+    m_depthExtent({}),
     m_format(VK_FORMAT_UNDEFINED),
-    m_extent({})
+    m_extent({}),
+    m_presentMode(VK_PRESENT_MODE_FIFO_KHR),
+    m_requestedImageCount(0)
 {
 
 }
@@ -91,9 +100,10 @@ MainView::MainView() noexcept:
 MainView::~MainView() = default;
 
 
-VkResult MainView::create(VulkanContext& context, GLFWwindow* window) noexcept
+VkResult MainView::create(VulkanContext& context, GLFWwindow* window, uint32_t imageCount) noexcept
 {
     m_context = &context;
+    m_requestedImageCount = imageCount;
 
 #ifdef _WIN32
     const VkWin32SurfaceCreateInfoKHR surfaceInfo = 
@@ -124,7 +134,7 @@ VkResult MainView::create(VulkanContext& context, GLFWwindow* window) noexcept
         .window = static_cast<xcb_window_t>(glfwGetX11Window(window))
     };
 
-    if (vkCreateXcbSurfaceKHR(api.getInstance(), &surfaceInfo, nullptr, &m_surface) == VK_SUCCESS)
+    if (vkCreateXcbSurfaceKHR(context.getInstance(), &surfaceInfo, nullptr, &m_surface) == VK_SUCCESS)
         return recreate(true);
 #endif
 
@@ -154,21 +164,23 @@ VkResult MainView::recreate(bool depth) noexcept
     {
         auto phisycalDevice = m_context->getPhysicalDevice();
         auto device = m_context->getDevice();
+        auto& deletionQueue = m_context->getDeletionQueue();
 
-        if(m_swapchain)
-        {
-            for (auto imageView : m_imageViews)
-            	vkDestroyImageView(device, imageView, nullptr);
+        auto& scratch = m_context->getScratchAllocator();
+        LinearAllocator::Scope scratchScope(scratch);
 
-            vkDestroySwapchainKHR(device, m_swapchain, nullptr);
-            m_swapchain = nullptr;
-        }
+        const auto swapChainSupport = query_swapchain_support(phisycalDevice, m_surface, scratch);
+        const auto& capabilities    = swapChainSupport.capabilities;
+
+    //  maxImageCount == 0 means no upper limit
+        uint32_t minImageCount = std::max(m_requestedImageCount, capabilities.minImageCount);
 
-        auto swapChainSupport = query_swapchain_support(phisycalDevice, m_surface);
-        const uint32_t minImageCount = swapChainSupport->capabilities.minImageCount;
+        if (capabilities.maxImageCount)
+            minImageCount = std::min(minImageCount, capabilities.maxImageCount);
 
-        m_format = swapChainSupport->getSurfaceFormat().format;
-        m_extent = choose_swap_extent(swapChainSupport->capabilities, m_extent);
+        m_format      = swapChainSupport.getSurfaceFormat().format;
+        m_extent      = choose_swap_extent(swapChainSupport.capabilities, m_extent);
+        m_presentMode = swapChainSupport.getPresentMode();
 
         const VkSwapchainCreateInfoKHR swapchainInfo = 
         {
@@ -181,29 +193,38 @@ VkResult MainView::recreate(bool depth) noexcept
             .imageColorSpace       = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR,
             .imageExtent           = m_extent,
             .imageArrayLayers      = 1,
-            .imageUsage            = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+            .imageUsage            = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT, // blit target of dynamic resolution
             .imageSharingMode      = VK_SHARING_MODE_EXCLUSIVE,
             .queueFamilyIndexCount = 0,
             .pQueueFamilyIndices   = nullptr,
-            .preTransform          = swapChainSupport->capabilities.currentTransform,
+            .preTransform          = swapChainSupport.capabilities.currentTransform,
             .compositeAlpha        = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR,
-            .presentMode           = swapChainSupport->getPresentMode(),
+            .presentMode           = m_presentMode,
             .clipped               = VK_TRUE,
             .oldSwapchain          = m_swapchain
         };
 
-        if (vkCreateSwapchainKHR(device, &swapchainInfo, nullptr, &m_swapchain) == VK_SUCCESS)
+        VkSwapchainKHR swapchain = VK_NULL_HANDLE;
+        const VkResult result = vkCreateSwapchainKHR(device, &swapchainInfo, nullptr, &swapchain);
+
+    //  The old swapchain is retired even if the creation failed, queued frames may still use its images
+        for (auto imageView : m_imageViews)
+            deletionQueue.retire(imageView);
+
+        deletionQueue.retire(m_swapchain);
+        m_imageViews.clear();
+
+        m_swapchain = swapchain;
+
+        if (result == VK_SUCCESS)
         {
             uint32_t imageCount = 0;
             
             if(vkGetSwapchainImagesKHR(device, m_swapchain, &imageCount, nullptr) != VK_SUCCESS)
                 return VK_ERROR_INITIALIZATION_FAILED;
 
-            if(m_images.empty())
-                m_images.resize(imageCount);
-
-            if(m_imageViews.empty())
-                m_imageViews.resize(imageCount);
+            m_images.resize(imageCount);
+            m_imageViews.resize(imageCount);
 
             if (vkGetSwapchainImagesKHR(device, m_swapchain, &imageCount, m_images.data()) == VK_SUCCESS)
             {
@@ -213,16 +234,15 @@ VkResult MainView::recreate(bool depth) noexcept
                         return VK_ERROR_INITIALIZATION_FAILED;  
                 }
 
-                if (depth)
+            //  The depth buffer only grows, rendering to a smaller extent just uses its corner
+                if (depth && (!m_depthImage || m_extent.width > m_depthExtent.width || m_extent.height > m_depthExtent.height))
                 {
-                    if (m_depthImageView)
-                        vkDestroyImageView(device, m_depthImageView, VK_NULL_HANDLE);
-
-                    if (m_depthImage)
-                        vkDestroyImage(device, m_depthImage, VK_NULL_HANDLE);
+                    deletionQueue.retire(m_depthImageView);
+                    deletionQueue.retire(m_depthImage, m_depthImageMemory);
 
-                    if (m_depthImageMemory)
-                        vkFreeMemory(device, m_depthImageMemory, VK_NULL_HANDLE);
+                    m_depthImage       = VK_NULL_HANDLE;
+                    m_depthImageMemory = VK_NULL_HANDLE;
+                    m_depthImageView   = VK_NULL_HANDLE;
 
                     createDepthResources();
                 }
@@ -243,6 +263,9 @@ void MainView::destroy() noexcept
         auto instance = m_context->getInstance();
         auto device   = m_context->getDevice();
 
+    //  Retired swapchains must go before the surface
+        m_context->getDeletionQueue().collect(UINT64_MAX);
+
         if(m_swapchain)
         {
             for (auto imageView : m_imageViews)
@@ -284,6 +307,18 @@ const VkExtent2D& MainView::getExtent() const noexcept
 }
 
 
+uint32_t MainView::getImageCount() const noexcept
+{
+    return static_cast<uint32_t>(m_images.size());
+}
+
+
+VkPresentModeKHR MainView::getPresentMode() const noexcept
+{
+    return m_presentMode;
+}
+
+
 VkImage MainView::getImage(uint32_t index) const noexcept
 {
     return m_images[index];
@@ -296,6 +331,12 @@ VkImageView MainView::getImageView(uint32_t index) const noexcept
 }
 
 
+VkImage MainView::getDepthImage() const noexcept
+{
+    return m_depthImage;
+}
+
+
 VkImageView MainView::getDepthImageView() const noexcept
 {
     return m_depthImageView;
@@ -314,8 +355,9 @@ void MainView::createDepthResources() noexcept
     {
         if (VkFormat depthFormat = vk::findDepthFormat(m_context->getPhysicalDevice()); depthFormat != VK_FORMAT_UNDEFINED)
         {
-            vk::createImage2D(m_extent.width, m_extent.height, depthFormat, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_depthImage, m_depthImageMemory, m_context->getPhysicalDevice(), device);
+            vk::createImage2D(m_extent.width, m_extent.height, depthFormat, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_depthImage, m_depthImageMemory, m_context->getPhysicalDevice(), device);
             vk::createImageView2D(device, m_depthImage, depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT, m_depthImageView);
+            m_depthExtent = m_extent;
         }
     }
 }
\ No newline at end of file
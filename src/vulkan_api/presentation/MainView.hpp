@@ -12,16 +12,21 @@ public:
     MainView() noexcept;
     ~MainView();
 
-    VkResult create(VulkanContext& context, struct GLFWwindow* window) noexcept;
+//  imageCount is a request, the surface limits clamp it
+    VkResult create(VulkanContext& context, struct GLFWwindow* window, uint32_t imageCount) noexcept;
+//  The replaced swapchain, its views and an outgrown depth buffer go to the context's deletion queue
     VkResult recreate(bool depth) noexcept;
     void     destroy()  noexcept;
 
     VkSwapchainKHR&   getSwapchain() noexcept;
     VkFormat          getFormat()    const noexcept;
     const VkExtent2D& getExtent()    const noexcept;
+    uint32_t          getImageCount() const noexcept;
+    VkPresentModeKHR  getPresentMode() const noexcept;
 
     VkImage     getImage(uint32_t index)     const noexcept;
     VkImageView getImageView(uint32_t index) const noexcept;
+    VkImage     getDepthImage()              const noexcept;
     VkImageView getDepthImageView()          const noexcept;
 
     VulkanContext* getContext() const noexcept;
@@ -41,9 +46,12 @@ private:
     VkImage        m_depthImage;
     VkDeviceMemory m_depthImageMemory;
     VkImageView    m_depthImageView;
+    VkExtent2D     m_depthExtent;
 
-    VkFormat   m_format;
-    VkExtent2D m_extent;
+    VkFormat         m_format;
+    VkExtent2D       m_extent;
+    VkPresentModeKHR m_presentMode;
+    uint32_t         m_requestedImageCount;
 };
 
 #endif // !MAIN_VIEW_HPP
\ No newline at end of file
@@ -0,0 +1,94 @@
+#include <cmath>
+#include <algorithm>
+
+#include "vulkan_api/render/DynamicResolution.hpp"
+
+
+namespace
+{
+    constexpr float HEADROOM  = 0.9f;  // aim below the budget, frame times are noisy
+    constexpr float DEAD_BAND = 0.05f; // relative scale change that is not worth making
+
+    constexpr float DOWN_RATE = 0.5f;  // fraction of the correction applied per frame
+    constexpr float UP_RATE   = 0.05f;
+
+    constexpr float COST_SMOOTHING = 0.25f;
+
+    constexpr uint32_t EXTENT_ALIGNMENT = 8;
+
+    VkExtent2D scale_extent(const VkExtent2D& extent, float scale) noexcept
+    {
+        const auto scaleSide = [scale](uint32_t side)
+        {
+            const uint32_t scaled = static_cast<uint32_t>(side * scale + 0.5f);
+            const uint32_t aligned = (scaled + EXTENT_ALIGNMENT / 2) / EXTENT_ALIGNMENT * EXTENT_ALIGNMENT;
+
+            return std::clamp(aligned, std::min(EXTENT_ALIGNMENT, side), side);
+        };
+
+        return { scaleSide(extent.width), scaleSide(extent.height) };
+    }
+}
+
+
+DynamicResolution::DynamicResolution() noexcept:
+    m_settings(),
+    m_scale(1.f),
+    m_fullCost(0.f)
+{
+
+}
+
+
+void DynamicResolution::create(const Settings& settings) noexcept
+{
+    m_settings          = settings;
+    m_settings.maxScale = std::clamp(settings.maxScale, 0.1f, 1.f);
+    m_settings.minScale = std::clamp(settings.minScale, 0.1f, m_settings.maxScale);
+
+    m_scale   = m_settings.maxScale;
+    m_fullCost = 0.f;
+}
+
+
+void DynamicResolution::update(float gpuMilliseconds, float renderScale) noexcept
+{
+    if(gpuMilliseconds <= 0.f || renderScale <= 0.f || m_settings.budgetMs <= 0.f)
+        return;
+
+//  Measurements lag the scale by the frames in flight, so the cost is tracked at full resolution
+    const float cost = gpuMilliseconds / (renderScale * renderScale);
+    m_fullCost = (m_fullCost == 0.f) ? cost : m_fullCost + COST_SMOOTHING * (cost - m_fullCost);
+
+    const float target = m_settings.budgetMs * HEADROOM;
+    const float ideal  = std::sqrt(target / m_fullCost);
+
+    if(std::fabs(ideal - m_scale) < DEAD_BAND * m_scale)
+        return;
+
+//  A frame over the whole budget is corrected at once, not only after the average caught up
+    if(gpuMilliseconds > m_settings.budgetMs)
+        m_scale = std::min(m_scale, std::sqrt(target / cost));
+
+    const float rate = (ideal < m_scale) ? DOWN_RATE : UP_RATE;
+
+    m_scale = std::clamp(m_scale + rate * (ideal - m_scale), m_settings.minScale, m_settings.maxScale);
+}
+
+
+float DynamicResolution::getScale() const noexcept
+{
+    return m_scale;
+}
+
+
+VkExtent2D DynamicResolution::getRenderExtent(const VkExtent2D& outputExtent) const noexcept
+{
+    return scale_extent(outputExtent, m_scale);
+}
+
+
+VkExtent2D DynamicResolution::getMaxExtent(const VkExtent2D& outputExtent) const noexcept
+{
+    return scale_extent(outputExtent, m_settings.maxScale);
+}
\ No newline at end of file
@@ -0,0 +1,37 @@
+#ifndef DYNAMIC_RESOLUTION_HPP
+#define DYNAMIC_RESOLUTION_HPP
+
+#include <vulkan/vulkan.h>
+
+
+// Picks the render scale that keeps the GPU time of the scene passes within a budget.
+// The cost is taken as proportional to the pixel count, so the scale follows sqrt(budget / cost at full resolution).
+// It drops quickly when over budget and recovers slowly, a dead band around the target keeps it from oscillating.
+// The render extent is the output extent times the scale, rounded to multiples of 8 pixels.
+class DynamicResolution
+{
+public:
+    struct Settings
+    {
+        float minScale = 0.5f;
+        float maxScale = 1.f;
+        float budgetMs = 16.6f; // GPU time per frame
+    };
+
+    DynamicResolution() noexcept;
+
+    void create(const Settings& settings) noexcept;
+
+    void  update(float gpuMilliseconds, float renderScale) noexcept; // renderScale: scale of the measured frame
+    float getScale() const noexcept;
+
+    VkExtent2D getRenderExtent(const VkExtent2D& outputExtent) const noexcept;
+    VkExtent2D getMaxExtent(const VkExtent2D& outputExtent)    const noexcept; // size of the internal target
+
+private:
+    Settings m_settings;
+    float    m_scale;
+    float    m_fullCost; // ms at scale 1, smoothed
+};
+
+#endif // !DYNAMIC_RESOLUTION_HPP
\ No newline at end of file
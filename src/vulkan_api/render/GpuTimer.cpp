@@ -0,0 +1,100 @@
+#include <array>
+
+#include "vulkan_api/context/VulkanContext.hpp"
+#include "vulkan_api/render/GpuTimer.hpp"
+
+
+GpuTimer::GpuTimer() noexcept:
+    m_device(nullptr),
+    m_queryPool(nullptr),
+    m_period(0.f),
+    m_validMask(0)
+{
+
+}
+
+
+bool GpuTimer::create(const VulkanContext& context, uint32_t framesInFlight) noexcept
+{
+    auto GPU = context.getPhysicalDevice();
+
+    uint32_t familyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(GPU, &familyCount, nullptr);
+
+    std::vector<VkQueueFamilyProperties> families(familyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(GPU, &familyCount, families.data());
+
+    const uint32_t validBits = families[context.getMainQueueFamilyIndex()].timestampValidBits;
+
+    if(validBits == 0)
+        return false;
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(GPU, &properties);
+
+    m_device    = context.getDevice();
+    m_period    = properties.limits.timestampPeriod;
+    m_validMask = (validBits >= 64) ? UINT64_MAX : ((1ULL << validBits) - 1);
+
+    const VkQueryPoolCreateInfo poolInfo = 
+    {
+        .sType              = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+        .pNext              = nullptr,
+        .flags              = 0,
+        .queryType          = VK_QUERY_TYPE_TIMESTAMP,
+        .queryCount         = framesInFlight * 2,
+        .pipelineStatistics = 0
+    };
+
+    if(vkCreateQueryPool(m_device, &poolInfo, nullptr, &m_queryPool) != VK_SUCCESS)
+        return false;
+
+    m_written.assign(framesInFlight, 0);
+
+    return true;
+}
+
+
+void GpuTimer::destroy() noexcept
+{
+    if(m_queryPool)
+    {
+        vkDestroyQueryPool(m_device, m_queryPool, nullptr);
+        m_queryPool = nullptr;
+    }
+
+    m_written.clear();
+}
+
+
+void GpuTimer::begin(VkCommandBuffer cmd, uint32_t frame) noexcept
+{
+    vkCmdResetQueryPool(cmd, m_queryPool, frame * 2, 2);
+    vkCmdWriteTimestamp2(cmd, VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT, m_queryPool, frame * 2);
+}
+
+
+void GpuTimer::end(VkCommandBuffer cmd, uint32_t frame) noexcept
+{
+    vkCmdWriteTimestamp2(cmd, VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT, m_queryPool, frame * 2 + 1);
+    m_written[frame] = 1;
+}
+
+
+bool GpuTimer::getResult(uint32_t frame, float& milliseconds) noexcept
+{
+    if(!m_written[frame])
+        return false;
+
+    std::array<uint64_t, 2> timestamps;
+
+    if(vkGetQueryPoolResults(m_device, m_queryPool, frame * 2, 2, sizeof(timestamps), timestamps.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) != VK_SUCCESS)
+        return false;
+
+    m_written[frame] = 0;
+
+    const uint64_t ticks = (timestamps[1] - timestamps[0]) & m_validMask;
+    milliseconds = static_cast<float>(ticks) * m_period * 1e-6f;
+
+    return true;
+}
\ No newline at end of file
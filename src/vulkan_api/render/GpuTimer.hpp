@@ -0,0 +1,37 @@
+#ifndef GPU_TIMER_HPP
+#define GPU_TIMER_HPP
+
+#include <vector>
+#include <cstdint>
+
+#include <vulkan/vulkan.h>
+
+
+// GPU time of a span of commands, measured with a pair of timestamps per frame in flight.
+// A frame's pair is read back once its slot comes around again: the timeline wait on the slot
+// guarantees the results are available, so reading never stalls.
+class GpuTimer
+{
+public:
+    GpuTimer() noexcept;
+
+    bool create(const class VulkanContext& context, uint32_t framesInFlight) noexcept; // false when the queue has no timestamps
+    void destroy() noexcept;
+
+//  Outside of a render pass, begin() also resets the frame's queries
+    void begin(VkCommandBuffer cmd, uint32_t frame) noexcept;
+    void end(VkCommandBuffer cmd, uint32_t frame)   noexcept;
+
+//  False when the slot holds no new measurement, each measurement is returned once
+    bool getResult(uint32_t frame, float& milliseconds) noexcept;
+
+private:
+    VkDevice    m_device;
+    VkQueryPool m_queryPool;
+    float       m_period;    // ns per tick
+    uint64_t    m_validMask; // timestampValidBits of the queue family
+
+    std::vector<uint8_t> m_written;
+};
+
+#endif // !GPU_TIMER_HPP
\ No newline at end of file
@@ -0,0 +1,60 @@
+#include <cmath>
+#include <algorithm>
+
+#include "vulkan_api/render/LodSelector.hpp"
+
+
+namespace
+{
+    constexpr float MIN_DISTANCE = 1e-3f; // the camera is inside the bounds below this
+}
+
+
+LodSelector::LodSelector() noexcept:
+    m_settings(),
+    m_pixelsPerUnit(0.f)
+{
+
+}
+
+
+void LodSelector::create(const Settings& settings) noexcept
+{
+    m_settings = settings;
+    m_settings.pixelError = std::max(m_settings.pixelError, 0.f);
+    m_settings.hysteresis = std::clamp(m_settings.hysteresis, 0.f, 1.f);
+}
+
+
+void LodSelector::setProjection(float fovY, float viewportHeight) noexcept
+{
+    m_pixelsPerUnit = viewportHeight / (2.f * std::tan(fovY * 0.5f));
+}
+
+
+uint32_t LodSelector::select(std::span<const float> errors, float scale, float distance, uint32_t current) const noexcept
+{
+    if(errors.empty())
+        return 0;
+
+    const float pixelsPerUnit = scale * m_pixelsPerUnit / std::max(distance, MIN_DISTANCE);
+    const auto  projected     = [&](uint32_t level) { return errors[level] * pixelsPerUnit; };
+
+    uint32_t level = std::min(current, static_cast<uint32_t>(errors.size() - 1));
+
+//  Too coarse, refine right away
+    if(projected(level) > m_settings.pixelError)
+    {
+        while (level > 0 && projected(level) > m_settings.pixelError)
+            --level;
+
+        return level;
+    }
+
+    const float coarsenBelow = m_settings.pixelError * (1.f - m_settings.hysteresis);
+
+    while (level + 1 < errors.size() && projected(level + 1) <= coarsenBelow)
+        ++level;
+
+    return level;
+}
\ No newline at end of file
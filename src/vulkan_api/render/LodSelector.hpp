@@ -0,0 +1,35 @@
+#ifndef LOD_SELECTOR_HPP
+#define LOD_SELECTOR_HPP
+
+#include <span>
+#include <cstdint>
+
+
+// Picks a level of detail per instance from the screen-space error of its levels.
+// A level's error is projected at the instance's nearest distance, the coarsest level below the pixel threshold is wanted.
+// Finer levels are taken as soon as they are needed, coarser ones only once they clear the threshold by the hysteresis margin,
+// so instances sitting at a boundary do not switch back and forth every frame.
+class LodSelector
+{
+public:
+    struct Settings
+    {
+        float pixelError = 1.f;   // error a level may show on screen, 0 keeps full detail
+        float hysteresis = 0.25f; // fraction of pixelError a coarser level has to stay below
+    };
+
+    LodSelector() noexcept;
+
+    void create(const Settings& settings) noexcept;
+    void setProjection(float fovY, float viewportHeight) noexcept; // fovY in radians, height in pixels
+
+//  errors from full detail down, scale takes them to world units, distance is to the nearest point of the bounds.
+//  current is the level the instance had last frame
+    uint32_t select(std::span<const float> errors, float scale, float distance, uint32_t current) const noexcept;
+
+private:
+    Settings m_settings;
+    float    m_pixelsPerUnit; // at distance 1
+};
+
+#endif // !LOD_SELECTOR_HPP
\ No newline at end of file
@@ -1,29 +1,103 @@
+#include <array>
+
 #include "vulkan_api/presentation/MainView.hpp"
 #include "vulkan_api/render/Render.hpp"
 
 
-// TODO add clear color value
 VkResult Render::begin(VkCommandBuffer cmd, const MainView& view, uint32_t imageIndex) noexcept
 {
-    VkCommandBufferBeginInfo beginInfo = 
+    if (auto result = beginFrame(cmd); result != VK_SUCCESS)
+        return result;
+
+//  The previous contents are discarded, so both attachments can start from an undefined layout
+    const std::array<VkImageMemoryBarrier, 2> imageMemoryBarriers =
     {
-        .sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
-        .pNext            = nullptr,
-        .flags            = 0,
-        .pInheritanceInfo = nullptr
+        VkImageMemoryBarrier
+        {
+            .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+            .pNext               = nullptr,
+            .srcAccessMask       = VK_ACCESS_NONE,
+            .dstAccessMask       = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+            .oldLayout           = VK_IMAGE_LAYOUT_UNDEFINED,
+            .newLayout           = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+            .srcQueueFamilyIndex = 0,
+            .dstQueueFamilyIndex = 0,
+            .image               = view.getImage(imageIndex),
+            .subresourceRange =     
+            {
+                .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+                .baseMipLevel   = 0,
+                .levelCount     = 1,
+                .baseArrayLayer = 0,
+                .layerCount     = 1
+            }
+        },
+        VkImageMemoryBarrier
+        {
+            .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+            .pNext               = nullptr,
+            .srcAccessMask       = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+            .dstAccessMask       = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+            .oldLayout           = VK_IMAGE_LAYOUT_UNDEFINED,
+            .newLayout           = VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL,
+            .srcQueueFamilyIndex = 0,
+            .dstQueueFamilyIndex = 0,
+            .image               = view.getDepthImage(),
+            .subresourceRange =     
+            {
+                .aspectMask     = VK_IMAGE_ASPECT_DEPTH_BIT,
+                .baseMipLevel   = 0,
+                .levelCount     = 1,
+                .baseArrayLayer = 0,
+                .layerCount     = 1
+            }
+        }
     };
 
-    if (auto result = vkBeginCommandBuffer(cmd, &beginInfo); result != VK_SUCCESS)
-        return result;
+    vkCmdPipelineBarrier(
+        cmd,
+        VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,  // srcStageMask
+        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, // dstStageMask
+        0,
+        0,
+        nullptr,
+        0,
+        nullptr,
+        1, // imageMemoryBarrierCount
+        &imageMemoryBarriers[0] // pImageMemoryBarriers
+    );
+
+    vkCmdPipelineBarrier(
+        cmd,
+        VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,  // srcStageMask
+        VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, // dstStageMask
+        0,
+        0,
+        nullptr,
+        0,
+        nullptr,
+        1, // imageMemoryBarrierCount
+        &imageMemoryBarriers[1] // pImageMemoryBarriers
+    );
+
+    beginPass(cmd, view, imageIndex, VK_ATTACHMENT_LOAD_OP_CLEAR);
+
+    return VK_SUCCESS;
+}
+
+
+VkResult Render::end(VkCommandBuffer cmd, const MainView& view, uint32_t imageIndex) noexcept
+{
+    endPass(cmd);
 
     const VkImageMemoryBarrier imageMemoryBarrier =
     {
         .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
         .pNext               = nullptr,
-        .srcAccessMask       = VK_ACCESS_NONE,
-        .dstAccessMask       = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
-        .oldLayout           = VK_IMAGE_LAYOUT_UNDEFINED,
-        .newLayout           = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+        .srcAccessMask       = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+        .dstAccessMask       = VK_ACCESS_NONE,
+        .oldLayout           = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+        .newLayout           = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
         .srcQueueFamilyIndex = 0,
         .dstQueueFamilyIndex = 0,
         .image               = view.getImage(imageIndex),
@@ -39,8 +113,8 @@ VkResult Render::begin(VkCommandBuffer cmd, const MainView& view, uint32_t image
 
     vkCmdPipelineBarrier(
         cmd,
-        VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,  // srcStageMask
-        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, // dstStageMask
+        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,  // srcStageMask
+        VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, // dstStageMask
         0,
         0,
         nullptr,
@@ -50,33 +124,59 @@ VkResult Render::begin(VkCommandBuffer cmd, const MainView& view, uint32_t image
         &imageMemoryBarrier // pImageMemoryBarriers
     );
 
-    VkExtent2D extent = view.getExtent();
+    return endFrame(cmd);
+}
+
 
+VkResult Render::beginFrame(VkCommandBuffer cmd) noexcept
+{
+    VkCommandBufferBeginInfo beginInfo = 
+    {
+        .sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .pNext            = nullptr,
+        .flags            = 0,
+        .pInheritanceInfo = nullptr
+    };
+
+    return vkBeginCommandBuffer(cmd, &beginInfo);
+}
+
+
+// TODO add clear color value
+void Render::beginPass(VkCommandBuffer cmd, const MainView& view, uint32_t imageIndex, VkAttachmentLoadOp loadOp, VkRenderingFlags flags) noexcept
+{
+    beginPass(cmd, view.getImageView(imageIndex), view.getDepthImageView(), view.getExtent(), loadOp, flags);
+}
+
+
+void Render::beginPass(VkCommandBuffer cmd, VkImageView colorView, VkImageView depthView, const VkExtent2D& extent, VkAttachmentLoadOp loadOp, VkRenderingFlags flags) noexcept
+{
     const VkRenderingAttachmentInfoKHR colorAttachmentInfo = 
     {
         .sType              = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR,
         .pNext              = VK_NULL_HANDLE,
-        .imageView          = view.getImageView(imageIndex),
+        .imageView          = colorView,
         .imageLayout        = VK_IMAGE_LAYOUT_ATTACHMENT_OPTIMAL_KHR,
         .resolveMode        = VK_RESOLVE_MODE_NONE,
         .resolveImageView   = VK_NULL_HANDLE,
         .resolveImageLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-        .loadOp             = VK_ATTACHMENT_LOAD_OP_CLEAR,
+        .loadOp             = loadOp,
         .storeOp            = VK_ATTACHMENT_STORE_OP_STORE,
         .clearValue         = {{ 0.0f, 0.0f, 0.0f, 1.0f }}
     };
 
+//  Depth is kept after the pass: the occlusion culler builds its depth pyramid from it
     VkRenderingAttachmentInfoKHR depthAttachmentInfo = 
     {
         .sType              = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR,
         .pNext              = VK_NULL_HANDLE,
-        .imageView          = view.getDepthImageView(),
+        .imageView          = depthView,
         .imageLayout        = VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL,
         .resolveMode        = VK_RESOLVE_MODE_NONE,
         .resolveImageView   = VK_NULL_HANDLE,
         .resolveImageLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-        .loadOp             = VK_ATTACHMENT_LOAD_OP_CLEAR,
-        .storeOp            = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+        .loadOp             = loadOp,
+        .storeOp            = VK_ATTACHMENT_STORE_OP_STORE,
         .clearValue         = { 1.f, 0.f }
     };
 
@@ -84,7 +184,7 @@ VkResult Render::begin(VkCommandBuffer cmd, const MainView& view, uint32_t image
     {
         .sType                = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR,
         .pNext                = VK_NULL_HANDLE,
-        .flags                = 0,
+        .flags                = flags,
         .renderArea           = { { 0, 0 }, extent },
         .layerCount           = 1,
         .viewMask             = 0,
@@ -96,6 +196,20 @@ VkResult Render::begin(VkCommandBuffer cmd, const MainView& view, uint32_t image
 
     vkCmdBeginRendering(cmd, &renderingInfo);
 
+//  Secondary command buffers set their own dynamic state
+    if(!(flags & VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT))
+        setViewport(cmd, extent);
+}
+
+
+void Render::endPass(VkCommandBuffer cmd) noexcept
+{
+    vkCmdEndRendering(cmd);
+}
+
+
+void Render::setViewport(VkCommandBuffer cmd, const VkExtent2D& extent) noexcept
+{
     VkViewport viewport = 
     {
         .x = 0.f,
@@ -115,48 +229,10 @@ VkResult Render::begin(VkCommandBuffer cmd, const MainView& view, uint32_t image
     };
 
     vkCmdSetScissor(cmd, 0, 1, &scissor);
-
-    return VK_SUCCESS;
 }
 
 
-VkResult Render::end(VkCommandBuffer cmd, const MainView& view, uint32_t imageIndex) noexcept
+VkResult Render::endFrame(VkCommandBuffer cmd) noexcept
 {
-    vkCmdEndRendering(cmd);
-
-    const VkImageMemoryBarrier imageMemoryBarrier =
-    {
-        .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-        .pNext               = nullptr,
-        .srcAccessMask       = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
-        .dstAccessMask       = VK_ACCESS_NONE,
-        .oldLayout           = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-        .newLayout           = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
-        .srcQueueFamilyIndex = 0,
-        .dstQueueFamilyIndex = 0,
-        .image               = view.getImage(imageIndex),
-        .subresourceRange =     
-        {
-            .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
-            .baseMipLevel   = 0,
-            .levelCount     = 1,
-            .baseArrayLayer = 0,
-            .layerCount     = 1
-        }
-    };
-
-    vkCmdPipelineBarrier(
-        cmd,
-        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,  // srcStageMask
-        VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, // dstStageMask
-        0,
-        0,
-        nullptr,
-        0,
-        nullptr,
-        1, // imageMemoryBarrierCount
-        &imageMemoryBarrier // pImageMemoryBarriers
-    );
-
     return vkEndCommandBuffer(cmd);
 }
\ No newline at end of file
@@ -9,6 +9,18 @@ class Render
 public:
     static VkResult begin(VkCommandBuffer cmd, const class MainView& view, uint32_t imageIndex) noexcept;
     static VkResult end(VkCommandBuffer cmd, const class MainView& view, uint32_t imageIndex) noexcept;
+
+//  Finer grained steps of begin()/end() for frames that interleave several passes with compute work,
+//  they record no barriers, the attachment layouts are handled by the RenderGraph
+    static VkResult beginFrame(VkCommandBuffer cmd) noexcept;
+    static VkResult endFrame(VkCommandBuffer cmd) noexcept;
+
+    static void beginPass(VkCommandBuffer cmd, const class MainView& view, uint32_t imageIndex, VkAttachmentLoadOp loadOp, VkRenderingFlags flags = 0) noexcept;
+//  Renders into the top-left extent of arbitrary color/depth attachments, e.g. a scaled internal target
+    static void beginPass(VkCommandBuffer cmd, VkImageView colorView, VkImageView depthView, const VkExtent2D& extent, VkAttachmentLoadOp loadOp, VkRenderingFlags flags = 0) noexcept;
+    static void endPass(VkCommandBuffer cmd) noexcept;
+
+    static void setViewport(VkCommandBuffer cmd, const VkExtent2D& extent) noexcept;
 };
 
-#endif // !RENDER_HPP
\ No newline at end of file
+#endif // !RENDER_HPP
@@ -0,0 +1,784 @@
+#include <algorithm>
+
+#include "vulkan_api/utils/Helpers.hpp"
+#include "vulkan_api/render/RenderGraph.hpp"
+
+
+static constexpr VkAccessFlags2 WRITE_ACCESS =
+    VK_ACCESS_2_SHADER_WRITE_BIT |
+    VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT |
+    VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT |
+    VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+    VK_ACCESS_2_TRANSFER_WRITE_BIT |
+    VK_ACCESS_2_MEMORY_WRITE_BIT;
+
+
+RenderGraph::PassBuilder::PassBuilder(RenderGraph& graph, uint32_t pass) noexcept:
+    m_graph(graph),
+    m_pass(pass)
+{
+
+}
+
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::read(Resource resource, Usage usage) noexcept
+{
+    auto& pass = m_graph.m_passes[m_pass];
+
+    if(pass.useCount < MAX_PASS_USES)
+        pass.uses[pass.useCount++] = { resource, usage, false };
+    else
+        m_graph.m_outOfMemory = true;
+
+    return *this;
+}
+
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::write(Resource resource, Usage usage) noexcept
+{
+    auto& pass = m_graph.m_passes[m_pass];
+
+    if(pass.useCount < MAX_PASS_USES)
+        pass.uses[pass.useCount++] = { resource, usage, true };
+    else
+        m_graph.m_outOfMemory = true;
+
+    return *this;
+}
+
+
+// The pass is kept even if nothing reads its results
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::sideEffect() noexcept
+{
+    m_graph.m_passes[m_pass].sideEffect = true;
+
+    return *this;
+}
+
+
+
+RenderGraph::RenderGraph() noexcept:
+    m_device(nullptr),
+    m_GPU(nullptr),
+    m_deletionQueue(nullptr),
+    m_frameArena(nullptr),
+    m_outOfMemory(false),
+    m_transientCount(0),
+    m_transientsDirty(false)
+{
+
+}
+
+
+RenderGraph::~RenderGraph()
+{
+    destroy();
+}
+
+
+void RenderGraph::create(VkDevice device, VkPhysicalDevice GPU, DeletionQueue* deletionQueue) noexcept
+{
+    m_device        = device;
+    m_GPU           = GPU;
+    m_deletionQueue = deletionQueue;
+
+//  Enough for the frames built today, so even the first frame does not grow them
+    m_passes.reserve(16);
+    m_resources.reserve(32);
+}
+
+
+void RenderGraph::destroy() noexcept
+{
+    destroyTransients(nullptr);
+    m_transients.clear();
+    m_passes.clear();
+    m_resources.clear();
+
+    m_frameArena     = nullptr;
+    m_finalBarriers  = {};
+    m_imageBarriers  = {};
+    m_bufferBarriers = {};
+}
+
+
+void RenderGraph::reset(LinearAllocator& frameArena) noexcept
+{
+    m_passes.clear();
+    m_resources.clear();
+
+    m_frameArena     = &frameArena;
+    m_outOfMemory    = false;
+    m_finalBarriers  = {};
+    m_imageBarriers  = {};
+    m_bufferBarriers = {};
+    m_transientCount = 0;
+}
+
+
+RenderGraph::Resource RenderGraph::importImage(VkImage image, VkImageAspectFlags aspect, uint32_t mipLevels, VkImageLayout initialLayout, VkImageLayout finalLayout,
+                                               VkPipelineStageFlags2 lastStage, VkAccessFlags2 lastAccess) noexcept
+{
+    ResourceData data =
+    {
+        .isImage      = true,
+        .image        = image,
+        .buffer       = nullptr,
+        .aspect       = aspect,
+        .mipLevels    = mipLevels,
+        .finalLayout  = finalLayout,
+        .initialState =
+        {
+            .writeStage  = lastStage,
+            .writeAccess = lastAccess & WRITE_ACCESS,
+            .readStages  = VK_PIPELINE_STAGE_2_NONE,
+            .readAccess  = VK_ACCESS_2_NONE,
+            .layout      = initialLayout
+        },
+        .transient    = -1
+    };
+
+    m_resources.push_back(data);
+
+    return static_cast<Resource>(m_resources.size() - 1);
+}
+
+
+RenderGraph::Resource RenderGraph::importBuffer(VkBuffer buffer, VkPipelineStageFlags2 lastStage, VkAccessFlags2 lastAccess) noexcept
+{
+    ResourceData data =
+    {
+        .isImage      = false,
+        .image        = nullptr,
+        .buffer       = buffer,
+        .aspect       = 0,
+        .mipLevels    = 0,
+        .finalLayout  = VK_IMAGE_LAYOUT_UNDEFINED,
+        .initialState =
+        {
+            .writeStage  = lastStage,
+            .writeAccess = lastAccess & WRITE_ACCESS,
+            .readStages  = VK_PIPELINE_STAGE_2_NONE,
+            .readAccess  = VK_ACCESS_2_NONE,
+            .layout      = VK_IMAGE_LAYOUT_UNDEFINED
+        },
+        .transient    = -1
+    };
+
+    m_resources.push_back(data);
+
+    return static_cast<Resource>(m_resources.size() - 1);
+}
+
+
+RenderGraph::Resource RenderGraph::createImage(const ImageInfo& info) noexcept
+{
+    const uint32_t index = m_transientCount++;
+
+    if(index == m_transients.size())
+    {
+        m_transients.push_back({ .info = info });
+        m_transientsDirty = true;
+    }
+    else
+    {
+        auto& cached = m_transients[index].info;
+
+        if(cached.format != info.format || cached.extent.width != info.extent.width || cached.extent.height != info.extent.height ||
+           cached.usage != info.usage || cached.aspect != info.aspect || cached.mipLevels != info.mipLevels)
+        {
+            cached = info;
+            m_transientsDirty = true;
+        }
+    }
+
+    ResourceData data =
+    {
+        .isImage      = true,
+        .image        = nullptr,
+        .buffer       = nullptr,
+        .aspect       = info.aspect,
+        .mipLevels    = info.mipLevels,
+        .finalLayout  = VK_IMAGE_LAYOUT_UNDEFINED,
+        .initialState = {},
+        .transient    = static_cast<int32_t>(index)
+    };
+
+    m_resources.push_back(data);
+
+    return static_cast<Resource>(m_resources.size() - 1);
+}
+
+
+RenderGraph::PassBuilder RenderGraph::addPass(const char* name, const void* function, ExecuteFunction execute) noexcept
+{
+    auto& pass    = m_passes.emplace_back();
+    pass.name     = name;
+    pass.function = function;
+    pass.execute  = function ? execute : nullptr;
+
+    return PassBuilder(*this, static_cast<uint32_t>(m_passes.size() - 1));
+}
+
+
+VkResult RenderGraph::compile() noexcept
+{
+    if(m_outOfMemory)
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+
+    if(auto result = cullPasses(); result != VK_SUCCESS)
+        return result;
+
+    if(m_transients.size() != m_transientCount)
+    {// Fewer images than last frame: the dropped ones still own views and images and share the blocks, everything is reallocated anyway
+        destroyTransients(m_deletionQueue);
+        m_transients.resize(m_transientCount);
+        m_transientsDirty = true;
+    }
+
+    {// Lifetimes of transient images, a different overlap pattern needs a different aliasing
+        const auto lifetimes = m_frameArena->allocate<std::pair<uint32_t, uint32_t>>(m_transients.size());
+
+        if(lifetimes.size() != m_transients.size())
+            return VK_ERROR_OUT_OF_HOST_MEMORY;
+
+        std::fill(lifetimes.begin(), lifetimes.end(), std::pair<uint32_t, uint32_t>(UINT32_MAX, 0));
+
+        for (uint32_t i = 0; i < m_passes.size(); ++i)
+        {
+            if(!m_passes[i].alive)
+                continue;
+
+            for (const auto& use : std::span(m_passes[i].uses.data(), m_passes[i].useCount))
+            {
+                if (int32_t transient = m_resources[use.resource].transient; transient >= 0)
+                {
+                    lifetimes[transient].first  = std::min(lifetimes[transient].first, i);
+                    lifetimes[transient].second = std::max(lifetimes[transient].second, i);
+                }
+            }
+        }
+
+        for (size_t i = 0; i < m_transients.size(); ++i)
+        {
+            if(m_transients[i].first != lifetimes[i].first || m_transients[i].last != lifetimes[i].second)
+            {
+                m_transients[i].first = lifetimes[i].first;
+                m_transients[i].last  = lifetimes[i].second;
+                m_transientsDirty     = true;
+            }
+        }
+    }
+
+    if(m_transientsDirty)
+    {
+        if(auto result = allocateTransients(); result != VK_SUCCESS)
+            return result;
+
+        m_transientsDirty = false;
+    }
+
+    {// Every stage that touches a memory block this frame, the first use of an aliased image waits for all of them
+        for (auto& block : m_blocks)
+            block.stages = VK_PIPELINE_STAGE_2_NONE;
+
+        for (const auto& pass : m_passes)
+            if(pass.alive)
+                for (const auto& use : std::span(pass.uses.data(), pass.useCount))
+                    if (int32_t transient = m_resources[use.resource].transient; transient >= 0 && m_transients[transient].image)
+                        m_blocks[m_transients[transient].block].stages |= getAccessInfo(use.usage, use.write).stage;
+
+        for (auto& resource : m_resources)
+        {
+            if(resource.transient < 0)
+                continue;
+
+            const auto& transient = m_transients[resource.transient];
+            resource.image = transient.image;
+
+            if(transient.image)
+            {
+                resource.initialState.writeStage  = m_blocks[transient.block].stages;
+                resource.initialState.writeAccess = VK_ACCESS_2_MEMORY_WRITE_BIT;
+            }
+        }
+    }
+
+    return buildBarriers();
+}
+
+
+void RenderGraph::execute(VkCommandBuffer cmd) noexcept
+{
+    for (const auto& pass : m_passes)
+    {
+        if(!pass.alive)
+            continue;
+
+        recordBarriers(cmd, pass.barriers);
+
+        if(pass.execute)
+            pass.execute(pass.function, cmd);
+    }
+
+    recordBarriers(cmd, m_finalBarriers);
+}
+
+
+VkImage RenderGraph::getImage(Resource resource) const noexcept
+{
+    return m_resources[resource].image;
+}
+
+
+VkImageView RenderGraph::getImageView(Resource resource) const noexcept
+{
+    const int32_t transient = m_resources[resource].transient;
+
+    return (transient >= 0) ? m_transients[transient].view : nullptr;
+}
+
+
+RenderGraph::AccessInfo RenderGraph::getAccessInfo(Usage usage, bool write) noexcept
+{
+    switch (usage)
+    {
+        case Usage::ColorAttachment:
+            return { VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, true };
+
+        case Usage::DepthAttachment:
+            return { VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT, VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL, true };
+
+        case Usage::DepthRead:
+            return { VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT, VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT, VK_IMAGE_LAYOUT_DEPTH_READ_ONLY_OPTIMAL, false };
+
+        case Usage::SampledFragment:
+            return { VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, false };
+
+        case Usage::SampledCompute:
+            return { VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, false };
+
+        case Usage::StorageRead:
+            return { VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT, VK_IMAGE_LAYOUT_GENERAL, false };
+
+        case Usage::StorageWrite:
+            return { VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL, true };
+
+        case Usage::IndirectRead:
+            return { VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT, VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED, false };
+
+        case Usage::IndexRead:
+            return { VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT, VK_ACCESS_2_INDEX_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED, false };
+
+        case Usage::TransferSrc:
+            return { VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, false };
+
+        case Usage::TransferDst:
+            return { VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, true };
+    }
+
+    return { VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL, write };
+}
+
+
+// Walks the passes backwards: a pass is alive if it has side effects or writes something
+// that is imported or used by a later alive pass
+VkResult RenderGraph::cullPasses() noexcept
+{
+    const auto needed = m_frameArena->allocate<bool>(m_resources.size());
+
+    if(needed.size() != m_resources.size())
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+
+    for (size_t i = 0; i < m_resources.size(); ++i)
+        needed[i] = (m_resources[i].transient < 0);
+
+    for (auto pass = m_passes.rbegin(); pass != m_passes.rend(); ++pass)
+    {
+        const std::span<const Use> uses(pass->uses.data(), pass->useCount);
+
+        pass->alive = pass->sideEffect;
+
+        for (const auto& use : uses)
+            if(use.write && needed[use.resource])
+                pass->alive = true;
+
+        if(!pass->alive)
+            continue;
+
+    //  Attachments may be loaded, so whatever this pass touches must be produced by someone
+        for (const auto& use : uses)
+            needed[use.resource] = true;
+    }
+
+    return VK_SUCCESS;
+}
+
+
+// Greedy first fit: biggest images first, an image joins a block if its lifetime overlaps none of the block's images
+VkResult RenderGraph::allocateTransients() noexcept
+{
+    destroyTransients(m_deletionQueue);
+
+    std::vector<uint32_t> order;
+
+    for (uint32_t i = 0; i < m_transients.size(); ++i)
+    {
+        auto& transient = m_transients[i];
+
+        if(transient.first == UINT32_MAX)
+            continue; // only used by culled passes
+
+        const VkImageCreateInfo imageInfo =
+        {
+            .sType                 = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+            .pNext                 = nullptr,
+            .flags                 = 0,
+            .imageType             = VK_IMAGE_TYPE_2D,
+            .format                = transient.info.format,
+            .extent                = { transient.info.extent.width, transient.info.extent.height, 1 },
+            .mipLevels             = transient.info.mipLevels,
+            .arrayLayers           = 1,
+            .samples               = VK_SAMPLE_COUNT_1_BIT,
+            .tiling                = VK_IMAGE_TILING_OPTIMAL,
+            .usage                 = transient.info.usage,
+            .sharingMode           = VK_SHARING_MODE_EXCLUSIVE,
+            .queueFamilyIndexCount = 0,
+            .pQueueFamilyIndices   = nullptr,
+            .initialLayout         = VK_IMAGE_LAYOUT_UNDEFINED
+        };
+
+        if (auto result = vkCreateImage(m_device, &imageInfo, nullptr, &transient.image); result != VK_SUCCESS)
+            return result;
+
+        vkGetImageMemoryRequirements(m_device, transient.image, &transient.requirements);
+        order.push_back(i);
+    }
+
+    std::sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b)
+    {
+        return m_transients[a].requirements.size > m_transients[b].requirements.size;
+    });
+
+    for (auto index : order)
+    {
+        auto& transient = m_transients[index];
+        bool placed = false;
+
+        for (uint32_t b = 0; b < m_blocks.size() && !placed; ++b)
+        {
+            auto& block = m_blocks[b];
+
+            if(!(block.typeBits & transient.requirements.memoryTypeBits))
+                continue;
+
+            const bool overlaps = std::any_of(block.transients.begin(), block.transients.end(), [&](uint32_t other)
+            {
+                return transient.first <= m_transients[other].last && m_transients[other].first <= transient.last;
+            });
+
+            if(overlaps)
+                continue;
+
+            block.typeBits &= transient.requirements.memoryTypeBits;
+            block.size      = std::max(block.size, transient.requirements.size);
+            block.transients.push_back(index);
+            transient.block = b;
+            placed = true;
+        }
+
+        if(!placed)
+        {
+            transient.block = static_cast<uint32_t>(m_blocks.size());
+
+            auto& block    = m_blocks.emplace_back();
+            block.size     = transient.requirements.size;
+            block.typeBits = transient.requirements.memoryTypeBits;
+            block.transients.push_back(index);
+        }
+    }
+
+    for (auto& block : m_blocks)
+    {
+        const VkMemoryAllocateInfo allocInfo =
+        {
+            .sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+            .pNext           = nullptr,
+            .allocationSize  = block.size,
+            .memoryTypeIndex = vk::findMemoryType(block.typeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_GPU)
+        };
+
+        if (auto result = vkAllocateMemory(m_device, &allocInfo, nullptr, &block.memory); result != VK_SUCCESS)
+            return result;
+
+        for (auto index : block.transients)
+        {
+            auto& transient = m_transients[index];
+
+            if (auto result = vkBindImageMemory(m_device, transient.image, block.memory, 0); result != VK_SUCCESS)
+                return result;
+
+            if (auto result = vk::createImageView2D(m_device, transient.image, transient.info.format, transient.info.aspect, transient.view, 0, transient.info.mipLevels); result != VK_SUCCESS)
+                return result;
+        }
+    }
+
+    return VK_SUCCESS;
+}
+
+
+// With a deletion queue the images of earlier frames are retired, without one the GPU must be idle
+void RenderGraph::destroyTransients(DeletionQueue* deletionQueue) noexcept
+{
+    for (auto& transient : m_transients)
+    {
+        if(deletionQueue)
+        {
+            deletionQueue->retire(transient.view);
+            deletionQueue->retire(transient.image);
+        }
+        else
+        {
+            if(transient.view)
+                vkDestroyImageView(m_device, transient.view, nullptr);
+
+            if(transient.image)
+                vkDestroyImage(m_device, transient.image, nullptr);
+        }
+
+        transient.view  = nullptr;
+        transient.image = nullptr;
+    }
+
+    for (auto& block : m_blocks)
+    {
+        if(deletionQueue)
+            deletionQueue->retire(block.memory);
+        else if(block.memory)
+            vkFreeMemory(m_device, block.memory, nullptr);
+    }
+
+    m_blocks.clear();
+}
+
+
+// Barrier arrays are carved from the frame arena at their upper bound (one per distinct resource) and trimmed to what was written
+VkResult RenderGraph::buildBarriers() noexcept
+{
+    const auto states = m_frameArena->allocate<ResourceState>(m_resources.size());
+
+    if(states.size() != m_resources.size())
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+
+    for (size_t i = 0; i < m_resources.size(); ++i)
+        states[i] = m_resources[i].initialState;
+
+    size_t maxBatch = 0;
+
+    for (auto& pass : m_passes)
+    {
+        pass.barriers = {};
+
+        if(!pass.alive || pass.useCount == 0)
+            continue;
+
+        const std::span<const Use> uses(pass.uses.data(), pass.useCount);
+        const auto barriers = m_frameArena->allocate<Barrier>(uses.size());
+        uint32_t   count    = 0;
+
+        if(barriers.empty())
+            return VK_ERROR_OUT_OF_HOST_MEMORY;
+
+    //  A resource used several times by one pass gets a single merged access
+        for (size_t i = 0; i < uses.size(); ++i)
+        {
+            const auto& use = uses[i];
+
+            const bool seen = std::any_of(uses.begin(), uses.begin() + i, [&](const Use& other) { return other.resource == use.resource; });
+
+            if(seen)
+                continue;
+
+            AccessInfo info = getAccessInfo(use.usage, use.write);
+
+            for (size_t j = i + 1; j < uses.size(); ++j)
+            {
+                if(uses[j].resource != use.resource)
+                    continue;
+
+                const AccessInfo other = getAccessInfo(uses[j].usage, uses[j].write);
+                info.stage  |= other.stage;
+                info.access |= other.access;
+                info.write   = info.write || other.write;
+            }
+
+            addBarrier(barriers, count, use.resource, states[use.resource], info);
+        }
+
+        pass.barriers = barriers.first(count);
+        maxBatch      = std::max(maxBatch, pass.barriers.size());
+    }
+
+    const auto finalBarriers = m_frameArena->allocate<Barrier>(m_resources.size());
+    uint32_t   finalCount    = 0;
+
+    if(finalBarriers.size() != m_resources.size())
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+
+    for (size_t i = 0; i < m_resources.size(); ++i)
+    {
+        const auto& resource = m_resources[i];
+        const auto& state    = states[i];
+
+        if(!resource.isImage || resource.finalLayout == VK_IMAGE_LAYOUT_UNDEFINED || resource.finalLayout == state.layout)
+            continue;
+
+        finalBarriers[finalCount++] =
+        {
+            .resource  = static_cast<Resource>(i),
+            .srcStage  = state.writeStage | state.readStages,
+            .srcAccess = state.writeAccess,
+            .dstStage  = VK_PIPELINE_STAGE_2_NONE,
+            .dstAccess = VK_ACCESS_2_NONE,
+            .oldLayout = state.layout,
+            .newLayout = resource.finalLayout
+        };
+    }
+
+    m_finalBarriers = finalBarriers.first(finalCount);
+    maxBatch        = std::max<size_t>(maxBatch, finalCount);
+
+    m_imageBarriers  = m_frameArena->allocate<VkImageMemoryBarrier2>(maxBatch);
+    m_bufferBarriers = m_frameArena->allocate<VkBufferMemoryBarrier2>(maxBatch);
+
+    if(m_imageBarriers.size() != maxBatch || m_bufferBarriers.size() != maxBatch)
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+
+    return VK_SUCCESS;
+}
+
+
+void RenderGraph::addBarrier(std::span<Barrier> barriers, uint32_t& count, Resource resource, ResourceState& state, const AccessInfo& info) noexcept
+{
+    const bool isImage      = m_resources[resource].isImage;
+    const bool layoutChange = isImage && (info.layout != state.layout);
+
+    if(info.write || layoutChange)
+    {// Write after read/write, or a layout transition: wait for every previous access
+        const VkPipelineStageFlags2 srcStage = state.writeStage | state.readStages;
+
+        if(srcStage != VK_PIPELINE_STAGE_2_NONE || layoutChange)
+        {
+            barriers[count++] =
+            {
+                .resource  = resource,
+                .srcStage  = srcStage,
+                .srcAccess = state.writeAccess,
+                .dstStage  = info.stage,
+                .dstAccess = info.access,
+                .oldLayout = state.layout,
+                .newLayout = isImage ? info.layout : VK_IMAGE_LAYOUT_UNDEFINED
+            };
+        }
+
+        state.writeStage  = info.stage;
+        state.writeAccess = info.write ? (info.access & WRITE_ACCESS) : VK_ACCESS_2_NONE;
+        state.readStages  = info.write ? VK_PIPELINE_STAGE_2_NONE : info.stage;
+        state.readAccess  = info.write ? VK_ACCESS_2_NONE : info.access;
+        state.layout      = isImage ? info.layout : VK_IMAGE_LAYOUT_UNDEFINED;
+    }
+    else
+    {// Read after write: only stages/accesses not synchronized yet need a barrier
+        const bool synchronized = !(info.stage & ~state.readStages) && !(info.access & ~state.readAccess);
+
+        if(!synchronized && state.writeStage != VK_PIPELINE_STAGE_2_NONE)
+        {
+            barriers[count++] =
+            {
+                .resource  = resource,
+                .srcStage  = state.writeStage,
+                .srcAccess = state.writeAccess,
+                .dstStage  = info.stage,
+                .dstAccess = info.access,
+                .oldLayout = state.layout,
+                .newLayout = state.layout
+            };
+        }
+
+        state.readStages |= info.stage;
+        state.readAccess |= info.access;
+    }
+}
+
+
+void RenderGraph::recordBarriers(VkCommandBuffer cmd, std::span<const Barrier> barriers) noexcept
+{
+    if(barriers.empty())
+        return;
+
+    uint32_t imageCount  = 0;
+    uint32_t bufferCount = 0;
+
+    for (const auto& barrier : barriers)
+    {
+        const auto& resource = m_resources[barrier.resource];
+
+        if(resource.isImage)
+        {
+            m_imageBarriers[imageCount++] =
+            {
+                .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+                .pNext               = nullptr,
+                .srcStageMask        = barrier.srcStage,
+                .srcAccessMask       = barrier.srcAccess,
+                .dstStageMask        = barrier.dstStage,
+                .dstAccessMask       = barrier.dstAccess,
+                .oldLayout           = barrier.oldLayout,
+                .newLayout           = barrier.newLayout,
+                .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .image               = resource.image,
+                .subresourceRange    =
+                {
+                    .aspectMask     = resource.aspect,
+                    .baseMipLevel   = 0,
+                    .levelCount     = resource.mipLevels,
+                    .baseArrayLayer = 0,
+                    .layerCount     = 1
+                }
+            };
+        }
+        else
+        {
+            m_bufferBarriers[bufferCount++] =
+            {
+                .sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2,
+                .pNext               = nullptr,
+                .srcStageMask        = barrier.srcStage,
+                .srcAccessMask       = barrier.srcAccess,
+                .dstStageMask        = barrier.dstStage,
+                .dstAccessMask       = barrier.dstAccess,
+                .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .buffer              = resource.buffer,
+                .offset              = 0,
+                .size                = VK_WHOLE_SIZE
+            };
+        }
+    }
+
+    const VkDependencyInfo dependencyInfo =
+    {
+        .sType                    = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+        .pNext                    = nullptr,
+        .dependencyFlags          = 0,
+        .memoryBarrierCount       = 0,
+        .pMemoryBarriers          = nullptr,
+        .bufferMemoryBarrierCount = bufferCount,
+        .pBufferMemoryBarriers    = m_bufferBarriers.data(),
+        .imageMemoryBarrierCount  = imageCount,
+        .pImageMemoryBarriers     = m_imageBarriers.data()
+    };
+
+    vkCmdPipelineBarrier2(cmd, &dependencyInfo);
+}
\ No newline at end of file
@@ -0,0 +1,222 @@
+#ifndef RENDER_GRAPH_HPP
+#define RENDER_GRAPH_HPP
+
+#include <span>
+#include <array>
+#include <vector>
+#include <type_traits>
+
+#include <vulkan/vulkan.h>
+
+#include "core/LinearAllocator.hpp"
+#include "vulkan_api/resources/DeletionQueue.hpp"
+
+
+// Frame graph: passes declare what they read and write, the graph derives the barriers.
+// Rebuilt every frame: reset(), import/create resources, addPass(), compile(), execute().
+// Everything that only lives for one frame (pass functions, barriers, scratch arrays) comes from the frame arena given to reset(),
+// so a frame with an unchanged set of transient images does not touch the heap.
+// compile() culls passes whose results are never used, batches the barriers of each pass
+// into one vkCmdPipelineBarrier2 and lets transient images with disjoint lifetimes share memory.
+// Transient images are cached between frames and only recreated when their description changes,
+// the old ones go to the deletion queue, or are destroyed on the spot when the graph has none.
+class RenderGraph
+{
+public:
+    using Resource = uint32_t;
+
+    enum class Usage : uint8_t
+    {
+        ColorAttachment,
+        DepthAttachment,
+        DepthRead,
+        SampledFragment,
+        SampledCompute,
+        StorageRead,
+        StorageWrite,
+        IndirectRead,
+        IndexRead,
+        TransferSrc,
+        TransferDst
+    };
+
+    struct ImageInfo
+    {
+        VkFormat           format;
+        VkExtent2D         extent;
+        VkImageUsageFlags  usage;
+        VkImageAspectFlags aspect;
+        uint32_t           mipLevels;
+    };
+
+    class PassBuilder
+    {
+    public:
+        PassBuilder& read(Resource resource, Usage usage)  noexcept;
+        PassBuilder& write(Resource resource, Usage usage) noexcept;
+        PassBuilder& sideEffect() noexcept;
+
+    private:
+        PassBuilder(RenderGraph& graph, uint32_t pass) noexcept;
+
+        RenderGraph& m_graph;
+        uint32_t     m_pass;
+        friend class RenderGraph;
+    };
+
+    RenderGraph() noexcept;
+    ~RenderGraph();
+
+    void create(VkDevice device, VkPhysicalDevice GPU, DeletionQueue* deletionQueue = nullptr) noexcept;
+    void destroy() noexcept;
+
+    void reset(LinearAllocator& frameArena) noexcept; // the arena must stay untouched by reset() until execute() returns
+
+//  lastStage/lastAccess describe the use of the resource right before the graph,
+//  finalLayout = VK_IMAGE_LAYOUT_UNDEFINED leaves the image in the layout of its last pass
+    Resource importImage(VkImage image, VkImageAspectFlags aspect, uint32_t mipLevels, VkImageLayout initialLayout, VkImageLayout finalLayout,
+                         VkPipelineStageFlags2 lastStage, VkAccessFlags2 lastAccess) noexcept;
+    Resource importBuffer(VkBuffer buffer, VkPipelineStageFlags2 lastStage, VkAccessFlags2 lastAccess) noexcept;
+    Resource createImage(const ImageInfo& info) noexcept;
+
+//  The function is copied into the frame arena and never destroyed, so it may only capture references and plain values
+    template <class F>
+    PassBuilder addPass(const char* name, const F& execute) noexcept;
+
+    VkResult compile() noexcept;
+    void     execute(VkCommandBuffer cmd) noexcept;
+
+    VkImage     getImage(Resource resource)     const noexcept;
+    VkImageView getImageView(Resource resource) const noexcept;
+
+private:
+    static constexpr uint32_t MAX_PASS_USES = 16;
+
+    using ExecuteFunction = void(*)(const void* function, VkCommandBuffer cmd);
+
+    struct AccessInfo
+    {
+        VkPipelineStageFlags2 stage;
+        VkAccessFlags2        access;
+        VkImageLayout         layout;
+        bool                  write;
+    };
+
+    struct ResourceState
+    {
+        VkPipelineStageFlags2 writeStage  = VK_PIPELINE_STAGE_2_NONE;
+        VkAccessFlags2        writeAccess = VK_ACCESS_2_NONE;
+        VkPipelineStageFlags2 readStages  = VK_PIPELINE_STAGE_2_NONE; // stages already synchronized with the last write
+        VkAccessFlags2        readAccess  = VK_ACCESS_2_NONE;
+        VkImageLayout         layout      = VK_IMAGE_LAYOUT_UNDEFINED;
+    };
+
+    struct ResourceData
+    {
+        bool               isImage;
+        VkImage            image;
+        VkBuffer           buffer;
+        VkImageAspectFlags aspect;
+        uint32_t           mipLevels;
+        VkImageLayout      finalLayout;
+        ResourceState      initialState;
+        int32_t            transient; // index into m_transients, -1 for imported resources
+    };
+
+    struct Use
+    {
+        Resource resource;
+        Usage    usage;
+        bool     write;
+    };
+
+    struct Barrier
+    {
+        Resource              resource;
+        VkPipelineStageFlags2 srcStage;
+        VkAccessFlags2        srcAccess;
+        VkPipelineStageFlags2 dstStage;
+        VkAccessFlags2        dstAccess;
+        VkImageLayout         oldLayout;
+        VkImageLayout         newLayout;
+    };
+
+    struct Pass
+    {
+        const char*                    name;
+        ExecuteFunction                execute    = nullptr;
+        const void*                    function   = nullptr;
+        std::array<Use, MAX_PASS_USES> uses;
+        uint32_t                       useCount   = 0;
+        std::span<Barrier>             barriers;
+        bool                           sideEffect = false;
+        bool                           alive      = false;
+    };
+
+    struct Transient
+    {
+        ImageInfo            info;
+        VkImage              image  = nullptr;
+        VkImageView          view   = nullptr;
+        VkMemoryRequirements requirements {};
+        uint32_t             block  = 0;
+        uint32_t             first  = 0; // lifetime in pass indices
+        uint32_t             last   = 0;
+    };
+
+    struct MemoryBlock
+    {
+        VkDeviceMemory        memory   = nullptr;
+        VkDeviceSize          size     = 0;
+        uint32_t              typeBits = ~0U;
+        VkPipelineStageFlags2 stages   = VK_PIPELINE_STAGE_2_NONE; // every stage touching the block, to order aliased images
+        std::vector<uint32_t> transients;
+    };
+
+    static AccessInfo getAccessInfo(Usage usage, bool write) noexcept;
+
+    PassBuilder addPass(const char* name, const void* function, ExecuteFunction execute) noexcept;
+
+    VkResult cullPasses() noexcept;
+    VkResult allocateTransients() noexcept;
+    void     destroyTransients(DeletionQueue* deletionQueue) noexcept;
+    VkResult buildBarriers() noexcept;
+    void     addBarrier(std::span<Barrier> barriers, uint32_t& count, Resource resource, ResourceState& state, const AccessInfo& info) noexcept;
+    void     recordBarriers(VkCommandBuffer cmd, std::span<const Barrier> barriers) noexcept;
+
+    VkDevice         m_device;
+    VkPhysicalDevice m_GPU;
+    DeletionQueue*   m_deletionQueue;
+    LinearAllocator* m_frameArena;
+    bool             m_outOfMemory; // a pass had too many uses or the frame arena ran out, compile() fails
+
+    std::vector<Pass>         m_passes;    // cleared every frame, the capacity is kept
+    std::vector<ResourceData> m_resources;
+    std::span<Barrier>        m_finalBarriers;
+
+    std::vector<Transient>   m_transients;
+    std::vector<MemoryBlock> m_blocks;
+    uint32_t                 m_transientCount; // declared this frame
+    bool                     m_transientsDirty;
+
+//  Scratch storage of recordBarriers, sized by compile() for the largest batch
+    std::span<VkImageMemoryBarrier2>  m_imageBarriers;
+    std::span<VkBufferMemoryBarrier2> m_bufferBarriers;
+};
+
+
+template <class F>
+RenderGraph::PassBuilder RenderGraph::addPass(const char* name, const F& execute) noexcept
+{
+    const F* function = m_frameArena ? m_frameArena->construct<F>(execute) : nullptr;
+
+    if(!function)
+        m_outOfMemory = true;
+
+    return addPass(name, function, [](const void* function, VkCommandBuffer cmd)
+    {
+        (*static_cast<const F*>(function))(cmd);
+    });
+}
+
+#endif // !RENDER_GRAPH_HPP
\ No newline at end of file
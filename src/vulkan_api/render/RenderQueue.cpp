@@ -0,0 +1,144 @@
+#include <array>
+#include <algorithm>
+
+#include "vulkan_api/render/RenderQueue.hpp"
+
+
+namespace
+{
+    constexpr uint32_t DEPTH_BITS    = 24;
+    constexpr uint32_t MESH_BITS     = 16;
+    constexpr uint32_t MATERIAL_BITS = 16;
+    constexpr uint32_t PIPELINE_BITS = 8;
+
+    constexpr uint32_t MESH_SHIFT     = DEPTH_BITS;
+    constexpr uint32_t MATERIAL_SHIFT = MESH_SHIFT + MESH_BITS;
+    constexpr uint32_t PIPELINE_SHIFT = MATERIAL_SHIFT + MATERIAL_BITS;
+
+    static_assert(PIPELINE_SHIFT + PIPELINE_BITS == 64);
+
+    constexpr uint64_t mask(uint32_t bits) noexcept
+    {
+        return (uint64_t(1) << bits) - 1;
+    }
+
+//  Below this size the histogram setup costs more than a comparison sort
+    constexpr size_t RADIX_THRESHOLD = 64;
+}
+
+
+// depth is expected in [0, 1], e.g. view distance divided by the far plane
+uint64_t RenderQueue::makeKey(uint32_t pipeline, uint32_t material, uint32_t mesh, float depth) noexcept
+{
+    const float    clamped   = std::clamp(depth, 0.f, 1.f);
+    const uint64_t quantized = static_cast<uint64_t>(clamped * static_cast<float>(mask(DEPTH_BITS)));
+
+    return ((pipeline & mask(PIPELINE_BITS)) << PIPELINE_SHIFT) |
+           ((material & mask(MATERIAL_BITS)) << MATERIAL_SHIFT) |
+           ((mesh & mask(MESH_BITS)) << MESH_SHIFT) |
+           (quantized & mask(DEPTH_BITS));
+}
+
+
+uint32_t RenderQueue::getPipeline(uint64_t key) noexcept
+{
+    return static_cast<uint32_t>((key >> PIPELINE_SHIFT) & mask(PIPELINE_BITS));
+}
+
+
+uint32_t RenderQueue::getMaterial(uint64_t key) noexcept
+{
+    return static_cast<uint32_t>((key >> MATERIAL_SHIFT) & mask(MATERIAL_BITS));
+}
+
+
+uint32_t RenderQueue::getMesh(uint64_t key) noexcept
+{
+    return static_cast<uint32_t>((key >> MESH_SHIFT) & mask(MESH_BITS));
+}
+
+
+void RenderQueue::reserve(size_t count) noexcept
+{
+    m_entries.reserve(count);
+    m_scratch.reserve(count);
+}
+
+
+void RenderQueue::clear() noexcept
+{
+    m_entries.clear();
+}
+
+
+void RenderQueue::push(uint64_t key, uint32_t drawIndex) noexcept
+{
+    m_entries.push_back({ key, drawIndex });
+}
+
+
+// LSD radix sort on 8-bit digits, stable, so equal keys keep their submission order.
+// All 8 histograms are built in a single pass and digits that are the same for every key are skipped.
+void RenderQueue::sort() noexcept
+{
+    const size_t count = m_entries.size();
+
+    if(count < RADIX_THRESHOLD)
+    {// Insertion sort, stable as well and in place, std::stable_sort would allocate a buffer on every call
+        for (size_t i = 1; i < count; ++i)
+        {
+            const Entry entry = m_entries[i];
+            size_t      j     = i;
+
+            for (; j > 0 && m_entries[j - 1].key > entry.key; --j)
+                m_entries[j] = m_entries[j - 1];
+
+            m_entries[j] = entry;
+        }
+
+        return;
+    }
+
+    std::array<std::array<uint32_t, 256>, 8> histograms = {};
+
+    for (const auto& entry : m_entries)
+        for (uint32_t digit = 0; digit < 8; ++digit)
+            ++histograms[digit][(entry.key >> (digit * 8)) & 0xFF];
+
+    m_scratch.resize(count);
+
+    Entry* src = m_entries.data();
+    Entry* dst = m_scratch.data();
+
+    for (uint32_t digit = 0; digit < 8; ++digit)
+    {
+        auto& histogram = histograms[digit];
+        const uint32_t shift = digit * 8;
+
+        if(histogram[(src[0].key >> shift) & 0xFF] == count)
+            continue;
+
+        uint32_t offset = 0;
+
+        for (auto& bucket : histogram)
+        {
+            const uint32_t size = bucket;
+            bucket = offset;
+            offset += size;
+        }
+
+        for (size_t i = 0; i < count; ++i)
+            dst[histogram[(src[i].key >> shift) & 0xFF]++] = src[i];
+
+        std::swap(src, dst);
+    }
+
+    if(src != m_entries.data())
+        m_entries.swap(m_scratch);
+}
+
+
+std::span<const RenderQueue::Entry> RenderQueue::getEntries() const noexcept
+{
+    return m_entries;
+}
\ No newline at end of file
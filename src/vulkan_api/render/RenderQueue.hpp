@@ -0,0 +1,38 @@
+#ifndef RENDER_QUEUE_HPP
+#define RENDER_QUEUE_HPP
+
+#include <span>
+#include <vector>
+#include <cstdint>
+
+
+// Draws are sorted by a 64-bit key, most significant field first:
+// | pipeline 8 | material 16 | mesh 16 | depth 24 |
+// so state changes are grouped and draws sharing the same state go front to back.
+class RenderQueue
+{
+public:
+    struct Entry
+    {
+        uint64_t key;
+        uint32_t drawIndex;
+    };
+
+    static uint64_t makeKey(uint32_t pipeline, uint32_t material, uint32_t mesh, float depth) noexcept;
+    static uint32_t getPipeline(uint64_t key) noexcept;
+    static uint32_t getMaterial(uint64_t key) noexcept;
+    static uint32_t getMesh(uint64_t key)     noexcept;
+
+    void reserve(size_t count) noexcept;
+    void clear() noexcept;
+    void push(uint64_t key, uint32_t drawIndex) noexcept;
+    void sort() noexcept;
+
+    std::span<const Entry> getEntries() const noexcept;
+
+private:
+    std::vector<Entry> m_entries;
+    std::vector<Entry> m_scratch;
+};
+
+#endif // !RENDER_QUEUE_HPP
\ No newline at end of file
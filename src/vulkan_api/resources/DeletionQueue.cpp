@@ -0,0 +1,200 @@
+#include <algorithm>
+
+#include "vulkan_api/resources/DeletionQueue.hpp"
+
+
+DeletionQueue::DeletionQueue() noexcept:
+    m_device(nullptr),
+    m_head(0),
+    m_submittedValue(0)
+{
+
+}
+
+
+DeletionQueue::~DeletionQueue() = default;
+
+
+void DeletionQueue::create(VkDevice device) noexcept
+{
+    m_device = device;
+    m_head   = 0;
+    m_submittedValue = 0;
+    m_entries.clear();
+}
+
+
+void DeletionQueue::destroy() noexcept
+{
+    collect(UINT64_MAX);
+}
+
+
+void DeletionQueue::setSubmittedValue(uint64_t value) noexcept
+{
+    m_submittedValue = value;
+}
+
+
+uint64_t DeletionQueue::getSubmittedValue() const noexcept
+{
+    return m_submittedValue;
+}
+
+
+void DeletionQueue::collect(uint64_t completedValue) noexcept
+{
+    while (m_head < m_entries.size() && m_entries[m_head].value <= completedValue)
+        free(m_entries[m_head++]);
+
+//  Compact once the freed prefix dominates, so the vector stops growing without shifting on every call
+    if (m_head == m_entries.size())
+    {
+        m_entries.clear();
+        m_head = 0;
+    }
+    else if (m_head > 64 && m_head * 2 > m_entries.size())
+    {
+        m_entries.erase(m_entries.begin(), m_entries.begin() + m_head);
+        m_head = 0;
+    }
+}
+
+
+void DeletionQueue::retire(VkBuffer buffer, VkDeviceMemory memory) noexcept
+{
+    retire(buffer);
+    retire(memory);
+}
+
+
+void DeletionQueue::retire(VkImage image, VkDeviceMemory memory) noexcept
+{
+    retire(image);
+    retire(memory);
+}
+
+
+void DeletionQueue::retire(VkBuffer buffer) noexcept
+{
+    retireAfter(m_submittedValue, buffer);
+}
+
+
+void DeletionQueue::retire(VkImage image) noexcept
+{
+    retireAfter(m_submittedValue, image);
+}
+
+
+void DeletionQueue::retire(VkImageView imageView) noexcept
+{
+    retireAfter(m_submittedValue, imageView);
+}
+
+
+void DeletionQueue::retire(VkDeviceMemory memory) noexcept
+{
+    retireAfter(m_submittedValue, memory);
+}
+
+
+void DeletionQueue::retire(VkSampler sampler) noexcept
+{
+    push(m_submittedValue, Type::Sampler, sampler);
+}
+
+
+void DeletionQueue::retire(VkPipeline pipeline) noexcept
+{
+    push(m_submittedValue, Type::Pipeline, pipeline);
+}
+
+
+void DeletionQueue::retire(VkPipelineLayout layout) noexcept
+{
+    push(m_submittedValue, Type::PipelineLayout, layout);
+}
+
+
+void DeletionQueue::retire(VkDescriptorPool pool) noexcept
+{
+    push(m_submittedValue, Type::DescriptorPool, pool);
+}
+
+
+void DeletionQueue::retire(VkDescriptorSetLayout layout) noexcept
+{
+    push(m_submittedValue, Type::DescriptorSetLayout, layout);
+}
+
+
+void DeletionQueue::retire(VkSwapchainKHR swapchain) noexcept
+{
+    push(m_submittedValue, Type::Swapchain, swapchain);
+}
+
+
+void DeletionQueue::retireAfter(uint64_t value, VkBuffer buffer) noexcept
+{
+    push(value, Type::Buffer, buffer);
+}
+
+
+void DeletionQueue::retireAfter(uint64_t value, VkImage image) noexcept
+{
+    push(value, Type::Image, image);
+}
+
+
+void DeletionQueue::retireAfter(uint64_t value, VkImageView imageView) noexcept
+{
+    push(value, Type::ImageView, imageView);
+}
+
+
+void DeletionQueue::retireAfter(uint64_t value, VkDeviceMemory memory) noexcept
+{
+    push(value, Type::Memory, memory);
+}
+
+
+// Values mostly arrive in order, so the entry usually goes to the back. An older one (retireAfter) is placed
+// behind every entry that completes no later, so collect() can stop at the first entry still in flight
+void DeletionQueue::insert(const Entry& entry) noexcept
+{
+    if (m_entries.size() == m_head || m_entries.back().value <= entry.value)
+    {
+        m_entries.push_back(entry);
+        return;
+    }
+
+    const auto position = std::upper_bound(m_entries.begin() + m_head, m_entries.end(), entry.value,
+                                           [](uint64_t value, const Entry& other) { return value < other.value; });
+
+    m_entries.insert(position, entry);
+}
+
+
+size_t DeletionQueue::getPendingCount() const noexcept
+{
+    return m_entries.size() - m_head;
+}
+
+
+void DeletionQueue::free(const Entry& entry) noexcept
+{
+    switch (entry.type)
+    {
+        case Type::Buffer:              vkDestroyBuffer(m_device, reinterpret_cast<VkBuffer>(entry.handle), nullptr);                           break;
+        case Type::Image:               vkDestroyImage(m_device, reinterpret_cast<VkImage>(entry.handle), nullptr);                             break;
+        case Type::ImageView:           vkDestroyImageView(m_device, reinterpret_cast<VkImageView>(entry.handle), nullptr);                     break;
+        case Type::Memory:              vkFreeMemory(m_device, reinterpret_cast<VkDeviceMemory>(entry.handle), nullptr);                        break;
+        case Type::Sampler:             vkDestroySampler(m_device, reinterpret_cast<VkSampler>(entry.handle), nullptr);                         break;
+        case Type::Pipeline:            vkDestroyPipeline(m_device, reinterpret_cast<VkPipeline>(entry.handle), nullptr);                       break;
+        case Type::PipelineLayout:      vkDestroyPipelineLayout(m_device, reinterpret_cast<VkPipelineLayout>(entry.handle), nullptr);           break;
+        case Type::DescriptorPool:      vkDestroyDescriptorPool(m_device, reinterpret_cast<VkDescriptorPool>(entry.handle), nullptr);           break;
+        case Type::DescriptorSetLayout: vkDestroyDescriptorSetLayout(m_device, reinterpret_cast<VkDescriptorSetLayout>(entry.handle), nullptr); break;
+        case Type::Swapchain:           vkDestroySwapchainKHR(m_device, reinterpret_cast<VkSwapchainKHR>(entry.handle), nullptr);               break;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,92 @@
+#ifndef DELETION_QUEUE_HPP
+#define DELETION_QUEUE_HPP
+
+#include <vector>
+#include <cstdint>
+
+#include <vulkan/vulkan.h>
+
+
+// Deferred destruction keyed by the frame timeline (see SyncManager).
+// A retired object is tagged with the timeline value of the last submit that may use it,
+// by default the last submitted value, and collect() frees it once the GPU has reached that value.
+// Objects retired together are freed in the order they were retired, so retire views before their images and images before their memory.
+class DeletionQueue
+{
+public:
+    DeletionQueue() noexcept;
+    ~DeletionQueue();
+
+    void create(VkDevice device) noexcept;
+    void destroy() noexcept; // frees everything, the GPU must be idle
+
+//  Called after every submit and every completed wait
+    void setSubmittedValue(uint64_t value) noexcept;
+    uint64_t getSubmittedValue() const noexcept;
+    void collect(uint64_t completedValue) noexcept;
+
+    void retire(VkBuffer buffer, VkDeviceMemory memory) noexcept;
+    void retire(VkImage image, VkDeviceMemory memory)   noexcept;
+
+    void retire(VkBuffer buffer)              noexcept;
+    void retire(VkImage image)                noexcept;
+    void retire(VkImageView imageView)        noexcept;
+    void retire(VkDeviceMemory memory)        noexcept;
+    void retire(VkSampler sampler)            noexcept;
+    void retire(VkPipeline pipeline)          noexcept;
+    void retire(VkPipelineLayout layout)      noexcept;
+    void retire(VkDescriptorPool pool)        noexcept;
+    void retire(VkDescriptorSetLayout layout) noexcept;
+    void retire(VkSwapchainKHR swapchain)     noexcept;
+
+//  Explicit value for objects whose last use is older than the last submit
+    void retireAfter(uint64_t value, VkBuffer buffer)       noexcept;
+    void retireAfter(uint64_t value, VkImage image)         noexcept;
+    void retireAfter(uint64_t value, VkImageView imageView) noexcept;
+    void retireAfter(uint64_t value, VkDeviceMemory memory) noexcept;
+
+    size_t getPendingCount() const noexcept;
+
+private:
+    enum class Type : uint8_t
+    {
+        Buffer,
+        Image,
+        ImageView,
+        Memory,
+        Sampler,
+        Pipeline,
+        PipelineLayout,
+        DescriptorPool,
+        DescriptorSetLayout,
+        Swapchain
+    };
+
+    struct Entry
+    {
+        uint64_t value;
+        Type     type;
+        uint64_t handle; // non-dispatchable handles are 64 bits on every platform
+    };
+
+    template <class Handle>
+    void push(uint64_t value, Type type, Handle handle) noexcept
+    {
+    //  Null handles are skipped so optional members can be retired unconditionally
+        if (handle != VK_NULL_HANDLE)
+            insert({ value, type, reinterpret_cast<uint64_t>(handle) });
+    }
+
+    void insert(const Entry& entry) noexcept;
+
+    void free(const Entry& entry) noexcept;
+
+    VkDevice m_device;
+
+//  Sorted by value from m_head, entries with the same value in the order they were retired
+    std::vector<Entry> m_entries;
+    size_t             m_head;
+    uint64_t           m_submittedValue;
+};
+
+#endif // !DELETION_QUEUE_HPP
\ No newline at end of file
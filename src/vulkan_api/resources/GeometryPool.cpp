@@ -0,0 +1,326 @@
+#include <cstring>
+#include <algorithm>
+
+#include "vulkan_api/utils/Helpers.hpp"
+#include "vulkan_api/resources/GeometryPool.hpp"
+
+
+GeometryPool::GeometryPool() noexcept:
+    m_GPU(nullptr),
+    m_device(nullptr),
+    m_vertexBuffer(nullptr),
+    m_vertexMemory(nullptr),
+    m_indexBuffer(nullptr),
+    m_indexMemory(nullptr),
+    m_clusterBuffer(nullptr),
+    m_clusterMemory(nullptr),
+    m_vertexStride(0),
+    m_indexType(VK_INDEX_TYPE_UINT32)
+{
+
+}
+
+
+bool GeometryPool::create(VkPhysicalDevice GPU, VkDevice device, uint32_t vertexStride, uint32_t maxVertices, VkIndexType indexType, uint32_t maxIndices, uint32_t maxClusterWords) noexcept
+{
+    m_GPU          = GPU;
+    m_device       = device;
+    m_vertexStride = vertexStride;
+    m_indexType    = indexType;
+
+    const VkDeviceSize indexSize = (indexType == VK_INDEX_TYPE_UINT16) ? sizeof(uint16_t) : sizeof(uint32_t);
+
+    m_vertexBuffer = vk::createBuffer(static_cast<VkDeviceSize>(vertexStride) * maxVertices, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_vertexMemory, device, GPU);
+
+    m_indexBuffer = vk::createBuffer(indexSize * maxIndices, VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_indexMemory, device, GPU);
+
+    if(!m_vertexBuffer || !m_indexBuffer)
+        return false;
+
+    if(maxClusterWords)
+    {
+        m_clusterBuffer = vk::createBuffer(sizeof(uint32_t) * static_cast<VkDeviceSize>(maxClusterWords), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                           VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_clusterMemory, device, GPU);
+
+        if(!m_clusterBuffer)
+            return false;
+    }
+
+    m_vertices.reset(maxVertices);
+    m_indices.reset(maxIndices);
+    m_clusters.reset(maxClusterWords);
+    m_pending.clear();
+
+    return true;
+}
+
+
+void GeometryPool::destroy() noexcept
+{
+    if(!m_device)
+        return;
+
+    vkDestroyBuffer(m_device, m_vertexBuffer, nullptr);
+    vkFreeMemory(m_device, m_vertexMemory, nullptr);
+    vkDestroyBuffer(m_device, m_indexBuffer, nullptr);
+    vkFreeMemory(m_device, m_indexMemory, nullptr);
+
+    if(m_clusterBuffer)
+    {
+        vkDestroyBuffer(m_device, m_clusterBuffer, nullptr);
+        vkFreeMemory(m_device, m_clusterMemory, nullptr);
+    }
+
+    m_vertexBuffer  = nullptr;
+    m_vertexMemory  = nullptr;
+    m_indexBuffer   = nullptr;
+    m_indexMemory   = nullptr;
+    m_clusterBuffer = nullptr;
+    m_clusterMemory = nullptr;
+    m_pending.clear();
+}
+
+
+bool GeometryPool::upload(std::span<const std::byte> vertices, std::span<const uint32_t> indices, VkCommandPool pool, VkQueue queue, Mesh& mesh) noexcept
+{
+    return upload(vertices, std::as_bytes(indices), VK_INDEX_TYPE_UINT32, pool, queue, mesh);
+}
+
+
+bool GeometryPool::upload(std::span<const std::byte> vertices, std::span<const std::byte> indices, VkIndexType indexType, VkCommandPool pool, VkQueue queue, Mesh& mesh) noexcept
+{
+    return upload(vertices, indices, indexType, {}, pool, queue, mesh);
+}
+
+
+bool GeometryPool::upload(std::span<const std::byte> vertices, std::span<const std::byte> indices, VkIndexType indexType, std::span<const std::byte> clusters, 
+                          VkCommandPool pool, VkQueue queue, Mesh& mesh) noexcept
+{
+    const size_t   sourceIndexSize = (indexType == VK_INDEX_TYPE_UINT16) ? sizeof(uint16_t) : sizeof(uint32_t);
+    const uint32_t vertexCount     = static_cast<uint32_t>(vertices.size() / m_vertexStride);
+    const uint32_t indexCount      = static_cast<uint32_t>(indices.size() / sourceIndexSize);
+    const uint32_t clusterSize     = static_cast<uint32_t>(clusters.size() / sizeof(uint32_t));
+
+    if(clusters.size() % sizeof(uint32_t) != 0 || (clusterSize && !m_clusterBuffer))
+        return false;
+
+//  0xFFFF is kept free for primitive restart
+    if(m_indexType == VK_INDEX_TYPE_UINT16 && vertexCount >= UINT16_MAX)
+        return false;
+
+    const uint32_t vertexOffset = m_vertices.allocate(vertexCount);
+
+    if(vertexOffset == UINT32_MAX)
+        return false;
+
+    const uint32_t firstIndex = m_indices.allocate(indexCount);
+
+    if(firstIndex == UINT32_MAX)
+    {
+        m_vertices.free(vertexOffset, vertexCount);
+        return false;
+    }
+
+    const uint32_t clusterOffset = m_clusters.allocate(clusterSize);
+
+    if(clusterOffset == UINT32_MAX)
+    {
+        m_vertices.free(vertexOffset, vertexCount);
+        m_indices.free(firstIndex, indexCount);
+        return false;
+    }
+
+    const VkDeviceSize vertexBytes = static_cast<VkDeviceSize>(vertexCount) * m_vertexStride;
+    const VkDeviceSize indexSize   = (m_indexType == VK_INDEX_TYPE_UINT16) ? sizeof(uint16_t) : sizeof(uint32_t);
+    const VkDeviceSize indexBytes  = indexSize * indexCount;
+    const VkDeviceSize stagingSize = vertexBytes + indexBytes + clusters.size();
+
+    VkDeviceMemory stagingMemory;
+    VkBuffer stagingBuffer = vk::createBuffer(stagingSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 
+                                              stagingMemory, m_device, m_GPU);
+
+    bool uploaded = false;
+
+    if(void* ptr; stagingBuffer && vkMapMemory(m_device, stagingMemory, 0, stagingSize, 0, &ptr) == VK_SUCCESS)
+    {
+        auto data = static_cast<std::byte*>(ptr);
+        memcpy(data, vertices.data(), vertexBytes);
+
+        if(indexType == m_indexType)
+            memcpy(data + vertexBytes, indices.data(), indexBytes);
+        else if(m_indexType == VK_INDEX_TYPE_UINT16)
+        {
+            const auto source = reinterpret_cast<const uint32_t*>(indices.data());
+            std::copy(source, source + indexCount, reinterpret_cast<uint16_t*>(data + vertexBytes));
+        }
+        else
+        {
+            const auto source = reinterpret_cast<const uint16_t*>(indices.data());
+            std::copy(source, source + indexCount, reinterpret_cast<uint32_t*>(data + vertexBytes));
+        }
+
+        if(!clusters.empty())
+            memcpy(data + vertexBytes + indexBytes, clusters.data(), clusters.size());
+
+        vkUnmapMemory(m_device, stagingMemory);
+
+        if(VkCommandBuffer cmd = vk::beginSingleTimeCommands(m_device, pool))
+        {
+            const VkBufferCopy vertexRegion = { 0, vertexOffset * static_cast<VkDeviceSize>(m_vertexStride), vertexBytes };
+            const VkBufferCopy indexRegion  = { vertexBytes, firstIndex * indexSize, indexBytes };
+            const VkBufferCopy clusterRegion = { vertexBytes + indexBytes, clusterOffset * sizeof(uint32_t), clusters.size() };
+
+            if(vertexBytes)
+                vkCmdCopyBuffer(cmd, stagingBuffer, m_vertexBuffer, 1, &vertexRegion);
+
+            if(indexBytes)
+                vkCmdCopyBuffer(cmd, stagingBuffer, m_indexBuffer, 1, &indexRegion);
+
+            if(!clusters.empty())
+                vkCmdCopyBuffer(cmd, stagingBuffer, m_clusterBuffer, 1, &clusterRegion);
+
+            vk::endSingleTimeCommands(cmd, m_device, pool, queue);
+            uploaded = true;
+        }
+    }
+
+    vkDestroyBuffer(m_device, stagingBuffer, nullptr);
+    vkFreeMemory(m_device, stagingMemory, nullptr);
+
+    if(!uploaded)
+    {
+        m_vertices.free(vertexOffset, vertexCount);
+        m_indices.free(firstIndex, indexCount);
+        m_clusters.free(clusterOffset, clusterSize);
+
+        return false;
+    }
+
+    mesh = 
+    {
+        .vertexOffset  = static_cast<int32_t>(vertexOffset),
+        .vertexCount   = vertexCount,
+        .firstIndex    = firstIndex,
+        .indexCount    = indexCount,
+        .clusterOffset = clusterOffset,
+        .clusterSize   = clusterSize
+    };
+
+    return true;
+}
+
+
+void GeometryPool::release(const Mesh& mesh, uint64_t lastUseValue) noexcept
+{
+    m_pending.push_back({ lastUseValue, mesh });
+}
+
+
+void GeometryPool::collect(uint64_t completedValue) noexcept
+{
+    std::erase_if(m_pending, [this, completedValue](const PendingRelease& pending)
+    {
+        if(pending.value > completedValue)
+            return false;
+
+        m_vertices.free(static_cast<uint32_t>(pending.mesh.vertexOffset), pending.mesh.vertexCount);
+        m_indices.free(pending.mesh.firstIndex, pending.mesh.indexCount);
+        m_clusters.free(pending.mesh.clusterOffset, pending.mesh.clusterSize);
+
+        return true;
+    });
+}
+
+
+void GeometryPool::bind(VkCommandBuffer cmd) const noexcept
+{
+    const VkDeviceSize offset = 0;
+
+    vkCmdBindVertexBuffers(cmd, 0, 1, &m_vertexBuffer, &offset);
+    vkCmdBindIndexBuffer(cmd, m_indexBuffer, 0, m_indexType);
+}
+
+
+VkBuffer GeometryPool::getVertexBuffer() const noexcept
+{
+    return m_vertexBuffer;
+}
+
+
+VkBuffer GeometryPool::getIndexBuffer() const noexcept
+{
+    return m_indexBuffer;
+}
+
+
+VkBuffer GeometryPool::getClusterBuffer() const noexcept
+{
+    return m_clusterBuffer;
+}
+
+
+VkIndexType GeometryPool::getIndexType() const noexcept
+{
+    return m_indexType;
+}
+
+
+void GeometryPool::RangeAllocator::reset(uint32_t capacity) noexcept
+{
+    m_free.clear();
+
+    if(capacity)
+        m_free.push_back({ 0, capacity });
+}
+
+
+uint32_t GeometryPool::RangeAllocator::allocate(uint32_t size) noexcept
+{
+    if(size == 0)
+        return 0;
+
+    auto range = std::find_if(m_free.begin(), m_free.end(), [size](const Range& range) { return range.size >= size; });
+
+    if(range == m_free.end())
+        return UINT32_MAX;
+
+    const uint32_t offset = range->offset;
+
+    range->offset += size;
+    range->size   -= size;
+
+    if(range->size == 0)
+        m_free.erase(range);
+
+    return offset;
+}
+
+
+void GeometryPool::RangeAllocator::free(uint32_t offset, uint32_t size) noexcept
+{
+    if(size == 0)
+        return;
+
+    auto next = std::lower_bound(m_free.begin(), m_free.end(), offset, [](const Range& range, uint32_t offset) { return range.offset < offset; });
+
+    const bool mergePrev = (next != m_free.begin()) && (std::prev(next)->offset + std::prev(next)->size == offset);
+    const bool mergeNext = (next != m_free.end()) && (offset + size == next->offset);
+
+    if(mergePrev && mergeNext)
+    {
+        std::prev(next)->size += size + next->size;
+        m_free.erase(next);
+    }
+    else if(mergePrev)
+    {
+        std::prev(next)->size += size;
+    }
+    else if(mergeNext)
+    {
+        next->offset = offset;
+        next->size  += size;
+    }
+    else m_free.insert(next, { offset, size });
+}
\ No newline at end of file
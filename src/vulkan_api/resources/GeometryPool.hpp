@@ -0,0 +1,99 @@
+#ifndef GEOMETRY_POOL_HPP
+#define GEOMETRY_POOL_HPP
+
+#include <span>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include <vulkan/vulkan.h>
+
+
+// One device-local vertex buffer and one index buffer shared by every mesh of a vertex layout.
+// Meshes get ranges of both from first-fit free-lists and are drawn through vertexOffset/firstIndex,
+// so a single bind covers all of them and multi-draw indirect can mix them freely.
+// Indices stay mesh-local, a 16-bit pool holds any number of meshes below 65535 vertices each.
+// Optionally a storage buffer holds the meshes' cluster blobs (see MeshFile) for GPU culling and mesh shaders, which also read the vertex buffer as storage.
+class GeometryPool
+{
+public:
+    struct Mesh
+    {
+        int32_t  vertexOffset = 0;
+        uint32_t vertexCount  = 0;
+        uint32_t firstIndex   = 0;
+        uint32_t indexCount   = 0;
+        uint32_t clusterOffset = 0; // 32-bit words into the cluster buffer
+        uint32_t clusterSize   = 0; // words, 0 without clusters
+    };
+
+    GeometryPool() noexcept;
+
+    bool create(VkPhysicalDevice GPU, VkDevice device, uint32_t vertexStride, uint32_t maxVertices, VkIndexType indexType, uint32_t maxIndices, uint32_t maxClusterWords = 0) noexcept;
+    void destroy() noexcept;
+
+//  Blocks until the copy is done. False when the pool is full or the mesh needs wider indices than the pool has
+    bool upload(std::span<const std::byte> vertices, std::span<const uint32_t> indices, VkCommandPool pool, VkQueue queue, Mesh& mesh) noexcept;
+//  Indices of either type as stored, e.g. straight from a mapped mesh file, converted to the pool's type while staging
+    bool upload(std::span<const std::byte> vertices, std::span<const std::byte> indices, VkIndexType indexType, VkCommandPool pool, VkQueue queue, Mesh& mesh) noexcept;
+//  Same with the mesh's cluster blob, the size has to be a multiple of 4
+    bool upload(std::span<const std::byte> vertices, std::span<const std::byte> indices, VkIndexType indexType, std::span<const std::byte> clusters, 
+                VkCommandPool pool, VkQueue queue, Mesh& mesh) noexcept;
+
+//  The ranges return to the free-lists once collect() passes lastUseValue on the frame timeline
+    void release(const Mesh& mesh, uint64_t lastUseValue) noexcept;
+    void collect(uint64_t completedValue) noexcept;
+
+    void bind(VkCommandBuffer cmd) const noexcept;
+
+    VkBuffer    getVertexBuffer() const noexcept;
+    VkBuffer    getIndexBuffer()  const noexcept;
+    VkBuffer    getClusterBuffer() const noexcept; // nullptr when created without clusters
+    VkIndexType getIndexType()    const noexcept;
+
+private:
+//  Free ranges sorted by offset, adjacent ones are merged on free
+    class RangeAllocator
+    {
+    public:
+        void     reset(uint32_t capacity) noexcept;
+        uint32_t allocate(uint32_t size)  noexcept; // UINT32_MAX when no range is large enough
+        void     free(uint32_t offset, uint32_t size) noexcept;
+
+    private:
+        struct Range
+        {
+            uint32_t offset;
+            uint32_t size;
+        };
+
+        std::vector<Range> m_free;
+    };
+
+    struct PendingRelease
+    {
+        uint64_t value;
+        Mesh     mesh;
+    };
+
+    VkPhysicalDevice m_GPU;
+    VkDevice         m_device;
+
+    VkBuffer       m_vertexBuffer;
+    VkDeviceMemory m_vertexMemory;
+    VkBuffer       m_indexBuffer;
+    VkDeviceMemory m_indexMemory;
+    VkBuffer       m_clusterBuffer;
+    VkDeviceMemory m_clusterMemory;
+
+    uint32_t    m_vertexStride;
+    VkIndexType m_indexType;
+
+    RangeAllocator m_vertices;
+    RangeAllocator m_indices;
+    RangeAllocator m_clusters;
+
+    std::vector<PendingRelease> m_pending;
+};
+
+#endif // !GEOMETRY_POOL_HPP
\ No newline at end of file
@@ -0,0 +1,113 @@
+#include <cstring>
+#include <algorithm>
+
+#include "vulkan_api/utils/Helpers.hpp"
+#include "vulkan_api/resources/InstanceBuffer.hpp"
+
+
+InstanceBuffer::InstanceBuffer() noexcept:
+    m_device(nullptr),
+    m_capacity(0)
+{
+
+}
+
+
+bool InstanceBuffer::create(VkPhysicalDevice GPU, VkDevice device, uint32_t capacity, uint32_t framesInFlight) noexcept
+{
+    if(framesInFlight > MAX_FRAMES)
+        return false;
+
+    m_device   = device;
+    m_capacity = std::max(capacity, 1U);
+
+    m_copies.resize(std::max(framesInFlight, 1U));
+    m_queued.assign(m_capacity, 0);
+
+    const VkDeviceSize size = sizeof(mat4s) * static_cast<VkDeviceSize>(m_capacity);
+
+    for (auto& copy : m_copies)
+    {
+        copy.handle = vk::createBuffer(size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, copy.memory, device, GPU);
+
+        if(!copy.handle)
+            return false;
+
+        if (void* ptr; vkMapMemory(device, copy.memory, 0, size, 0, &ptr) == VK_SUCCESS)
+            copy.mapped = static_cast<mat4s*>(ptr);
+        else
+            return false;
+
+        copy.pending.clear();
+        copy.pending.reserve(m_capacity);
+    }
+
+    return true;
+}
+
+
+void InstanceBuffer::destroy() noexcept
+{
+    if(!m_device)
+        return;
+
+    for (auto& copy : m_copies)
+    {
+        if(copy.handle)
+            vkDestroyBuffer(m_device, copy.handle, nullptr);
+
+        if(copy.memory)
+            vkFreeMemory(m_device, copy.memory, nullptr);
+    }
+
+    m_copies.clear();
+    m_queued.clear();
+    m_device = nullptr;
+}
+
+
+void InstanceBuffer::markChanged(std::span<const uint32_t> indices) noexcept
+{
+    const auto copyCount = static_cast<uint32_t>(m_copies.size());
+
+    for (auto index : indices)
+    {
+        if(index >= m_capacity)
+            continue;
+
+        for (uint32_t i = 0; i < copyCount; ++i)
+        {
+            if(m_queued[index] & (1U << i))
+                continue;
+
+            m_queued[index] |= (1U << i);
+            m_copies[i].pending.push_back(index);
+        }
+    }
+}
+
+
+void InstanceBuffer::write(uint32_t frame, std::span<const mat4s> models) noexcept
+{
+    auto& copy = m_copies[frame];
+
+    for (auto index : copy.pending)
+    {
+        memcpy(copy.mapped + index, &models[index], sizeof(mat4s));
+        m_queued[index] &= ~(1U << frame);
+    }
+
+    copy.pending.clear();
+}
+
+
+VkBuffer InstanceBuffer::getBuffer(uint32_t frame) const noexcept
+{
+    return m_copies[frame].handle;
+}
+
+
+uint32_t InstanceBuffer::getCapacity() const noexcept
+{
+    return m_capacity;
+}
\ No newline at end of file
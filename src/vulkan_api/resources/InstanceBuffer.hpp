@@ -0,0 +1,51 @@
+#ifndef INSTANCE_BUFFER_HPP
+#define INSTANCE_BUFFER_HPP
+
+#include <span>
+#include <vector>
+#include <cstdint>
+
+#include <vulkan/vulkan.h>
+#include <cglm/struct/mat4.h>
+
+
+// Model matrices the vertex shaders read by gl_InstanceIndex, one host-visible copy per frame in flight.
+// Changed objects are queued for every copy and written into a copy when its frame slot comes around,
+// so an object that stops changing costs nothing once all copies have caught up.
+class InstanceBuffer
+{
+public:
+    static constexpr uint32_t MAX_FRAMES = 32; // one bit per copy
+
+    InstanceBuffer() noexcept;
+
+//  Fails for more than MAX_FRAMES frames in flight
+    bool create(VkPhysicalDevice GPU, VkDevice device, uint32_t capacity, uint32_t framesInFlight) noexcept;
+    void destroy() noexcept;
+
+//  Indices from TransformStore::update()
+    void markChanged(std::span<const uint32_t> indices) noexcept;
+
+//  The GPU must be done with the frame's copy
+    void write(uint32_t frame, std::span<const mat4s> models) noexcept;
+
+    VkBuffer getBuffer(uint32_t frame) const noexcept;
+    uint32_t getCapacity()             const noexcept;
+
+private:
+    struct Copy
+    {
+        VkBuffer              handle  = nullptr;
+        VkDeviceMemory        memory  = nullptr;
+        mat4s*                mapped  = nullptr;
+        std::vector<uint32_t> pending; // reserved to capacity
+    };
+
+    VkDevice m_device;
+
+    std::vector<Copy>     m_copies;
+    std::vector<uint32_t> m_queued; // per object, a bit for each copy it is pending in
+    uint32_t              m_capacity;
+};
+
+#endif // !INSTANCE_BUFFER_HPP
\ No newline at end of file
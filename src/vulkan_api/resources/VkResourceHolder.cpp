@@ -1,3 +1,6 @@
+#include <algorithm>
+
+#include "vulkan_api/resources/DeletionQueue.hpp"
 #include "vulkan_api/resources/VkResourceHolder.hpp"
 
 
@@ -11,6 +14,21 @@ VkResourceHolder::VkResourceHolder(VkPhysicalDevice GPU, VkDevice device, VkQueu
 }
 
 
+void VkResourceHolder::destroyBuffer(const Buffer& buffer, DeletionQueue& deletionQueue) noexcept
+{
+    auto it = std::find_if(m_buffers.begin(), m_buffers.end(), [&buffer](const BufferData& data)
+    {
+        return data.handle == buffer.handle;
+    });
+
+    if(it != m_buffers.end())
+    {
+        deletionQueue.retire(it->handle, it->memory);
+        m_buffers.erase(it);
+    }
+}
+
+
 void VkResourceHolder::cleanup() noexcept
 {
     for(const auto& buffer: m_buffers)
@@ -65,6 +65,8 @@ public:
         return {};
     }
 
+//  Frees one buffer mid-session, once the frames that may still read it have completed
+    void destroyBuffer(const Buffer& buffer, class DeletionQueue& deletionQueue) noexcept;
     void cleanup() noexcept;
 
 private:
@@ -1,52 +1,224 @@
+#include <array>
+#include <algorithm>
+
 #include <vulkan/vulkan.h>
 
 #include "vulkan_api/sync/SyncManager.hpp"
 
 
 SyncManager::SyncManager() noexcept:
+    timeline(nullptr),
+    timelineValue(0),
+    completedValue(0),
+    framesInFlight(0),
     currentFrame(0)
 {
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
-    {
-        imageAvailableSemaphores[i] = nullptr;
-        renderFinishedSemaphores[i] = nullptr;
-        inFlightFences[i] = nullptr;
-    }
+
 }
 
 
 SyncManager::~SyncManager() = default;
 
 
-bool SyncManager::create(VkDevice logicalDevice) noexcept
+bool SyncManager::create(VkDevice logicalDevice, uint32_t frameCount) noexcept
 {
+    framesInFlight = std::max(frameCount, 1U);
+    currentFrame   = 0;
+
+    imageAvailableSemaphores.assign(framesInFlight, nullptr);
+    renderFinishedSemaphores.assign(framesInFlight, nullptr);
+    frameTimelineValues.assign(framesInFlight, 0);
+
     VkSemaphoreCreateInfo semaphoreInfo{};
     semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
-    VkFenceCreateInfo fenceInfo{};
-    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-    fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
+    for (size_t i = 0; i < framesInFlight; ++i)
     {
         if (vkCreateSemaphore(logicalDevice, &semaphoreInfo, nullptr, &imageAvailableSemaphores[i]) != VK_SUCCESS ||
-            vkCreateSemaphore(logicalDevice, &semaphoreInfo, nullptr, &renderFinishedSemaphores[i]) != VK_SUCCESS ||
-            vkCreateFence(logicalDevice, &fenceInfo, nullptr, &inFlightFences[i]) != VK_SUCCESS)
+            vkCreateSemaphore(logicalDevice, &semaphoreInfo, nullptr, &renderFinishedSemaphores[i]) != VK_SUCCESS)
         {
             return false;
         }
     }
 
-    return true;
+    VkSemaphoreTypeCreateInfo timelineInfo{};
+    timelineInfo.sType         = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    timelineInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    timelineInfo.initialValue  = 0;
+
+    semaphoreInfo.pNext = &timelineInfo;
+
+    return (vkCreateSemaphore(logicalDevice, &semaphoreInfo, nullptr, &timeline) == VK_SUCCESS);
 }
 
 
 void SyncManager::destroy(VkDevice logicalDevice) noexcept
 {
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
+    for (size_t i = 0; i < imageAvailableSemaphores.size(); ++i)
     {
         vkDestroySemaphore(logicalDevice, renderFinishedSemaphores[i], nullptr);
         vkDestroySemaphore(logicalDevice, imageAvailableSemaphores[i], nullptr);
-        vkDestroyFence(logicalDevice, inFlightFences[i], nullptr);
     }
+
+    vkDestroySemaphore(logicalDevice, timeline, nullptr);
+
+    imageAvailableSemaphores.clear();
+    renderFinishedSemaphores.clear();
+    frameTimelineValues.clear();
+}
+
+
+bool SyncManager::submit(VkQueue queue, VkCommandBuffer commandBuffer, uint32_t frame) noexcept
+{
+    const VkSemaphoreSubmitInfo waitInfo = 
+    {
+        .sType       = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+        .pNext       = nullptr,
+        .semaphore   = imageAvailableSemaphores[frame],
+        .value       = 0,
+        .stageMask   = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+        .deviceIndex = 0
+    };
+
+    const uint64_t signalValue = timelineValue + 1;
+
+    const std::array<VkSemaphoreSubmitInfo, 2> signalInfos = 
+    {
+        VkSemaphoreSubmitInfo
+        {
+            .sType       = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+            .pNext       = nullptr,
+            .semaphore   = renderFinishedSemaphores[frame],
+            .value       = 0,
+            .stageMask   = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+            .deviceIndex = 0
+        },
+        VkSemaphoreSubmitInfo
+        {
+            .sType       = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+            .pNext       = nullptr,
+            .semaphore   = timeline,
+            .value       = signalValue,
+            .stageMask   = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+            .deviceIndex = 0
+        }
+    };
+
+    const VkCommandBufferSubmitInfo commandBufferInfo = 
+    {
+        .sType         = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
+        .pNext         = nullptr,
+        .commandBuffer = commandBuffer,
+        .deviceMask    = 0
+    };
+
+    const VkSubmitInfo2 submitInfo = 
+    {
+        .sType                    = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
+        .pNext                    = nullptr,
+        .flags                    = 0,
+        .waitSemaphoreInfoCount   = 1,
+        .pWaitSemaphoreInfos      = &waitInfo,
+        .commandBufferInfoCount   = 1,
+        .pCommandBufferInfos      = &commandBufferInfo,
+        .signalSemaphoreInfoCount = static_cast<uint32_t>(signalInfos.size()),
+        .pSignalSemaphoreInfos    = signalInfos.data()
+    };
+
+    if (vkQueueSubmit2(queue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+        return false;
+
+    timelineValue = signalValue;
+    frameTimelineValues[frame] = signalValue;
+
+    return true;
+}
+
+
+
+bool SyncManager::skip(VkQueue queue, uint32_t frame) noexcept
+{
+    const VkSemaphoreSubmitInfo waitInfo = 
+    {
+        .sType       = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+        .pNext       = nullptr,
+        .semaphore   = imageAvailableSemaphores[frame],
+        .value       = 0,
+        .stageMask   = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+        .deviceIndex = 0
+    };
+
+    const uint64_t signalValue = timelineValue + 1;
+
+    const VkSemaphoreSubmitInfo signalInfo = 
+    {
+        .sType       = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+        .pNext       = nullptr,
+        .semaphore   = timeline,
+        .value       = signalValue,
+        .stageMask   = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+        .deviceIndex = 0
+    };
+
+    const VkSubmitInfo2 submitInfo = 
+    {
+        .sType                    = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
+        .pNext                    = nullptr,
+        .flags                    = 0,
+        .waitSemaphoreInfoCount   = 1,
+        .pWaitSemaphoreInfos      = &waitInfo,
+        .commandBufferInfoCount   = 0,
+        .pCommandBufferInfos      = nullptr,
+        .signalSemaphoreInfoCount = 1,
+        .pSignalSemaphoreInfos    = &signalInfo
+    };
+
+    if (vkQueueSubmit2(queue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+        return false;
+
+    timelineValue = signalValue;
+    frameTimelineValues[frame] = signalValue;
+
+    return true;
+}
+
+uint64_t SyncManager::getCompletedValue(VkDevice logicalDevice) noexcept
+{
+    uint64_t value = 0;
+
+    if (vkGetSemaphoreCounterValue(logicalDevice, timeline, &value) == VK_SUCCESS)
+        completedValue = std::max(completedValue, value);
+
+    return completedValue;
+}
+
+
+// Answers from the cached value first, the driver is only asked when that is not enough
+bool SyncManager::isComplete(VkDevice logicalDevice, uint64_t value) noexcept
+{
+    return (value <= completedValue) || (value <= getCompletedValue(logicalDevice));
+}
+
+
+bool SyncManager::wait(VkDevice logicalDevice, uint64_t value, uint64_t timeout) noexcept
+{
+    if(value <= completedValue)
+        return true;
+
+    const VkSemaphoreWaitInfo waitInfo = 
+    {
+        .sType          = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+        .pNext          = nullptr,
+        .flags          = 0,
+        .semaphoreCount = 1,
+        .pSemaphores    = &timeline,
+        .pValues        = &value
+    };
+
+    if (vkWaitSemaphores(logicalDevice, &waitInfo, timeout) != VK_SUCCESS)
+        return false;
+
+    completedValue = std::max(completedValue, value);
+
+    return true;
 }
\ No newline at end of file
@@ -1,24 +1,39 @@
 #ifndef SYNC_MANAGER_HPP
 #define SYNC_MANAGER_HPP
 
-#include <array>
-
-#include "vulkan_api/utils/Defines.hpp"
+#include <vector>
+#include <cstdint>
 
 
+// One timeline semaphore counts the submissions of the main queue: every submit signals the next value,
+// so "the GPU has finished the work of submit N" is a single value comparison for any subsystem.
+// Binary semaphores remain only for the swapchain, which cannot use timelines.
 class SyncManager
 {
 public:
     SyncManager() noexcept;
     ~SyncManager();
 
-    bool create(struct VkDevice_T* logicalDevice) noexcept;
+    bool create(struct VkDevice_T* logicalDevice, uint32_t framesInFlight) noexcept;
     void destroy(struct VkDevice_T* logicalDevice) noexcept;
 
-    std::array<struct VkSemaphore_T*, MAX_FRAMES_IN_FLIGHT> imageAvailableSemaphores;
-    std::array<struct VkSemaphore_T*, MAX_FRAMES_IN_FLIGHT> renderFinishedSemaphores;
-    std::array<struct VkFence_T*, MAX_FRAMES_IN_FLIGHT>     inFlightFences;
-    uint32_t                                                currentFrame;
+//  Submits the frame's commands: waits for the acquired image, signals the present semaphore and the next timeline value
+    bool submit(struct VkQueue_T* queue, struct VkCommandBuffer_T* commandBuffer, uint32_t frame) noexcept;
+//  For a frame abandoned after its image was acquired: consumes the acquire wait and signals only the next timeline value, nothing will be presented
+    bool skip(struct VkQueue_T* queue, uint32_t frame) noexcept;
+
+    uint64_t getCompletedValue(struct VkDevice_T* logicalDevice) noexcept;
+    bool     isComplete(struct VkDevice_T* logicalDevice, uint64_t value) noexcept;
+    bool     wait(struct VkDevice_T* logicalDevice, uint64_t value, uint64_t timeout = UINT64_MAX) noexcept;
+
+    std::vector<struct VkSemaphore_T*> imageAvailableSemaphores;
+    std::vector<struct VkSemaphore_T*> renderFinishedSemaphores;
+    struct VkSemaphore_T*              timeline;
+    std::vector<uint64_t>              frameTimelineValues; // value signaled by the last submit of each frame slot
+    uint64_t                           timelineValue;       // last value handed to a submit
+    uint64_t                           completedValue;      // last value known to be reached
+    uint32_t                           framesInFlight;
+    uint32_t                           currentFrame;
 };
 
 #endif // !SYNC_MANAGER_HPP
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include <stb_image.h>
 
 #include "vulkan_api/utils/Helpers.hpp"
+#include "vulkan_api/resources/DeletionQueue.hpp"
 #include "vulkan_api/texture/Texture2D.hpp"
 
 namespace
@@ -58,7 +59,13 @@ bool Texture2D::loadFromFile(const char* filepath, VkPhysicalDevice GPU, VkDevic
     if ( ! stbImage.pixels )
         return false;
 
-    VkDeviceSize imageSize = stbImage.width * stbImage.height * 4;
+    return loadFromPixels(stbImage.pixels, static_cast<uint32_t>(stbImage.width), static_cast<uint32_t>(stbImage.height), GPU, device, pool, queue);
+}
+
+
+bool Texture2D::loadFromPixels(const void* rgba, uint32_t width, uint32_t height, VkPhysicalDevice GPU, VkDevice device, VkCommandPool pool, VkQueue queue) noexcept
+{
+    VkDeviceSize imageSize = static_cast<VkDeviceSize>(width) * height * 4;
     
     VkDeviceMemory stagingBufferMemory;
     VkBuffer stagingBuffer = vk::createBuffer(imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBufferMemory, device, GPU);
@@ -70,14 +77,14 @@ bool Texture2D::loadFromFile(const char* filepath, VkPhysicalDevice GPU, VkDevic
 
     if (void* data; vkMapMemory(device, stagingBufferMemory, 0, imageSize, 0, &data) == VK_SUCCESS)
     {
-        memcpy(data, stbImage.pixels, static_cast<size_t>(imageSize));
+        memcpy(data, rgba, static_cast<size_t>(imageSize));
         vkUnmapMemory(device, stagingBufferMemory);
     }
     else return false;
 
     if(vk::createImage2D(
-        stbImage.width, 
-        stbImage.height, 
+        width, 
+        height, 
         VK_FORMAT_R8G8B8A8_SRGB, 
         VK_IMAGE_TILING_OPTIMAL, 
         VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, 
@@ -91,7 +98,7 @@ bool Texture2D::loadFromFile(const char* filepath, VkPhysicalDevice GPU, VkDevic
     if ( ! vk::transitionImageLayout(m_image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, device, pool, queue))
         return false;
 
-    if ( ! vk::copyBufferToImage(stagingBuffer, m_image, static_cast<uint32_t>(stbImage.width), static_cast<uint32_t>(stbImage.height), device, pool, queue))
+    if ( ! vk::copyBufferToImage(stagingBuffer, m_image, width, height, device, pool, queue))
         return false;
 
     if ( ! vk::transitionImageLayout(m_image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, device, pool, queue))
@@ -128,6 +135,19 @@ void Texture2D::destroy(VkDevice device) noexcept
 }
 
 
+void Texture2D::destroy(DeletionQueue& deletionQueue) noexcept
+{
+    deletionQueue.retire(m_sampler);
+    deletionQueue.retire(m_imageView);
+    deletionQueue.retire(m_image, m_imageMemory);
+
+    m_sampler     = nullptr;
+    m_imageView   = nullptr;
+    m_image       = nullptr;
+    m_imageMemory = nullptr;
+}
+
+
 VkResult Texture2D::createSampler(VkPhysicalDevice GPU, VkDevice device) noexcept
 {
     VkPhysicalDeviceProperties properties = {};
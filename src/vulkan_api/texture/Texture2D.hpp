@@ -1,6 +1,8 @@
 #ifndef TEXTURE2D_HPP
 #define TEXTURE2D_HPP
 
+#include <cstdint>
+
 #include <vulkan/vulkan.h>
 
 class Texture2D
@@ -9,7 +11,9 @@ public:
     Texture2D() noexcept;
 
     bool loadFromFile(const char* filepath, VkPhysicalDevice GPU, VkDevice device, VkCommandPool pool, VkQueue queue) noexcept;
+    bool loadFromPixels(const void* rgba, uint32_t width, uint32_t height, VkPhysicalDevice GPU, VkDevice device, VkCommandPool pool, VkQueue queue) noexcept;
     void destroy(VkDevice device) noexcept;
+    void destroy(class DeletionQueue& deletionQueue) noexcept; // while frames in flight may still sample it
 
     VkImageView getImageView() const noexcept;
     VkSampler   getSampler() const noexcept;
@@ -1,7 +1,9 @@
 #ifndef VULKAN_DEFINES_HPP
 #define VULKAN_DEFINES_HPP
 
-#define MAX_FRAMES_IN_FLIGHT 2U
+// Defaults of Application::Settings, both can be changed at startup
+#define DEFAULT_FRAMES_IN_FLIGHT 2U
+#define DEFAULT_SWAPCHAIN_IMAGES 3U
 
 #define BEGIN_NAMESPACE_VK namespace vk {
 #define END_NAMESPACE_VK }
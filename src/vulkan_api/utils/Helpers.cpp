@@ -256,7 +256,7 @@ bool copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t
 }
 
 
-VkResult createImage2D(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory, VkPhysicalDevice GPU, VkDevice device) noexcept
+VkResult createImage2D(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory, VkPhysicalDevice GPU, VkDevice device, uint32_t mipLevels) noexcept
 {
     VkResult result = VK_SUCCESS;
 
@@ -273,7 +273,7 @@ VkResult createImage2D(uint32_t width, uint32_t height, VkFormat format, VkImage
             .height = height,
             .depth  = 1
         },
-        .mipLevels             = 1,
+        .mipLevels             = mipLevels,
         .arrayLayers           = 1,
         .samples               = VK_SAMPLE_COUNT_1_BIT,
         .tiling                = tiling,
@@ -305,7 +305,7 @@ VkResult createImage2D(uint32_t width, uint32_t height, VkFormat format, VkImage
 }
 
 
-VkResult createImageView2D(VkDevice device, VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, VkImageView& imageView) noexcept
+VkResult createImageView2D(VkDevice device, VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, VkImageView& imageView, uint32_t baseMipLevel, uint32_t levelCount) noexcept
 {
     VkImageViewCreateInfo viewInfo = 
     {
@@ -325,8 +325,8 @@ VkResult createImageView2D(VkDevice device, VkImage image, VkFormat format, VkIm
         .subresourceRange = 
         {
             .aspectMask     = aspectFlags,
-            .baseMipLevel   = 0,
-            .levelCount     = 1,
+            .baseMipLevel   = baseMipLevel,
+            .levelCount     = levelCount,
             .baseArrayLayer = 0,
             .layerCount     = 1
         }
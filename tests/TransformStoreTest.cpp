@@ -0,0 +1,105 @@
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+
+#include "core/TransformStore.hpp"
+
+
+// Objects are marked dirty out of order, so update() gets batches that look like runs but are not,
+// every matrix has to match the one composed object by object
+
+namespace
+{
+    const uint32_t OBJECT_COUNT = 64;
+
+
+    vec3s get_position(uint32_t i, uint32_t pass) noexcept
+    {
+        return vec3s { static_cast<float>(i), static_cast<float>(pass) * 100.f, -static_cast<float>(i) * 0.5f };
+    }
+
+
+    versors get_rotation(uint32_t i) noexcept
+    {
+    //  Half angle about a fixed, normalized axis
+        const float angle = 0.1f * static_cast<float>(i);
+        const float s     = std::sin(angle * 0.5f) / std::sqrt(3.f);
+
+        return versors { s, s, s, std::cos(angle * 0.5f) };
+    }
+
+
+    vec3s get_scale(uint32_t i) noexcept
+    {
+        return vec3s { 1.f + 0.01f * i, 2.f, 0.5f };
+    }
+
+
+//  translation * rotation * scale, multiplied out as matrices
+    mat4s compose(vec3s t, versors q, vec3s s) noexcept
+    {
+        const float x = q.x, y = q.y, z = q.z, w = q.w;
+
+        const float rotation[3][3] =
+        {
+            { 1.f - 2.f * (y * y + z * z), 2.f * (x * y + w * z),       2.f * (x * z - w * y) },
+            { 2.f * (x * y - w * z),       1.f - 2.f * (x * x + z * z), 2.f * (y * z + w * x) },
+            { 2.f * (x * z + w * y),       2.f * (y * z - w * x),       1.f - 2.f * (x * x + y * y) }
+        };
+
+        mat4s model {};
+
+        for (uint32_t column = 0; column < 3; ++column)
+            for (uint32_t row = 0; row < 3; ++row)
+                model.raw[column][row] = rotation[column][row] * s.raw[column];
+
+        model.raw[3][0] = t.x;
+        model.raw[3][1] = t.y;
+        model.raw[3][2] = t.z;
+        model.raw[3][3] = 1.f;
+
+        return model;
+    }
+}
+
+
+int main()
+{
+    TransformStore store;
+    store.reserve(OBJECT_COUNT);
+
+    for (uint32_t i = 0; i < OBJECT_COUNT; ++i)
+        store.add(get_position(i, 0), get_rotation(i), get_scale(i));
+
+    store.update();
+
+//  {7, 1, 2, 3, 4, 5, 6, 14} spans exactly eight slots without being a run, the rest follow in reverse
+    const uint32_t order[] = { 7, 1, 2, 3, 4, 5, 6, 14 };
+
+    for (auto i : order)
+        store.setPosition(i, get_position(i, 1));
+
+    for (uint32_t i = OBJECT_COUNT; i-- > 0;)
+        if(i != 1 && (i < 2 || i > 7) && i != 14)
+            store.setPosition(i, get_position(i, 1));
+
+    store.update();
+
+    uint32_t failures = 0;
+
+    for (uint32_t i = 0; i < OBJECT_COUNT; ++i)
+    {
+        const mat4s expected = compose(get_position(i, 1), get_rotation(i), get_scale(i));
+        const mat4s& actual  = store.getModel(i);
+
+        for (uint32_t column = 0; column < 4; ++column)
+            for (uint32_t row = 0; row < 4; ++row)
+                if(std::abs(expected.raw[column][row] - actual.raw[column][row]) > 1e-5f)
+                {
+                    printf("object %u: [%u][%u] is %f, expected %f\n", i, column, row, actual.raw[column][row], expected.raw[column][row]);
+                    ++failures;
+                }
+    }
+
+    return failures ? 1 : 0;
+}
\ No newline at end of file